@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Compara duas saídas JSON do turbovision_bench (Google Benchmark) e aponta
+# regressões acima do limite. Com --benchmark_repetitions, usa a mediana.
+#
+# Uso: compare_bench.py <base.json> <novo.json> [--threshold 5] [--metric real_time|cpu_time]
+# Retorna 1 se algum benchmark regrediu (para uso em CI).
+
+import argparse
+import json
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+
+    results = {}
+    medians = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        name = bench.get("run_name", bench["name"])
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[name] = (bench[metric], bench.get("time_unit", "ns"))
+        elif name not in results:
+            results[name] = (bench[metric], bench.get("time_unit", "ns"))
+    results.update(medians)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compara duas execuções do turbovision_bench")
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="Regressão máxima aceita, em %% (padrão 5)")
+    parser.add_argument("--metric", choices=["real_time", "cpu_time"], default="real_time")
+    args = parser.parse_args()
+
+    base = load(args.base, args.metric)
+    new = load(args.new, args.metric)
+
+    regressions = 0
+    width = max([len(name) for name in base] + [9])
+    print(f"{'benchmark':<{width}} {'base':>14} {'novo':>14} {'unid':>4} {'delta':>9}")
+    for name in sorted(base):
+        old, unit = base[name]
+        if name not in new:
+            print(f"{name:<{width}} {old:>14.1f} {'-':>14} {unit:>4} {'ausente':>9}")
+            continue
+        value, new_unit = new[name]
+        if new_unit != unit:
+            print(f"{name:<{width}} {old:>14.1f} {value:>14.1f} {unit + '/' + new_unit:>4} {'unidade?':>9}")
+            continue
+        delta = (value - old) / old * 100.0 if old else 0.0
+        flag = ""
+        if delta > args.threshold:
+            flag = "  REGRESSÃO"
+            regressions += 1
+        elif delta < -args.threshold:
+            flag = "  melhora"
+        print(f"{name:<{width}} {old:>14.1f} {value:>14.1f} {unit:>4} {delta:>+8.1f}%{flag}")
+    for name in sorted(set(new) - set(base)):
+        value, unit = new[name]
+        print(f"{name:<{width}} {'-':>14} {value:>14.1f} {unit:>4} {'novo':>9}")
+
+    print(f"\n{regressions} regressão(ões) acima de {args.threshold:.1f}% ({args.metric})")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
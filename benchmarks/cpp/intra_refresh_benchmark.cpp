@@ -0,0 +1,271 @@
+// Benchmark de latência em localhost: compara o modo atual (IDR periódico,
+// pacotes enviados após o frame inteiro) com intra refresh + slices
+// (EncoderConfig::intraRefresh e sliceOutput). Um cliente RTSP/UDP no mesmo
+// processo mede o tempo de pushFrame até o primeiro e o último pacote de
+// cada frame e a variação do tamanho dos frames.
+//
+// Uso: intra_refresh_benchmark [segundos=10] [largura=1280] [altura=720]
+//                              [bitrate=4000000] [encoder=libx264]
+
+#include <turbovision/turbovision.hpp>
+#include <turbovision/server/socket_utils.hpp>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace turbovision;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const int FRAME_RATE = 30;
+    const int RTP_CLOCK = 90000;
+
+    struct FrameTiming {
+        Clock::time_point first;
+        Clock::time_point last;
+        size_t bytes = 0;
+        bool complete = false;
+    };
+
+    struct Result {
+        std::vector<double> firstPacket;   // ms
+        std::vector<double> lastPacket;    // ms
+        std::vector<double> frameBytes;
+    };
+
+    // Requisição RTSP mínima; retorna a resposta (cabeçalhos + corpo)
+    std::string request(int socket, const std::string &method, const std::string &uri,
+                        int cseq, const std::string &headers = std::string()) {
+        std::string message = method + " " + uri + " RTSP/1.0\r\nCSeq: " +
+                              std::to_string(cseq) + "\r\n" + headers + "\r\n";
+        send(socket, message.data(), message.size(), MSG_NOSIGNAL);
+
+        std::string response;
+        char buffer[4096];
+        size_t headerEnd;
+        while ((headerEnd = response.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t received = recv(socket, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                return std::string();
+            }
+            response.append(buffer, static_cast<size_t>(received));
+        }
+
+        size_t contentLength = 0;
+        size_t position = response.find("Content-Length:");
+        if (position != std::string::npos && position < headerEnd) {
+            contentLength = std::strtoul(response.c_str() + position + 15, nullptr, 10);
+        }
+        while (response.size() < headerEnd + 4 + contentLength) {
+            ssize_t received = recv(socket, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            response.append(buffer, static_cast<size_t>(received));
+        }
+        return response;
+    }
+
+    std::string sessionId(const std::string &response) {
+        size_t position = response.find("Session:");
+        if (position == std::string::npos) {
+            return std::string();
+        }
+        position = response.find_first_not_of(' ', position + 8);
+        return response.substr(position, response.find_first_of(";\r", position) - position);
+    }
+
+    // Barras em movimento e ruído leve: conteúdo com P-frames não triviais
+    void fillFrame(std::vector<uint8_t> &frame, int width, int height, int index) {
+        uint32_t seed = static_cast<uint32_t>(index) * 2654435761u;
+        for (int y = 0; y < height; y++) {
+            uint8_t *row = frame.data() + static_cast<size_t>(y) * width * 3;
+            for (int x = 0; x < width; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                const uint8_t value = static_cast<uint8_t>(((x + index * 4) / 32 % 2) * 160 + (y / 4) % 64 + (seed >> 29));
+                row[x * 3] = value;
+                row[x * 3 + 1] = static_cast<uint8_t>(value + y);
+                row[x * 3 + 2] = static_cast<uint8_t>(value + x);
+            }
+        }
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[static_cast<size_t>(p * (values.size() - 1))];
+    }
+
+    double average(const std::vector<double> &values) {
+        double sum = 0.0;
+        for (double value: values) {
+            sum += value;
+        }
+        return values.empty() ? 0.0 : sum / values.size();
+    }
+
+    Result run(bool intraRefresh, int port, int seconds, const VideoConfig &videoConfig,
+               const std::string &encoder) {
+        ServerConfig config;
+        config.address = "127.0.0.1";
+        config.port = port;
+        config.useTCP = false;
+        config.encoder.encoder = encoder;
+        config.encoder.bitrate = videoConfig.bitrate;
+        config.encoder.intraRefresh = intraRefresh;
+        config.encoder.sliceOutput = intraRefresh;
+
+        Result result;
+        RTSPServer server(config, videoConfig);
+        if (!server.start()) {
+            std::fprintf(stderr, "Falha ao iniciar o servidor na porta %d\n", port);
+            return result;
+        }
+
+        // Cliente RTSP com transporte UDP
+        net::SocketHandle rtpSocket = net::createUdpSocket("127.0.0.1", 0);
+        int bufferSize = 8 * 1024 * 1024;
+        setsockopt(rtpSocket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+        const int rtpPort = net::localPort(rtpSocket);
+
+        sockaddr_in address{};
+        net::parseAddress("127.0.0.1", port, address);
+        int control = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        connect(control, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+
+        const std::string url = "rtsp://127.0.0.1:" + std::to_string(port) + "/" + config.streamName;
+        request(control, "DESCRIBE", url, 1, "Accept: application/sdp\r\n");
+        const std::string setup = request(control, "SETUP", url + "/streamid=0", 2,
+                                          "Transport: RTP/AVP;unicast;client_port=" +
+                                          std::to_string(rtpPort) + "-" + std::to_string(rtpPort + 1) + "\r\n");
+        const std::string session = sessionId(setup);
+        request(control, "PLAY", url, 3, "Session: " + session + "\r\n");
+
+        // Recepção: instante do primeiro e do último pacote por timestamp RTP
+        std::mutex timingMutex;
+        std::map<uint32_t, FrameTiming> timings;
+        std::atomic<bool> running(true);
+        std::thread receiver([&] {
+            std::vector<uint8_t> packet(65536);
+            while (running) {
+                pollfd fd{rtpSocket, POLLIN, 0};
+                if (poll(&fd, 1, 50) <= 0) {
+                    continue;
+                }
+                ssize_t size;
+                while ((size = recv(rtpSocket, packet.data(), packet.size(), MSG_DONTWAIT)) > 12) {
+                    const auto now = Clock::now();
+                    const uint32_t timestamp = ntohl(*reinterpret_cast<const uint32_t *>(&packet[4]));
+                    std::lock_guard<std::mutex> lock(timingMutex);
+                    FrameTiming &timing = timings[timestamp];
+                    if (timing.bytes == 0) {
+                        timing.first = now;
+                    }
+                    timing.last = now;
+                    timing.bytes += static_cast<size_t>(size) - 12;
+                    timing.complete = timing.complete || (packet[1] & 0x80) != 0;
+                }
+            }
+        });
+
+        // Produtor na cadência nominal
+        std::vector<uint8_t> frame(static_cast<size_t>(videoConfig.width) * videoConfig.height * 3);
+        std::vector<Clock::time_point> pushed;
+        const int frames = seconds * FRAME_RATE;
+        auto next = Clock::now();
+        for (int index = 0; index < frames; index++) {
+            fillFrame(frame, videoConfig.width, videoConfig.height, index);
+            pushed.push_back(Clock::now());
+            server.pushFrame(frame.data(), static_cast<int>(frame.size()));
+
+            next += std::chrono::microseconds(1000000 / FRAME_RATE);
+            std::this_thread::sleep_until(next);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        running = false;
+        receiver.join();
+        request(control, "TEARDOWN", url, 4, "Session: " + session + "\r\n");
+        close(control);
+        net::closeSocket(rtpSocket);
+        server.stop();
+
+        // O primeiro timestamp RTP recebido corresponde ao frame 0; os demais
+        // seguem a grade de 1/fps (ServerConfig::steadyCadence)
+        if (timings.empty()) {
+            return result;
+        }
+        Clock::time_point firstArrival = timings.begin()->second.first;
+        uint32_t baseTimestamp = timings.begin()->first;
+        for (const auto &entry: timings) {
+            if (entry.second.first < firstArrival) {
+                firstArrival = entry.second.first;
+                baseTimestamp = entry.first;
+            }
+        }
+
+        for (const auto &entry: timings) {
+            const int64_t delta = static_cast<int32_t>(entry.first - baseTimestamp);
+            const int64_t index = (delta + RTP_CLOCK / FRAME_RATE / 2) / (RTP_CLOCK / FRAME_RATE);
+            if (!entry.second.complete || index < 0 || index >= static_cast<int64_t>(pushed.size())) {
+                continue;
+            }
+            const Clock::time_point start = pushed[static_cast<size_t>(index)];
+            result.firstPacket.push_back(std::chrono::duration<double, std::milli>(entry.second.first - start).count());
+            result.lastPacket.push_back(std::chrono::duration<double, std::milli>(entry.second.last - start).count());
+            result.frameBytes.push_back(static_cast<double>(entry.second.bytes));
+        }
+        return result;
+    }
+
+    void report(const char *name, const Result &result) {
+        const double averageBytes = average(result.frameBytes);
+        double maxBytes = 0.0;
+        for (double bytes: result.frameBytes) {
+            maxBytes = std::max(maxBytes, bytes);
+        }
+        std::printf("%-20s %7zu %9.2f %9.2f %9.2f %9.2f %10.0f %9.2f %9.2f\n",
+                    name, result.frameBytes.size(),
+                    percentile(result.firstPacket, 0.5), percentile(result.firstPacket, 0.95),
+                    percentile(result.lastPacket, 0.5), percentile(result.lastPacket, 0.95),
+                    averageBytes,
+                    averageBytes > 0 ? percentile(result.frameBytes, 0.99) / averageBytes : 0.0,
+                    averageBytes > 0 ? maxBytes / averageBytes : 0.0);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 10;
+
+    VideoConfig videoConfig;
+    videoConfig.width = argc > 2 ? std::atoi(argv[2]) : 1280;
+    videoConfig.height = argc > 3 ? std::atoi(argv[3]) : 720;
+    videoConfig.bitrate = argc > 4 ? std::atoi(argv[4]) : 4000000;
+    videoConfig.fps = FRAME_RATE;
+    const std::string encoder = argc > 5 ? argv[5] : "libx264";
+
+    std::printf("%dx%d@%d %d kbps, %s, %d s por modo\n\n", videoConfig.width, videoConfig.height,
+                FRAME_RATE, videoConfig.bitrate / 1000, encoder.c_str(), seconds);
+    std::printf("%-20s %7s %9s %9s %9s %9s %10s %9s %9s\n", "modo", "frames",
+                "1o p50ms", "1o p95ms", "fim p50ms", "fim p95ms", "bytes/fr", "p99/med", "max/med");
+
+    report("idr + frame", run(false, 18650, seconds, videoConfig, encoder));
+    report("intra refresh+slice", run(true, 18652, seconds, videoConfig, encoder));
+    return 0;
+}
@@ -0,0 +1,280 @@
+// Benchmark de latência ponta a ponta em localhost: frames BGR24 com o
+// instante de captura gravado nos pixels (blocos 16x16 de luma) entram num
+// RTSPServer local e voltam por um RTSPSource no mesmo processo. Os marcos de
+// tempo de cada frame (RTSPServer e VideoSource::setFrameTraceCallback) são
+// casados pelo timestamp lido dos pixels e dão a contribuição de cada
+// estágio em p50/p99/p99.9:
+//
+//   convert   captura -> frame convertido na fila do servidor
+//   queue     espera na fila até o encoder
+//   encode    frame entregue ao encoder -> pacote codificado
+//   mux       empacotamento RTP e envio aos sockets
+//   net+demux sockets -> pacote entregue ao decoder do RTSPSource (o demux
+//             RTP do FFmpeg não expõe o instante de chegada do datagrama)
+//   decode    decoder
+//   deliver   cópia dos planos até o callback de frame
+//   total     captura -> callback de frame
+//
+// Uso: latency_benchmark [segundos=10] [largura=1280] [altura=720]
+//                        [bitrate=4000000] [encoder=libx264] [tcp=0]
+
+#include <turbovision/turbovision.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace turbovision;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const int FRAME_RATE = 30;
+    const int PORT = 18660;
+
+    // Timestamp embutido: 64 bits + 8 de verificação, um bit por bloco
+    const int MARK_BLOCK = 16;
+    const int MARK_BITS = 72;
+
+    const char *const STAGES[] = {"convert", "queue", "encode", "mux", "net+demux", "decode", "deliver", "total"};
+    const int STAGE_COUNT = sizeof(STAGES) / sizeof(STAGES[0]);
+
+    int64_t micros(Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    }
+
+    uint8_t checksum(uint64_t value) {
+        uint8_t sum = 0x5A;
+        for (int i = 0; i < 8; i++) {
+            sum ^= static_cast<uint8_t>(value >> (i * 8));
+        }
+        return sum;
+    }
+
+    bool markBit(uint64_t value, int bit) {
+        return bit < 64 ? ((value >> bit) & 1) != 0 : ((checksum(value) >> (bit - 64)) & 1) != 0;
+    }
+
+    // Blocos brancos/pretos a partir do canto superior esquerdo, em linhas
+    void writeMark(std::vector<uint8_t> &frame, int width, uint64_t value) {
+        const int perRow = width / MARK_BLOCK;
+        for (int bit = 0; bit < MARK_BITS; bit++) {
+            const uint8_t level = markBit(value, bit) ? 255 : 0;
+            const int x0 = (bit % perRow) * MARK_BLOCK;
+            const int y0 = (bit / perRow) * MARK_BLOCK;
+            for (int y = y0; y < y0 + MARK_BLOCK; y++) {
+                std::fill_n(frame.data() + (static_cast<size_t>(y) * width + x0) * 3, MARK_BLOCK * 3, level);
+            }
+        }
+    }
+
+    // Lê o centro de cada bloco no plano de luma (YUV420P ou NV12)
+    bool readMark(const FramePtr &frame, uint64_t &value) {
+        const int width = frame->width();
+        const int perRow = width / MARK_BLOCK;
+        const uint8_t *luma = frame->data();
+        uint64_t bits = 0;
+        uint8_t check = 0;
+        for (int bit = 0; bit < MARK_BITS; bit++) {
+            const int x0 = (bit % perRow) * MARK_BLOCK + MARK_BLOCK / 4;
+            const int y0 = (bit / perRow) * MARK_BLOCK + MARK_BLOCK / 4;
+            int sum = 0;
+            for (int y = y0; y < y0 + MARK_BLOCK / 2; y++) {
+                for (int x = x0; x < x0 + MARK_BLOCK / 2; x++) {
+                    sum += luma[static_cast<size_t>(y) * width + x];
+                }
+            }
+            if (sum / (MARK_BLOCK * MARK_BLOCK / 4) >= 128) {
+                if (bit < 64) {
+                    bits |= uint64_t(1) << bit;
+                } else {
+                    check |= static_cast<uint8_t>(1 << (bit - 64));
+                }
+            }
+        }
+        value = bits;
+        return check == checksum(bits);
+    }
+
+    // Barras em movimento e ruído leve: conteúdo com P-frames não triviais
+    void fillFrame(std::vector<uint8_t> &frame, int width, int height, int index) {
+        uint32_t seed = static_cast<uint32_t>(index) * 2654435761u;
+        for (int y = 0; y < height; y++) {
+            uint8_t *row = frame.data() + static_cast<size_t>(y) * width * 3;
+            for (int x = 0; x < width; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                const uint8_t value = static_cast<uint8_t>(((x + index * 4) / 32 % 2) * 160 + (y / 4) % 64 + (seed >> 29));
+                row[x * 3] = value;
+                row[x * 3 + 1] = static_cast<uint8_t>(value + y);
+                row[x * 3 + 2] = static_cast<uint8_t>(value + x);
+            }
+        }
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[static_cast<size_t>(p * (values.size() - 1))];
+    }
+
+    double average(const std::vector<double> &values) {
+        double sum = 0.0;
+        for (double value: values) {
+            sum += value;
+        }
+        return values.empty() ? 0.0 : sum / values.size();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const int seconds = argc > 1 ? std::atoi(argv[1]) : 10;
+
+    VideoConfig videoConfig;
+    videoConfig.width = argc > 2 ? std::atoi(argv[2]) : 1280;
+    videoConfig.height = argc > 3 ? std::atoi(argv[3]) : 720;
+    videoConfig.bitrate = argc > 4 ? std::atoi(argv[4]) : 4000000;
+    videoConfig.fps = FRAME_RATE;
+    const std::string encoder = argc > 5 ? argv[5] : "libx264";
+    const bool tcp = argc > 6 && std::atoi(argv[6]) != 0;
+
+    if (videoConfig.width / MARK_BLOCK * (videoConfig.height / MARK_BLOCK) < MARK_BITS) {
+        std::fprintf(stderr, "Resolução pequena demais para o timestamp embutido\n");
+        return 1;
+    }
+
+    ServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = PORT;
+    config.useTCP = tcp;
+    config.useFrameTimestamps = true;
+    config.encoder.encoder = encoder;
+    config.encoder.bitrate = videoConfig.bitrate;
+    config.encoder.lowLatency = true;
+    config.encoder.advanced.zeroLatency = true;
+
+    // Marcos do servidor, indexados pelo timestamp do frame (= captura)
+    std::mutex traceMutex;
+    std::map<int64_t, RTSPServer::FrameTrace> serverTraces;
+    std::map<int64_t, VideoSource::FrameTrace> sourceTraces;
+    std::atomic<int64_t> received(0);
+    std::atomic<int64_t> unreadable(0);
+
+    try {
+        RTSPServer server(config, videoConfig);
+        server.setFrameTraceCallback([&](const RTSPServer::FrameTrace &trace) {
+            std::lock_guard<std::mutex> lock(traceMutex);
+            serverTraces[trace.timestamp] = trace;
+        });
+        if (!server.start()) {
+            std::fprintf(stderr, "Falha ao iniciar o servidor na porta %d\n", PORT);
+            return 1;
+        }
+
+        // Decoder com uma thread: threads de frame somam frames de atraso
+        VideoConfig sourceConfig = videoConfig;
+        sourceConfig.advanced.threadCount = 1;
+
+        RTSPSource::RTSPConfig rtspConfig;
+        rtspConfig.url = "rtsp://127.0.0.1:" + std::to_string(PORT) + "/" + config.streamName;
+        rtspConfig.useTCP = tcp;
+        rtspConfig.reconnectOnError = false;
+        rtspConfig.advanced.lowLatency = true;
+
+        RTSPSource source(sourceConfig, rtspConfig);
+        source.setFrameTraceCallback([&](const FramePtr &frame, const VideoSource::FrameTrace &trace) {
+            uint64_t captured;
+            if (!readMark(frame, captured)) {
+                unreadable++;
+                return;
+            }
+            std::lock_guard<std::mutex> lock(traceMutex);
+            sourceTraces[static_cast<int64_t>(captured)] = trace;
+        });
+        source.setFrameCallback([&](FramePtr) { received++; });
+
+        // Produtor na cadência nominal, em paralelo com a conexão do RTSPSource
+        std::vector<uint8_t> frame(static_cast<size_t>(videoConfig.width) * videoConfig.height * 3);
+        std::atomic<bool> producing(true);
+        std::atomic<int64_t> pushed(0);
+        std::thread producer([&] {
+            auto next = Clock::now();
+            for (int index = 0; producing; index++) {
+                fillFrame(frame, videoConfig.width, videoConfig.height, index);
+                const int64_t captured = micros(Clock::now());
+                writeMark(frame, videoConfig.width, static_cast<uint64_t>(captured));
+
+                auto data = std::make_shared<FrameData>(videoConfig.width, videoConfig.height, AV_PIX_FMT_BGR24);
+                data->copyFrom(frame.data(), static_cast<int>(frame.size()));
+                data->setTimestamp(captured);
+                if (server.pushFrame(data)) {
+                    pushed++;
+                }
+
+                next += std::chrono::microseconds(1000000 / FRAME_RATE);
+                std::this_thread::sleep_until(next);
+            }
+        });
+
+        if (!source.start()) {
+            std::fprintf(stderr, "Falha ao conectar em %s\n", rtspConfig.url.c_str());
+            producing = false;
+            producer.join();
+            server.stop();
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        producing = false;
+        producer.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        source.stop();
+        server.stop();
+
+        // Casa os marcos dos dois lados; o primeiro segundo (conexão e
+        // primeiro keyframe) fica de fora
+        std::vector<std::vector<double>> samples(STAGE_COUNT);
+        int64_t firstCapture = sourceTraces.empty() ? 0 : sourceTraces.begin()->first;
+        for (const auto &entry: sourceTraces) {
+            auto it = serverTraces.find(entry.first);
+            if (it == serverTraces.end() || entry.first - firstCapture < 1000000 ||
+                entry.second.received == 0) {
+                continue;
+            }
+            const RTSPServer::FrameTrace &serverTrace = it->second;
+            const VideoSource::FrameTrace &sourceTrace = entry.second;
+            const int64_t marks[] = {
+                entry.first, serverTrace.converted, serverTrace.encodeStart, serverTrace.encoded,
+                serverTrace.written, sourceTrace.received, sourceTrace.decoded, sourceTrace.delivered
+            };
+            for (int stage = 0; stage < STAGE_COUNT - 1; stage++) {
+                samples[stage].push_back((marks[stage + 1] - marks[stage]) / 1000.0);
+            }
+            samples[STAGE_COUNT - 1].push_back((sourceTrace.delivered - entry.first) / 1000.0);
+        }
+
+        std::printf("%dx%d@%d %d kbps, %s, %s, %d s\n", videoConfig.width, videoConfig.height, FRAME_RATE,
+                    videoConfig.bitrate / 1000, encoder.c_str(), tcp ? "TCP" : "UDP", seconds);
+        std::printf("frames: %lld enviados, %lld recebidos, %zu medidos, %lld sem timestamp legível\n\n",
+                    static_cast<long long>(pushed.load()), static_cast<long long>(received.load()),
+                    samples[0].size(), static_cast<long long>(unreadable.load()));
+        std::printf("%-10s %9s %9s %9s %9s %9s\n", "estágio", "média ms", "p50 ms", "p99 ms", "p99.9 ms", "máx ms");
+        for (int stage = 0; stage < STAGE_COUNT; stage++) {
+            const std::vector<double> &values = samples[stage];
+            std::printf("%-10s %9.3f %9.3f %9.3f %9.3f %9.3f\n", STAGES[stage], average(values),
+                        percentile(values, 0.5), percentile(values, 0.99), percentile(values, 0.999),
+                        percentile(values, 1.0));
+        }
+    } catch (const Exception &e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
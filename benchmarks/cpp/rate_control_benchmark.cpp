@@ -0,0 +1,137 @@
+// Simulação do controle adaptativo de bitrate (RateController) contra um
+// enlace gargalo emulado em processo, no lugar do tc netem (que exige root):
+// capacidade variável, fila drop-tail, perda aleatória e atraso base. A cada
+// 100 ms o "cliente" gera um RR com perda, jitter e RTT do período.
+//
+// Uso: rate_control_benchmark [perda_aleatoria_%=0] [atraso_base_ms=20] [segundos=90]
+
+#include <turbovision/server/rate_controller.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+
+using namespace turbovision;
+
+namespace {
+    const int TICK_MS = 10;
+    const int REPORT_MS = 100;
+    const size_t PACKET_BYTES = 1200;
+    const double QUEUE_LIMIT_MS = 300.0;   // Buffer do gargalo
+
+    // Capacidade do enlace ao longo do tempo (bps)
+    double capacityAt(int seconds) {
+        if (seconds < 20) return 6e6;
+        if (seconds < 40) return 1.5e6;
+        if (seconds < 60) return 4e6;
+        return 0.25e6;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const double randomLoss = (argc > 1 ? std::atof(argv[1]) : 0.0) / 100.0;
+    const double baseDelay = argc > 2 ? std::atof(argv[2]) : 20.0;
+    const int duration = argc > 3 ? std::atoi(argv[3]) : 90;
+
+    RateController::Settings settings;
+    settings.minBitrate = 300000;
+    settings.maxBitrate = 8000000;
+    settings.startBitrate = 4000000;
+    settings.minFps = 5;
+    settings.maxFps = 30;
+    settings.interval = 1000;
+    RateController controller(settings);
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // Fila do gargalo: instante de chegada de cada pacote (ms)
+    std::deque<double> queue;
+    double queueBits = 0.0;
+    double credit = 0.0;
+    double sendCredit = 0.0;
+
+    int sent = 0, lost = 0;
+    double lastTransit = -1.0, jitter = 0.0, rttSum = 0.0;
+    int rttSamples = 0;
+
+    double deliveredBits = 0.0, offeredCapacity = 0.0;
+    int64_t totalSent = 0, totalLost = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::printf("%6s %10s %10s %5s %7s %9s %9s %6s\n",
+                "t(s)", "cap kbps", "alvo kbps", "fps", "perda%", "jitter ms", "rtt ms", "motivo");
+
+    for (int now = 0; now < duration * 1000; now += TICK_MS) {
+        const double capacity = capacityAt(now / 1000);
+
+        // Emissor: bitrate alvo em pacotes de tamanho fixo
+        sendCredit += controller.bitrate() * TICK_MS / 1000.0;
+        while (sendCredit >= PACKET_BYTES * 8) {
+            sendCredit -= PACKET_BYTES * 8;
+            sent++;
+            const double queueDelay = queueBits / capacity * 1000.0;
+            if (uniform(random) < randomLoss || queueDelay > QUEUE_LIMIT_MS) {
+                lost++;
+                continue;
+            }
+            queue.push_back(now);
+            queueBits += PACKET_BYTES * 8;
+        }
+
+        // Gargalo: escoa a fila na capacidade atual
+        credit += capacity * TICK_MS / 1000.0;
+        offeredCapacity += capacity * TICK_MS / 1000.0;
+        while (!queue.empty() && credit >= PACKET_BYTES * 8) {
+            credit -= PACKET_BYTES * 8;
+            queueBits -= PACKET_BYTES * 8;
+            deliveredBits += PACKET_BYTES * 8;
+
+            // Jitter entre chegadas como na RFC 3550 (emissor com espaçamento constante)
+            const double transit = now + baseDelay - queue.front();
+            if (lastTransit >= 0.0) {
+                jitter += (std::abs(transit - lastTransit) - jitter) / 16.0;
+            }
+            lastTransit = transit;
+            rttSum += 2.0 * baseDelay + (now - queue.front());
+            rttSamples++;
+            queue.pop_front();
+        }
+        if (queue.empty()) {
+            credit = 0.0; // Enlace ocioso não acumula crédito
+        }
+
+        if ((now + TICK_MS) % REPORT_MS == 0 && sent > 0) {
+            RateController::Feedback feedback;
+            feedback.fractionLost = static_cast<double>(lost) / sent;
+            feedback.jitter = jitter;
+            feedback.rtt = rttSamples > 0 ? rttSum / rttSamples : -1.0;
+            controller.onFeedback(feedback);
+
+            totalSent += sent;
+            totalLost += lost;
+            sent = lost = 0;
+            rttSum = 0.0;
+            rttSamples = 0;
+        }
+
+        // Relógio simulado para o intervalo de decisão
+        RateController::Decision decision;
+        controller.update(start + std::chrono::milliseconds(now + TICK_MS), decision);
+        if (decision.reason[0] != '\0') {
+            std::printf("%6.1f %10.0f %10lld %5d %7.1f %9.1f %9.1f %6s\n",
+                        (now + TICK_MS) / 1000.0, capacity / 1000.0,
+                        static_cast<long long>(decision.bitrate / 1000), decision.fps,
+                        decision.worst.fractionLost * 100.0, decision.worst.jitter,
+                        decision.worst.rtt, decision.reason);
+        }
+    }
+
+    std::printf("\nutilização do enlace %.1f%%, perda total %.2f%%\n",
+                deliveredBits / offeredCapacity * 100.0,
+                totalSent > 0 ? 100.0 * totalLost / totalSent : 0.0);
+    return 0;
+}
@@ -0,0 +1,246 @@
+// Benchmark de codificação com regiões de interesse: mede quanto bitrate o
+// libx264 economiza com ROIs (ServerStream::attachRegionsOfInterest) para
+// manter a mesma PSNR dentro da região. Cena sintética com fundo texturizado
+// em movimento lento e um objeto que atravessa o quadro.
+//
+// Uso: roi_benchmark [frames=150] [largura=640] [altura=360] [bitrate=1500000]
+//                    [offset_roi=-0.5] [offset_fundo=0.3]
+
+#include <turbovision/server/server_stream.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace turbovision;
+
+namespace {
+    const int FRAME_RATE = 30;
+
+    struct PassResult {
+        int64_t bytes = 0;
+        double roiPsnr = 0.0;
+        double backgroundPsnr = 0.0;
+    };
+
+    struct Scene {
+        int width;
+        int height;
+        std::vector<uint8_t> texture;     // Fundo com o dobro da largura
+
+        // Objeto de 1/4 da altura atravessando o quadro
+        RTSPServer::RegionOfInterest regionAt(int index) const {
+            RTSPServer::RegionOfInterest region;
+            region.width = (width / 5) & ~15;
+            region.height = (height / 4) & ~15;
+            region.x = (index * 4) % (width - region.width);
+            region.y = height / 2 - region.height / 2;
+            return region;
+        }
+
+        void fill(AVFrame *frame, int index) const {
+            const RTSPServer::RegionOfInterest region = regionAt(index);
+            for (int y = 0; y < height; y++) {
+                uint8_t *row = frame->data[0] + static_cast<size_t>(y) * frame->linesize[0];
+                const uint8_t *source = texture.data() + static_cast<size_t>(y) * width * 2 + index % width;
+                for (int x = 0; x < width; x++) {
+                    const bool inside = x >= region.x && x < region.x + region.width &&
+                                        y >= region.y && y < region.y + region.height;
+                    row[x] = inside ? static_cast<uint8_t>(((x - region.x) ^ (y - region.y)) * 3 + index)
+                                    : source[x];
+                }
+            }
+            for (int plane = 1; plane < 3; plane++) {
+                for (int y = 0; y < height / 2; y++) {
+                    std::fill_n(frame->data[plane] + static_cast<size_t>(y) * frame->linesize[plane], width / 2,
+                                static_cast<uint8_t>(128 + plane * 8));
+                }
+            }
+        }
+    };
+
+    Scene makeScene(int width, int height) {
+        Scene scene{width, height, std::vector<uint8_t>(static_cast<size_t>(width) * 2 * height)};
+        uint32_t seed = 12345;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width * 2; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                scene.texture[static_cast<size_t>(y) * width * 2 + x] =
+                    static_cast<uint8_t>(96 + 40 * std::sin(x * 0.07) * std::cos(y * 0.05) + (seed >> 27));
+            }
+        }
+        return scene;
+    }
+
+    double psnr(double squaredError, int64_t samples) {
+        if (samples == 0 || squaredError <= 0.0) {
+            return 99.0;
+        }
+        return 10.0 * std::log10(255.0 * 255.0 / (squaredError / samples));
+    }
+
+    // Codifica a cena com libx264 (mesmas opções do servidor em baixa
+    // latência), decodifica e mede a PSNR da luma dentro e fora da ROI
+    PassResult encodePass(const Scene &scene, int frames, int64_t bitrate, bool useRoi,
+                          float roiOffset, float backgroundOffset) {
+        PassResult result;
+        const AVCodec *encoderCodec = avcodec_find_encoder_by_name("libx264");
+        const AVCodec *decoderCodec = avcodec_find_decoder(AV_CODEC_ID_H264);
+        if (!encoderCodec || !decoderCodec) {
+            std::fprintf(stderr, "libx264 ou decoder H.264 indisponível\n");
+            return result;
+        }
+
+        AVCodecContext *encoder = avcodec_alloc_context3(encoderCodec);
+        encoder->width = scene.width;
+        encoder->height = scene.height;
+        encoder->time_base = AVRational{1, FRAME_RATE};
+        encoder->framerate = AVRational{FRAME_RATE, 1};
+        encoder->bit_rate = bitrate;
+        encoder->gop_size = FRAME_RATE;
+        encoder->max_b_frames = 0;
+        encoder->pix_fmt = AV_PIX_FMT_YUV420P;
+
+        AVDictionary *opts = nullptr;
+        av_dict_set(&opts, "preset", "ultrafast", 0);
+        av_dict_set(&opts, "tune", "zerolatency", 0);
+        av_dict_set(&opts, "aq-mode", "1", 0);
+        const bool opened = avcodec_open2(encoder, encoderCodec, &opts) >= 0;
+        av_dict_free(&opts);
+
+        AVCodecContext *decoder = avcodec_alloc_context3(decoderCodec);
+        if (!opened || avcodec_open2(decoder, decoderCodec, nullptr) < 0) {
+            std::fprintf(stderr, "Falha ao abrir encoder/decoder\n");
+            avcodec_free_context(&encoder);
+            avcodec_free_context(&decoder);
+            return result;
+        }
+
+        std::vector<AVFrame *> originals;
+        AVPacket *packet = av_packet_alloc();
+        AVFrame *decoded = av_frame_alloc();
+        double roiError = 0.0, backgroundError = 0.0;
+        int64_t roiSamples = 0, backgroundSamples = 0;
+
+        auto measure = [&](const AVFrame *frame) {
+            if (frame->pts < 0 || frame->pts >= static_cast<int64_t>(originals.size())) {
+                return;
+            }
+            const AVFrame *original = originals[static_cast<size_t>(frame->pts)];
+            const RTSPServer::RegionOfInterest region = scene.regionAt(static_cast<int>(frame->pts));
+            for (int y = 0; y < scene.height; y++) {
+                const uint8_t *a = original->data[0] + static_cast<size_t>(y) * original->linesize[0];
+                const uint8_t *b = frame->data[0] + static_cast<size_t>(y) * frame->linesize[0];
+                for (int x = 0; x < scene.width; x++) {
+                    const double error = static_cast<double>(a[x] - b[x]) * (a[x] - b[x]);
+                    if (x >= region.x && x < region.x + region.width &&
+                        y >= region.y && y < region.y + region.height) {
+                        roiError += error;
+                        roiSamples++;
+                    } else {
+                        backgroundError += error;
+                        backgroundSamples++;
+                    }
+                }
+            }
+        };
+
+        auto drain = [&] {
+            while (avcodec_receive_packet(encoder, packet) >= 0) {
+                result.bytes += packet->size;
+                if (avcodec_send_packet(decoder, packet) >= 0) {
+                    while (avcodec_receive_frame(decoder, decoded) >= 0) {
+                        measure(decoded);
+                    }
+                }
+                av_packet_unref(packet);
+            }
+        };
+
+        for (int index = 0; index < frames; index++) {
+            AVFrame *frame = av_frame_alloc();
+            frame->format = AV_PIX_FMT_YUV420P;
+            frame->width = scene.width;
+            frame->height = scene.height;
+            av_frame_get_buffer(frame, 32);
+            scene.fill(frame, index);
+            frame->pts = index;
+
+            if (useRoi) {
+                RTSPServer::RegionOfInterest region = scene.regionAt(index);
+                region.qualityOffset = roiOffset;
+                ServerStream::attachRegionsOfInterest(frame, {region}, backgroundOffset,
+                                                      scene.width, scene.height);
+            }
+
+            originals.push_back(frame);
+            avcodec_send_frame(encoder, frame);
+            drain();
+        }
+        avcodec_send_frame(encoder, nullptr);
+        drain();
+
+        for (AVFrame *frame: originals) {
+            av_frame_free(&frame);
+        }
+        av_frame_free(&decoded);
+        av_packet_free(&packet);
+        avcodec_free_context(&encoder);
+        avcodec_free_context(&decoder);
+
+        result.roiPsnr = psnr(roiError, roiSamples);
+        result.backgroundPsnr = psnr(backgroundError, backgroundSamples);
+        return result;
+    }
+
+    void report(const char *name, int64_t bitrate, const PassResult &result, int frames) {
+        std::printf("%-14s %10lld %10.0f %9.2f %9.2f\n", name,
+                    static_cast<long long>(bitrate / 1000),
+                    result.bytes * 8.0 * FRAME_RATE / frames / 1000.0,
+                    result.roiPsnr, result.backgroundPsnr);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const int frames = argc > 1 ? std::atoi(argv[1]) : 150;
+    const int width = argc > 2 ? std::atoi(argv[2]) : 640;
+    const int height = argc > 3 ? std::atoi(argv[3]) : 360;
+    const int64_t bitrate = argc > 4 ? std::atoll(argv[4]) : 1500000;
+    const float roiOffset = argc > 5 ? static_cast<float>(std::atof(argv[5])) : -0.5f;
+    const float backgroundOffset = argc > 6 ? static_cast<float>(std::atof(argv[6])) : 0.3f;
+
+    const Scene scene = makeScene(width, height);
+    std::printf("%dx%d, %d frames, qoffset roi=%.2f fundo=%.2f\n\n", width, height, frames,
+                roiOffset, backgroundOffset);
+    std::printf("%-14s %10s %10s %9s %9s\n", "modo", "alvo kbps", "real kbps", "PSNR roi", "PSNR fundo");
+
+    const PassResult baseline = encodePass(scene, frames, bitrate, false, 0.0f, 0.0f);
+    if (baseline.bytes == 0) {
+        return 1;
+    }
+    report("sem roi", bitrate, baseline, frames);
+
+    // Busca binária do menor bitrate com ROI que mantém a PSNR da região
+    int64_t low = bitrate / 10;
+    int64_t high = bitrate;
+    int64_t bestBitrate = bitrate;
+    PassResult best = encodePass(scene, frames, bitrate, true, roiOffset, backgroundOffset);
+    for (int step = 0; step < 7; step++) {
+        const int64_t middle = (low + high) / 2;
+        const PassResult pass = encodePass(scene, frames, middle, true, roiOffset, backgroundOffset);
+        if (pass.roiPsnr >= baseline.roiPsnr) {
+            best = pass;
+            bestBitrate = middle;
+            high = middle;
+        } else {
+            low = middle;
+        }
+    }
+    report("roi", bestBitrate, best, frames);
+
+    std::printf("\neconomia com a mesma PSNR na ROI: %.1f%%\n",
+                100.0 * (1.0 - static_cast<double>(best.bytes) / baseline.bytes));
+    return 0;
+}
@@ -0,0 +1,364 @@
+// Benchmark de escala de ingestão: quantos RTSPSource uma máquina sustenta
+// antes de perder frames. Para cada N, um processo publicador (este mesmo
+// binário com --publish) sobe um RTSPServer com N streams em localhost e
+// este processo abre N RTSPSource. Após o aquecimento mede, só do lado da
+// ingestão: CPU (em núcleos), RSS, threads, trocas de contexto por segundo
+// e a fração dos frames publicados na janela que não foi entregue. N dobra
+// até passar do limite de perda e depois é refinado por bisseção até o
+// joelho: o maior N sem perda acima do limite. A janela é delimitada pelo
+// próprio publicador (SIGUSR1 -> frames enviados por stream), então um
+// publicador saturado (que também codifica os N streams) não vira perda de
+// ingestão; a coluna pub_falta mostra quanto ele ficou abaixo de fps.
+//
+// Uso: scaling_benchmark [max_streams=64] [segundos=10] [largura=640] [altura=360]
+//                        [fps=30] [encoder=libx264] [limite_perda=0.01]
+
+#include <turbovision/turbovision.hpp>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace turbovision;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const int BASE_PORT = 18700;
+    const int WARMUP_SECONDS = 3;
+
+    volatile sig_atomic_t stopPublishing = 0;
+    volatile sig_atomic_t reportRequested = 0;
+
+    struct Settings {
+        int seconds = 10;
+        int width = 640;
+        int height = 360;
+        int fps = 30;
+        std::string encoder = "libx264";
+    };
+
+    struct Result {
+        int streams = 0;
+        int connected = 0;
+        double cores = 0.0;           // Tempo de CPU / tempo de parede
+        long rssMB = 0;
+        long threads = 0;
+        double switches = 0.0;        // Trocas de contexto por segundo
+        double loss = 1.0;            // Frames não entregues / publicados na janela
+        int stalled = 0;              // Streams com menos da metade dos frames publicados
+        double publisherShortfall = 0.0;  // Frames por stream abaixo de wall × fps
+    };
+
+    // Marco do publicador: frames enviados por stream, descartados pelo
+    // servidor (todos os streams) e o instante (steady_clock, comum aos processos)
+    struct Mark {
+        long long rounds = 0;
+        long long dropped = 0;
+        long long micros = 0;
+    };
+
+    // Barras em movimento: custo de codificação baixo e P-frames reais
+    void fillFrame(std::vector<uint8_t> &frame, int width, int height, int index) {
+        for (int y = 0; y < height; y++) {
+            uint8_t *row = frame.data() + static_cast<size_t>(y) * width * 3;
+            for (int x = 0; x < width; x++) {
+                const uint8_t value = static_cast<uint8_t>(((x + index * 4) / 32 % 2) * 160 + (y / 4) % 64);
+                row[x * 3] = value;
+                row[x * 3 + 1] = static_cast<uint8_t>(value + y);
+                row[x * 3 + 2] = static_cast<uint8_t>(value + x);
+            }
+        }
+    }
+
+    std::string streamName(int index) {
+        return "s" + std::to_string(index);
+    }
+
+    long long steadyMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    // Processo publicador: N streams na cadência nominal até SIGTERM (ou
+    // até o processo de medição terminar). Escreve "ready <pid>" ao subir e
+    // um Mark ("rounds dropped micros") a cada SIGUSR1.
+    int publish(int streams, int port, const Settings &settings) {
+        signal(SIGTERM, [](int) { stopPublishing = 1; });
+        signal(SIGUSR1, [](int) { reportRequested = 1; });
+        const pid_t parent = getppid();
+
+        VideoConfig videoConfig;
+        videoConfig.width = settings.width;
+        videoConfig.height = settings.height;
+        videoConfig.fps = settings.fps;
+        videoConfig.bitrate = settings.width * settings.height * 2;
+
+        ServerConfig config;
+        config.address = "127.0.0.1";
+        config.port = port;
+        config.streamName = streamName(0);
+        config.maxClients = streams;
+        config.maxStreams = streams;
+        config.encoder.encoder = settings.encoder;
+        config.encoder.bitrate = videoConfig.bitrate;
+        config.encoder.lowLatency = true;
+
+        RTSPServer server(config, videoConfig);
+        if (!server.start()) {
+            return 1;
+        }
+        for (int i = 1; i < streams; i++) {
+            if (!server.addStream(streamName(i), videoConfig)) {
+                return 1;
+            }
+        }
+        std::printf("ready %d\n", static_cast<int>(getpid()));
+        std::fflush(stdout);
+
+        std::vector<uint8_t> frame(static_cast<size_t>(settings.width) * settings.height * 3);
+        long long rounds = 0;
+        auto next = Clock::now();
+        for (int index = 0; !stopPublishing && getppid() == parent; index++) {
+            if (reportRequested) {
+                reportRequested = 0;
+                std::printf("%lld %d %lld\n", rounds, server.getStats().droppedFrames, steadyMicros());
+                std::fflush(stdout);
+            }
+            fillFrame(frame, settings.width, settings.height, index);
+            for (int i = 0; i < streams; i++) {
+                server.pushFrame(streamName(i), frame.data(), static_cast<int>(frame.size()));
+            }
+            rounds++;
+            next += std::chrono::microseconds(1000000 / settings.fps);
+            std::this_thread::sleep_until(next);
+        }
+
+        server.stop();
+        return 0;
+    }
+
+    // Pede um Mark ao publicador e espera a resposta
+    bool requestMark(int pid, FILE *publisher, Mark &mark) {
+        char line[256];
+        kill(pid, SIGUSR1);
+        return std::fgets(line, sizeof(line), publisher) &&
+               std::sscanf(line, "%lld %lld %lld", &mark.rounds, &mark.dropped, &mark.micros) == 3;
+    }
+
+    long procStatus(const char *field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        const size_t length = std::strlen(field);
+        while (std::getline(status, line)) {
+            if (line.compare(0, length, field) == 0) {
+                return std::atol(line.c_str() + length);
+            }
+        }
+        return 0;
+    }
+
+    double cpuSeconds(const rusage &usage) {
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    }
+
+    bool run(const char *self, int streams, int port, const Settings &settings, Result &result) {
+        result = Result();
+        result.streams = streams;
+
+        const std::string command = "exec " + std::string(self) + " --publish " + std::to_string(streams) +
+                                    " " + std::to_string(port) + " " + std::to_string(settings.width) + " " + std::to_string(settings.height) +
+                                    " " + std::to_string(settings.fps) + " " + settings.encoder;
+        FILE *publisher = popen(command.c_str(), "r");
+        if (!publisher) {
+            return false;
+        }
+        char line[256];
+        int pid = 0;
+        if (!std::fgets(line, sizeof(line), publisher) || std::sscanf(line, "ready %d", &pid) != 1) {
+            std::fprintf(stderr, "Publicador não iniciou com %d streams\n", streams);
+            pclose(publisher);
+            return false;
+        }
+
+        VideoConfig videoConfig;
+        videoConfig.width = settings.width;
+        videoConfig.height = settings.height;
+        videoConfig.fps = settings.fps;
+        videoConfig.advanced.threadCount = 1;
+
+        std::vector<std::unique_ptr<std::atomic<int64_t>>> frames;
+        std::vector<std::unique_ptr<RTSPSource>> sources;
+        for (int i = 0; i < streams; i++) {
+            RTSPSource::RTSPConfig rtspConfig;
+            rtspConfig.url = "rtsp://127.0.0.1:" + std::to_string(port) + "/" + streamName(i);
+            rtspConfig.reconnectOnError = false;
+
+            frames.emplace_back(new std::atomic<int64_t>(0));
+            std::atomic<int64_t> *counter = frames.back().get();
+            sources.emplace_back(new RTSPSource(videoConfig, rtspConfig));
+            sources.back()->setFrameCallback([counter](FramePtr) { (*counter)++; });
+            if (sources.back()->start()) {
+                result.connected++;
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(WARMUP_SECONDS));
+
+        // Janela de medição, aberta e fechada pelos marcos do publicador
+        Mark first;
+        Mark last;
+        if (!requestMark(pid, publisher, first)) {
+            kill(pid, SIGTERM);
+            pclose(publisher);
+            return false;
+        }
+        std::vector<int64_t> start(streams);
+        for (int i = 0; i < streams; i++) {
+            start[i] = *frames[i];
+        }
+        rusage before{};
+        getrusage(RUSAGE_SELF, &before);
+        const auto windowStart = Clock::now();
+
+        std::this_thread::sleep_for(std::chrono::seconds(settings.seconds));
+
+        const bool marked = requestMark(pid, publisher, last);
+        std::vector<int64_t> end(streams);
+        for (int i = 0; i < streams; i++) {
+            end[i] = *frames[i];
+        }
+        rusage after{};
+        getrusage(RUSAGE_SELF, &after);
+        const double wall = std::chrono::duration<double>(Clock::now() - windowStart).count();
+        result.rssMB = procStatus("VmRSS:") / 1024;
+        result.threads = procStatus("Threads:");
+
+        // Perda da ingestão contra o que o publicador de fato enviou (menos
+        // o que o próprio servidor descartou); a falta do publicador é
+        // relatada à parte, contra wall × fps
+        const double publisherWall = marked ? (last.micros - first.micros) / 1e6 : wall;
+        const double published = marked ? static_cast<double>(last.rounds - first.rounds) : 0.0;
+        const double serverDropped = marked ? static_cast<double>(last.dropped - first.dropped) : 0.0;
+        const double expected = published * streams - serverDropped;
+        int64_t delivered = 0;
+        for (int i = 0; i < streams; i++) {
+            const int64_t count = end[i] - start[i];
+            delivered += count;
+            if (count < published / 2) {
+                result.stalled++;
+            }
+        }
+        result.cores = (cpuSeconds(after) - cpuSeconds(before)) / wall;
+        result.switches = ((after.ru_nvcsw + after.ru_nivcsw) - (before.ru_nvcsw + before.ru_nivcsw)) / wall;
+        result.loss = expected > 0.0 ? std::max(0.0, 1.0 - delivered / expected) : 1.0;
+        result.publisherShortfall = std::max(0.0, 1.0 - published / (publisherWall * settings.fps));
+
+        for (auto &source: sources) {
+            source->stop();
+        }
+        sources.clear();
+        kill(pid, SIGTERM);
+        pclose(publisher);
+        return marked;
+    }
+
+    void print(const Result &result, double threshold) {
+        std::printf("%7d %8d %7.2f %7ld %8ld %10.0f %8.2f%% %8d %8.2f%% %s\n",
+                    result.streams, result.connected, result.cores, result.rssMB, result.threads,
+                    result.switches, result.loss * 100.0, result.stalled, result.publisherShortfall * 100.0,
+                    result.publisherShortfall > threshold ? "publicador saturado" : "");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Settings settings;
+
+    if (argc > 1 && std::strcmp(argv[1], "--publish") == 0) {
+        if (argc < 8) {
+            return 1;
+        }
+        settings.width = std::atoi(argv[4]);
+        settings.height = std::atoi(argv[5]);
+        settings.fps = std::atoi(argv[6]);
+        settings.encoder = argv[7];
+        try {
+            return publish(std::atoi(argv[2]), std::atoi(argv[3]), settings);
+        } catch (const Exception &e) {
+            std::fprintf(stderr, "Publicador: %s\n", e.what());
+            return 1;
+        }
+    }
+
+    const int maxStreams = argc > 1 ? std::atoi(argv[1]) : 64;
+    settings.seconds = argc > 2 ? std::atoi(argv[2]) : 10;
+    settings.width = argc > 3 ? std::atoi(argv[3]) : 640;
+    settings.height = argc > 4 ? std::atoi(argv[4]) : 360;
+    settings.fps = argc > 5 ? std::atoi(argv[5]) : 30;
+    settings.encoder = argc > 6 ? argv[6] : "libx264";
+    const double threshold = argc > 7 ? std::atof(argv[7]) : 0.01;
+
+    std::printf("%dx%d@%d, %s, %d s por ponto, limite de perda %.1f%%, %u núcleos\n\n",
+                settings.width, settings.height, settings.fps, settings.encoder.c_str(), settings.seconds,
+                threshold * 100.0, std::thread::hardware_concurrency());
+    std::printf("%7s %8s %7s %7s %8s %10s %9s %8s %9s\n", "streams", "conexões", "núcleos", "rss_MB",
+                "threads", "trocas/s", "perda", "parados", "pub_falta");
+
+    int port = BASE_PORT;
+    int good = 0;
+    int bad = 0;
+    try {
+        // Crescimento exponencial até a primeira perda acima do limite
+        for (int streams = 1; streams <= maxStreams; streams *= 2) {
+            Result result;
+            if (!run(argv[0], streams, port++, settings, result)) {
+                bad = streams;
+                break;
+            }
+            print(result, threshold);
+            if (result.loss > threshold || result.connected < streams) {
+                bad = streams;
+                break;
+            }
+            good = streams;
+        }
+
+        // Bisseção entre o último N sem perda e o primeiro com perda
+        while (bad > 0 && bad - good > 1) {
+            const int streams = (good + bad) / 2;
+            Result result;
+            if (!run(argv[0], streams, port++, settings, result)) {
+                bad = streams;
+                continue;
+            }
+            print(result, threshold);
+            if (result.loss > threshold || result.connected < streams) {
+                bad = streams;
+            } else {
+                good = streams;
+            }
+        }
+    } catch (const Exception &e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 1;
+    }
+
+    if (bad == 0) {
+        std::printf("\nSem perda acima do limite até %d streams\n", good);
+    } else {
+        std::printf("\nJoelho: %d streams (perda acima de %.1f%% com %d)\n", good, threshold * 100.0, bad);
+    }
+    return 0;
+}
@@ -0,0 +1,292 @@
+// Microbenchmarks dos kernels do caminho de frames, em 720p, 1080p e 4K:
+// conversão BGR24 -> YUV420P do servidor (ServerStream::convertFrame), cópia
+// dos planos do processFrame (VideoSource::createFrameData), alocação e
+// copyFrom/copyTo do FrameData e o ciclo encode -> decode de um frame.
+// Mede também o custo de uma amostra nos histogramas de latência por estágio
+// (LatencyHistogram::record, com e sem leitura do relógio; meta < 50 ns).
+// Usa Google Benchmark; a saída JSON alimenta benchmarks/compare_bench.py
+// para comparar duas execuções e apontar regressões.
+//
+// Uso: turbovision_bench [--benchmark_filter=<regex>]
+//                        [--benchmark_out=<arquivo.json> --benchmark_out_format=json]
+
+#include <turbovision/core/latency_histogram.hpp>
+#include <turbovision/server/server_stream.hpp>
+#include <turbovision/sources/video_source.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+using namespace turbovision;
+
+namespace {
+    // Frames distintos no ciclo encode/decode (evita medir só frames repetidos)
+    constexpr int ROUND_TRIP_FRAMES = 8;
+
+    void resolutions(benchmark::internal::Benchmark *benchmark) {
+        benchmark->ArgNames({"width", "height"});
+        benchmark->Args({1280, 720});
+        benchmark->Args({1920, 1080});
+        benchmark->Args({3840, 2160});
+    }
+
+    // Frame em CPU com linesize == largura, como sai da maioria dos decoders
+    // nessas resoluções
+    AVFrame *allocFrame(int width, int height, AVPixelFormat format, int seed) {
+        AVFrame *frame = av_frame_alloc();
+        if (!frame) {
+            return nullptr;
+        }
+        frame->width = width;
+        frame->height = height;
+        frame->format = format;
+        if (av_frame_get_buffer(frame, 1) < 0) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+        for (int plane = 0; plane < AV_NUM_DATA_POINTERS && frame->data[plane]; plane++) {
+            const int rows = plane == 0 ? height : height / 2;
+            for (int y = 0; y < rows; y++) {
+                uint8_t *row = frame->data[plane] + y * frame->linesize[plane];
+                for (int x = 0; x < frame->linesize[plane]; x++) {
+                    row[x] = static_cast<uint8_t>(x + y * 3 + seed * 7 + plane * 64);
+                }
+            }
+        }
+        return frame;
+    }
+
+    void BM_ConvertFrame(benchmark::State &state) {
+        const int width = static_cast<int>(state.range(0));
+        const int height = static_cast<int>(state.range(1));
+        std::vector<uint8_t> bgr(static_cast<size_t>(width) * height * 3);
+        for (size_t i = 0; i < bgr.size(); i++) {
+            bgr[i] = static_cast<uint8_t>(i * 31);
+        }
+        AVFrame *frame = allocFrame(width, height, AV_PIX_FMT_YUV420P, 0);
+        if (!frame) {
+            state.SkipWithError("Falha ao alocar frame");
+            return;
+        }
+
+        for (auto _: state) {
+            ServerStream::convertFrame(bgr.data(), static_cast<int>(bgr.size()), frame);
+            benchmark::DoNotOptimize(frame->data[0]);
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bgr.size()));
+        state.SetItemsProcessed(state.iterations());
+        av_frame_free(&frame);
+    }
+
+    void planeCopy(benchmark::State &state, AVPixelFormat format) {
+        const int width = static_cast<int>(state.range(0));
+        const int height = static_cast<int>(state.range(1));
+        AVFrame *frame = allocFrame(width, height, format, 0);
+        if (!frame) {
+            state.SkipWithError("Falha ao alocar frame");
+            return;
+        }
+
+        int64_t bytes = 0;
+        for (auto _: state) {
+            FramePtr copy = VideoSource::createFrameData(frame, 0);
+            benchmark::DoNotOptimize(copy->data());
+            bytes += copy->dataSize();
+        }
+        state.SetBytesProcessed(bytes);
+        state.SetItemsProcessed(state.iterations());
+        av_frame_free(&frame);
+    }
+
+    void BM_PlaneCopyYUV420P(benchmark::State &state) {
+        planeCopy(state, AV_PIX_FMT_YUV420P);
+    }
+
+    void BM_PlaneCopyNV12(benchmark::State &state) {
+        planeCopy(state, AV_PIX_FMT_NV12);
+    }
+
+    void BM_FrameDataAlloc(benchmark::State &state) {
+        const int width = static_cast<int>(state.range(0));
+        const int height = static_cast<int>(state.range(1));
+        for (auto _: state) {
+            FramePtr frame = std::make_shared<FrameData>(width, height, AV_PIX_FMT_YUV420P);
+            benchmark::DoNotOptimize(frame->data());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_FrameDataCopyFrom(benchmark::State &state) {
+        FrameData frame(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), AV_PIX_FMT_YUV420P);
+        const std::vector<uint8_t> source(frame.dataSize(), 0x80);
+        for (auto _: state) {
+            frame.copyFrom(source.data(), frame.dataSize());
+            benchmark::DoNotOptimize(frame.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * frame.dataSize());
+    }
+
+    void BM_FrameDataCopyTo(benchmark::State &state) {
+        FrameData frame(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), AV_PIX_FMT_YUV420P);
+        std::vector<uint8_t> destination(frame.dataSize());
+        frame.copyFrom(destination.data(), frame.dataSize());
+        for (auto _: state) {
+            frame.copyTo(destination.data(), frame.dataSize());
+            benchmark::DoNotOptimize(destination.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * frame.dataSize());
+    }
+
+    void BM_LatencyHistogramRecord(benchmark::State &state) {
+        static LatencyHistogram histogram;
+        int64_t value = 1000 + state.thread_index() * 37;
+        for (auto _: state) {
+            histogram.record(value);
+            value = (value * 1103515245 + 12345) & 0xFFFFFFF;  // Espalha pelos buckets
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_LatencyHistogramRecordSince(benchmark::State &state) {
+        static LatencyHistogram histogram;
+        int64_t start = LatencyHistogram::now();
+        for (auto _: state) {
+            start = histogram.recordSince(start);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Encoder e decoder em software, configurados como no servidor (CodecBackend)
+    struct RoundTrip {
+        AVCodecContext *encoder = nullptr;
+        AVCodecContext *decoder = nullptr;
+        AVPacket *packet = nullptr;
+        AVFrame *decoded = nullptr;
+
+        ~RoundTrip() {
+            av_frame_free(&decoded);
+            av_packet_free(&packet);
+            avcodec_free_context(&decoder);
+            avcodec_free_context(&encoder);
+        }
+
+        bool open(int width, int height) {
+            ServerConfig::EncoderConfig encoderConfig;
+            encoderConfig.encoder = "libx264";
+            encoderConfig.lowLatency = true;
+            encoderConfig.gopSize = 30;
+            encoderConfig.bitrate = width * height * 3;   // ~2.7 Mbps em 720p, ~25 Mbps em 4K
+
+            std::unique_ptr<CodecBackend> backend = CodecBackend::create(encoderConfig.encoder, false);
+            if (!backend) {
+                return false;
+            }
+            encoder = avcodec_alloc_context3(backend->codec());
+            if (!encoder) {
+                return false;
+            }
+            encoder->width = width;
+            encoder->height = height;
+            encoder->pix_fmt = AV_PIX_FMT_YUV420P;
+            encoder->time_base = AVRational{1, 30};
+            encoder->framerate = AVRational{30, 1};
+            encoder->bit_rate = encoderConfig.bitrate;
+            encoder->gop_size = encoderConfig.gopSize;
+
+            AVDictionary *options = nullptr;
+            backend->configure(encoder, &options, encoderConfig, backend->selectPreset(encoderConfig), 0);
+            const int ret = avcodec_open2(encoder, backend->codec(), &options);
+            av_dict_free(&options);
+            if (ret < 0) {
+                return false;
+            }
+
+            const AVCodec *codec = avcodec_find_decoder(encoder->codec_id);
+            decoder = codec ? avcodec_alloc_context3(codec) : nullptr;
+            if (!decoder || avcodec_open2(decoder, codec, nullptr) < 0) {
+                return false;
+            }
+            packet = av_packet_alloc();
+            decoded = av_frame_alloc();
+            return packet && decoded;
+        }
+
+        // Frames decodificados a partir de um frame de entrada
+        int run(AVFrame *frame, int64_t &bytes) {
+            int frames = 0;
+            if (avcodec_send_frame(encoder, frame) < 0) {
+                return -1;
+            }
+            while (avcodec_receive_packet(encoder, packet) >= 0) {
+                bytes += packet->size;
+                avcodec_send_packet(decoder, packet);
+                av_packet_unref(packet);
+                while (avcodec_receive_frame(decoder, decoded) >= 0) {
+                    frames++;
+                    av_frame_unref(decoded);
+                }
+            }
+            return frames;
+        }
+    };
+
+    void BM_EncodeDecodeRoundTrip(benchmark::State &state) {
+        const int width = static_cast<int>(state.range(0));
+        const int height = static_cast<int>(state.range(1));
+        RoundTrip roundTrip;
+        if (!roundTrip.open(width, height)) {
+            state.SkipWithError("Encoder/decoder indisponível");
+            return;
+        }
+        std::vector<AVFrame *> inputs;
+        for (int i = 0; i < ROUND_TRIP_FRAMES; i++) {
+            AVFrame *frame = allocFrame(width, height, AV_PIX_FMT_YUV420P, i);
+            if (!frame) {
+                break;
+            }
+            inputs.push_back(frame);
+        }
+
+        int64_t pts = 0;
+        int64_t decoded = 0;
+        int64_t bytes = 0;
+        for (auto _: state) {
+            if (inputs.size() != ROUND_TRIP_FRAMES) {
+                state.SkipWithError("Falha ao alocar frames");
+                break;
+            }
+            AVFrame *frame = inputs[pts % ROUND_TRIP_FRAMES];
+            frame->pts = pts++;
+            const int frames = roundTrip.run(frame, bytes);
+            if (frames < 0) {
+                state.SkipWithError("Falha ao codificar");
+                break;
+            }
+            decoded += frames;
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["decoded"] = static_cast<double>(decoded);
+        state.counters["bytes_per_frame"] = benchmark::Counter(static_cast<double>(bytes),
+                                                               benchmark::Counter::kAvgIterations);
+        for (AVFrame *frame: inputs) {
+            av_frame_free(&frame);
+        }
+    }
+}
+
+BENCHMARK(BM_ConvertFrame)->Apply(resolutions);
+BENCHMARK(BM_PlaneCopyYUV420P)->Apply(resolutions);
+BENCHMARK(BM_PlaneCopyNV12)->Apply(resolutions);
+BENCHMARK(BM_FrameDataAlloc)->Apply(resolutions);
+BENCHMARK(BM_FrameDataCopyFrom)->Apply(resolutions);
+BENCHMARK(BM_FrameDataCopyTo)->Apply(resolutions);
+BENCHMARK(BM_LatencyHistogramRecord)->ThreadRange(1, 4);
+BENCHMARK(BM_LatencyHistogramRecordSince);
+BENCHMARK(BM_EncodeDecodeRoundTrip)->Apply(resolutions)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -10,29 +10,39 @@ using namespace turbovision;
 // Flag global para controle
 std::atomic<bool> running{true};
 
-int main() {
+int main(int argc, char *argv[]) {
     try {
         std::cout << "Inicializando TurboVision..." << std::endl;
         initialize();
 
-        std::cout << "Configurando conexão RTSP..." << std::endl;
-
         VideoConfig vidConfig;
         vidConfig.width = 1920;
         vidConfig.height = 1080;
         vidConfig.fps = 20;
         vidConfig.deviceType = DeviceType::AUTO;
 
-        RTSPSource::RTSPConfig rtspConfig;
-        rtspConfig.url = "rtsp://107.178.220.235:8554/live/liveStream_ROZL4721943W7_0_0";
-        rtspConfig.useTCP = true;
-        rtspConfig.reconnectOnError = true;
-        rtspConfig.timeout = 5000000; // 5 segundos em microssegundos
-
-        std::cout << "Criando fonte RTSP..." << std::endl;
-        auto source = std::make_shared<RTSPSource>(vidConfig, rtspConfig);
+        // Sem URL: fonte sintética (H.264 codificado e decodificado localmente)
+        std::shared_ptr<VideoSource> source;
+        if (argc > 1) {
+            std::cout << "Configurando conexão RTSP..." << std::endl;
+
+            RTSPSource::RTSPConfig rtspConfig;
+            rtspConfig.url = argv[1];
+            rtspConfig.useTCP = true;
+            rtspConfig.reconnectOnError = true;
+            rtspConfig.timeout = 5000000; // 5 segundos em microssegundos
+
+            std::cout << "Criando fonte RTSP..." << std::endl;
+            source = std::make_shared<RTSPSource>(vidConfig, rtspConfig);
+        } else {
+            std::cout << "Criando fonte sintética (uso: capture_example [rtsp://...])..." << std::endl;
+
+            SyntheticSource::SyntheticConfig syntheticConfig;
+            syntheticConfig.encode = true;
+            source = std::make_shared<SyntheticSource>(vidConfig, syntheticConfig);
+        }
         if (!source) {
-            throw Exception("Falha ao criar RTSPSource");
+            throw Exception("Falha ao criar a fonte");
         }
 
         // Configurar callback
@@ -24,11 +24,13 @@ namespace turbovision {
         int width() const { return width_; }
         int height() const { return height_; }
         AVPixelFormat format() const { return format_; }
-        int64_t timestamp() const { return timestamp_; }
+        int64_t timestamp() const { return timestamp_; }  // µs (AV_TIME_BASE)
+        int64_t sequence() const { return sequence_; }    // Posição na ordem de exibição (-1 = não definida)
         int dataSize() const { return dataSize_; }
 
         // Setters
         void setTimestamp(int64_t ts) { timestamp_ = ts; }
+        void setSequence(int64_t sequence) { sequence_ = sequence; }
 
         // Métodos de utilidade
         bool copyFrom(const uint8_t* src, int size);
@@ -51,6 +53,7 @@ namespace turbovision {
         int height_;
         AVPixelFormat format_;
         int64_t timestamp_;
+        int64_t sequence_;
         int dataSize_;
 
         static const int MAX_PLANES = 4;
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "common.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace turbovision {
+
+    // Histograma de latência no estilo HDR: buckets log-lineares (32 por
+    // potência de 2, erro relativo < 2%) de 1 ns a ~18 min. record() é um
+    // fetch_add no bucket e na soma, sem lock nem alocação, e pode ser
+    // chamado de várias threads. snapshot(true) zera bucket a bucket com
+    // exchange: amostras concorrentes caem num intervalo ou no seguinte,
+    // nunca se perdem.
+    class TURBOVISION_API LatencyHistogram {
+    public:
+        // Percentis em µs
+        struct Summary {
+            int64_t count = 0;
+            double mean = 0.0;
+            double p50 = 0.0;
+            double p90 = 0.0;
+            double p99 = 0.0;
+            double p999 = 0.0;
+            double max = 0.0;
+        };
+
+        // Cópia dos contadores; snapshots de histogramas diferentes podem
+        // ser somados (ex.: todos os streams de um servidor)
+        class TURBOVISION_API Snapshot {
+        public:
+            Snapshot();
+
+            void merge(const Snapshot& other);
+            int64_t count() const { return count_; }
+            double percentile(double quantile) const;  // µs, quantile em [0, 1]
+            Summary summary() const;
+
+        private:
+            friend class LatencyHistogram;
+            std::vector<int64_t> counts_;
+            int64_t count_;
+            int64_t sum_;              // ns
+            int64_t max_;              // ns
+        };
+
+        LatencyHistogram();
+
+        // Previne cópia
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void record(int64_t nanoseconds) {
+            if (nanoseconds < 0) {
+                nanoseconds = 0;
+            }
+            counts_[bucketOf(static_cast<uint64_t>(nanoseconds))].fetch_add(1, std::memory_order_relaxed);
+            sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+            int64_t current = max_.load(std::memory_order_relaxed);
+            while (nanoseconds > current &&
+                   !max_.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed)) {
+            }
+        }
+
+        // Registra now() - start e devolve o now() usado, que serve de
+        // início para o estágio seguinte
+        int64_t recordSince(int64_t start) {
+            const int64_t end = now();
+            record(end - start);
+            return end;
+        }
+
+        // Soma os contadores em snapshot (reset = zera o histograma)
+        void collect(Snapshot& snapshot, bool reset = false);
+        Snapshot snapshot(bool reset = false);
+        void reset();
+
+        // Relógio dos estágios, em ns
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    private:
+        static const int SUB_BITS = 5;
+        static const int SUB_BUCKETS = 1 << SUB_BITS;
+        static const int MAX_MAGNITUDE = 40;   // 2^40 ns ≈ 18 min; acima disso satura
+        static const int BUCKETS = (MAX_MAGNITUDE - SUB_BITS + 1) * SUB_BUCKETS;
+
+        static int bucketOf(uint64_t value) {
+            if (value < SUB_BUCKETS) {
+                return static_cast<int>(value);
+            }
+            if (value >= (uint64_t(1) << MAX_MAGNITUDE)) {
+                value = (uint64_t(1) << MAX_MAGNITUDE) - 1;
+            }
+#if defined(_MSC_VER)
+            unsigned long magnitude;
+            _BitScanReverse64(&magnitude, value);
+#else
+            const int magnitude = 63 - __builtin_clzll(value);
+#endif
+            const int shift = static_cast<int>(magnitude) - SUB_BITS;
+            return (shift + 1) * SUB_BUCKETS + static_cast<int>(value >> shift) - SUB_BUCKETS;
+        }
+
+        // Valor representativo do bucket (ponto médio), em ns
+        static double bucketValue(int index);
+
+        std::array<std::atomic<uint64_t>, BUCKETS> counts_;
+        std::atomic<int64_t> sum_;
+        std::atomic<int64_t> max_;
+    };
+
+} // namespace turbovision
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace turbovision {
+
+    // Publica um valor de um único escritor para leitores sem lock. O valor
+    // é copiado em palavras atômicas entre dois incrementos da sequência
+    // (ímpar = escrita em andamento); o leitor refaz a cópia se a sequência
+    // mudou, então nunca vê metade de uma publicação. Escritores
+    // concorrentes precisam de sincronização externa.
+    template<typename T>
+    class SeqLock {
+        static_assert(std::is_trivially_copyable<T>::value, "SeqLock exige um tipo trivialmente copiável");
+
+    public:
+        SeqLock()
+            : sequence_(0) {
+            for (auto &word: words_) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Previne cópia
+        SeqLock(const SeqLock&) = delete;
+        SeqLock& operator=(const SeqLock&) = delete;
+
+        void store(const T& value) {
+            uint64_t words[WORDS] = {};
+            std::memcpy(words, &value, sizeof(T));
+
+            const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+            sequence_.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; i++) {
+                words_[i].store(words[i], std::memory_order_relaxed);
+            }
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        T load() const {
+            uint64_t words[WORDS];
+            while (true) {
+                const uint64_t before = sequence_.load(std::memory_order_acquire);
+                if (before & 1) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t i = 0; i < WORDS; i++) {
+                    words[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+    private:
+        static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        std::atomic<uint64_t> sequence_;
+        std::array<std::atomic<uint64_t>, WORDS> words_;
+    };
+
+} // namespace turbovision
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace turbovision {
+
+    class TURBOVISION_API WorkerPool {
+    public:
+        using Task = std::function<void()>;
+
+        // threadCount = 0 usa std::thread::hardware_concurrency()
+        explicit WorkerPool(size_t threadCount = 0);
+        ~WorkerPool();
+
+        // Previne cópia
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        // Enfileira uma tarefa. Retorna false se o pool já foi finalizado.
+        bool post(Task task);
+
+        // Finaliza o pool. Tarefas pendentes são executadas antes do join.
+        void shutdown();
+
+        size_t size() const { return workers_.size(); }
+        size_t pendingTasks() const;
+
+    private:
+        std::vector<std::thread> workers_;
+        std::queue<Task> tasks_;
+        mutable std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stopping_;
+
+        void workerLoop();
+    };
+
+} // namespace turbovision
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace turbovision {
+
+// Detector de mudança de cena para VFR (ServerConfig::skipStaticFrames).
+// Compara a luma subamostrada (1 linha em 4) de cada frame com a do último
+// frame codificado, em blocos de 16x16 pixels, usando SAD em SIMD. Basta um
+// bloco acima do limiar para o frame contar como mudança, então objetos
+// pequenos em movimento não se perdem na média do frame inteiro.
+class TURBOVISION_API ChangeDetector {
+public:
+    // threshold: diferença média por amostra de luma em um bloco
+    explicit ChangeDetector(int threshold);
+
+    // true se o frame (YUV420P) difere da referência
+    bool hasChanged(const AVFrame* frame) const;
+
+    // Passa a usar o frame como referência (frame codificado)
+    void setReference(const AVFrame* frame);
+
+    void reset();
+
+private:
+    int threshold_;
+    int width_;
+    int height_;
+    std::vector<uint8_t> reference_;   // Linhas amostradas, contíguas
+};
+
+} // namespace turbovision
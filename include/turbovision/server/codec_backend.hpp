@@ -0,0 +1,82 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+#include "server_config.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace turbovision {
+
+// Backend de codificação do servidor (EncoderConfig::encoder). Cada backend
+// traduz o EncoderConfig, incluindo Advanced, para as opções do seu encoder
+// no FFmpeg e tem o próprio perfil de baixa latência. Valores que o encoder
+// não aceita (um preset do NVENC no x264, por exemplo) são ignorados em vez
+// de impedir a abertura. Backends: libx264, libx265, libsvtav1 e NVENC
+// (H.264, HEVC e AV1); outros encoders usam só as opções genéricas.
+class TURBOVISION_API CodecBackend {
+public:
+    struct Capabilities {
+        std::string encoder;                // Nome do encoder no FFmpeg
+        AVCodecID codecId = AV_CODEC_ID_NONE;
+        bool hardware = false;
+        bool available = false;             // Presente no FFmpeg em uso (e empacotável em RTP)
+        bool rtp = true;                    // O muxer RTP do FFmpeg em uso empacota o codec
+        bool intraRefresh = false;          // EncoderConfig::intraRefresh
+        bool sliceSize = false;             // Limite de bytes por slice (sliceOutput)
+        bool regionsOfInterest = false;     // AV_FRAME_DATA_REGIONS_OF_INTEREST
+        std::vector<std::string> presets;   // Do mais rápido ao mais lento
+        std::string defaultPreset;          // Preset do encoder quando nenhum é passado
+        std::string lowLatencyPreset;
+        std::vector<std::string> tunes;
+        std::string lowLatencyTune;
+        std::vector<std::string> profiles;
+    };
+
+    virtual ~CodecBackend() = default;
+
+    // Previne cópia
+    CodecBackend(const CodecBackend&) = delete;
+    CodecBackend& operator=(const CodecBackend&) = delete;
+
+    const Capabilities& capabilities() const { return capabilities_; }
+    const AVCodec* codec() const { return codec_; }
+
+    // advanced.preset se o encoder aceitar; senão o do perfil de baixa
+    // latência (lowLatency) ou vazio (padrão do encoder)
+    std::string selectPreset(const ServerConfig::EncoderConfig& config) const;
+
+    // Preenche o contexto e as opções de avcodec_open2. Com bit_rate <= 0 o
+    // encoder roda em qualidade constante com advanced.qp.
+    void configure(AVCodecContext* context, AVDictionary** options,
+                   const ServerConfig::EncoderConfig& config,
+                   const std::string& preset, int maxSliceSize) const;
+
+    // Backend do encoder pedido. Sem o encoder no FFmpeg, ou sem GPU para um
+    // encoder de hardware, cai para o encoder por software do mesmo codec.
+    // nullptr se nada servir ou se o muxer RTP não empacota o codec (AV1
+    // antes do FFmpeg 7.1).
+    static std::unique_ptr<CodecBackend> create(const std::string& encoder, bool hardwareAvailable);
+
+    // Backends conhecidos e o que cada um suporta no FFmpeg em uso
+    static std::vector<Capabilities> query();
+
+protected:
+    CodecBackend(const std::string& encoder, AVCodecID codecId, const AVCodec* codec);
+
+    // Opções próprias do encoder, depois das genéricas
+    virtual void configureCodec(AVCodecContext* context, AVDictionary** options,
+                                const ServerConfig::EncoderConfig& config, int maxSliceSize) const;
+
+    static bool zeroLatency(const ServerConfig::EncoderConfig& config);
+
+    Capabilities capabilities_;
+
+private:
+    const AVCodec* codec_;
+
+    std::string selectTune(const ServerConfig::EncoderConfig& config) const;
+};
+
+} // namespace turbovision
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <chrono>
+
+namespace turbovision {
+
+// Governador de sobrecarga do encoder (EncoderConfig::overloadGovernor).
+// Compara o tempo de codificação de cada frame com o orçamento de 1/fps e
+// decide um nível de degradação: 0 é o nominal e cada nível acima troca
+// para um preset mais rápido, depois um fps menor, depois uma resolução
+// menor (o ServerStream traduz o nível). Sobe rápido (2 s acima de 90% do
+// orçamento) e só desce após carga baixa sustentada; uma recuperação que
+// volta a sobrecarregar dobra o tempo exigido para a próxima.
+class TURBOVISION_API EncoderGovernor {
+public:
+    explicit EncoderGovernor(int maxLevel);
+
+    // Tempo de codificação e orçamento do frame, em µs
+    void addSample(double encodeTime, double budget);
+
+    // Frames descartados por atraso da fila (latencyTarget)
+    void addMissed(int frames);
+
+    // Avalia a janela de 1 s; true quando o nível muda
+    bool update(std::chrono::steady_clock::time_point now);
+
+    int level() const { return level_; }
+    int transitions() const { return transitions_; }
+    float load() const { return load_; }   // Tempo de codificação / orçamento (média da última janela)
+
+private:
+    int maxLevel_;
+    int level_;
+    int transitions_;
+    float load_;
+
+    // Janela atual
+    double loadSum_;
+    int samples_;
+    int missed_;
+
+    int overloadedWindows_;
+    std::chrono::steady_clock::time_point windowStart_;
+    std::chrono::steady_clock::time_point lastChange_;
+    std::chrono::steady_clock::time_point underloadSince_;
+    std::chrono::steady_clock::time_point lastRecovery_;
+    std::chrono::seconds recoveryHold_;
+    bool underloaded_;
+};
+
+} // namespace turbovision
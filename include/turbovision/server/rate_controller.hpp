@@ -0,0 +1,71 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace turbovision {
+
+// Controle de congestionamento por stream a partir dos RTCP RR dos clientes
+// (AIMD no estilo do controlador por perda do GCC). A cada intervalo usa a
+// pior amostra recebida: perda acima de 10% reduz a taxa proporcionalmente,
+// atraso crescente (jitter, RTT ou fila TCP) reduz 15% e rede limpa sobe 8%.
+// No piso de bitrate o fps é reduzido; ele volta quando a taxa se recupera.
+class TURBOVISION_API RateController {
+public:
+    struct Settings {
+        int64_t minBitrate = 300000;       // bits/s
+        int64_t maxBitrate = 10000000;
+        int64_t startBitrate = 4000000;
+        int minFps = 5;
+        int maxFps = 30;
+        int interval = 1000;               // ms entre decisões
+    };
+
+    // Amostra de um cliente (RTCP RR ou fila de saída TCP)
+    struct Feedback {
+        double fractionLost = 0.0;         // 0-1
+        double jitter = 0.0;               // ms
+        double rtt = -1.0;                 // ms (-1 = desconhecido)
+        double queueDelay = 0.0;           // ms
+    };
+
+    struct Decision {
+        int64_t bitrate = 0;
+        int fps = 0;
+        const char* reason = "";           // "loss", "delay", "probe" ou "hold"
+        Feedback worst;                    // Pior amostra do intervalo
+    };
+
+    explicit RateController(const Settings& settings);
+
+    // Chamado pela thread do servidor a cada RR (thread-safe)
+    void onFeedback(const Feedback& feedback);
+
+    // Avalia o intervalo encerrado; false se ainda não for hora de decidir
+    // ou se não houve nenhuma amostra no período
+    bool update(std::chrono::steady_clock::time_point now, Decision& decision);
+
+    int64_t bitrate() const { return bitrate_; }
+    int fps() const { return fps_; }
+
+private:
+    Settings settings_;
+    int64_t bitrate_;
+    int fps_;
+
+    std::mutex feedbackMutex_;
+    Feedback worst_;
+    int samples_;
+
+    // Referências para detectar atraso crescente
+    double minRtt_;
+    double jitterBaseline_;
+
+    std::chrono::steady_clock::time_point lastUpdate_;
+    std::chrono::steady_clock::time_point lastFpsChange_;
+};
+
+} // namespace turbovision
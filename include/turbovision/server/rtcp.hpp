@@ -0,0 +1,36 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace turbovision {
+namespace rtcp {
+
+    // Bloco de report de um receiver report (RFC 3550, 6.4.1)
+    struct TURBOVISION_API ReportBlock {
+        uint32_t reporterSsrc = 0;     // SSRC de quem enviou o RR
+        uint32_t sourceSsrc = 0;       // SSRC da fonte reportada
+        uint8_t fractionLost = 0;      // Fração perdida (x/256) desde o último RR
+        int32_t cumulativeLost = 0;
+        uint32_t highestSequence = 0;  // Maior número de sequência estendido recebido
+        uint32_t jitter = 0;           // Jitter entre chegadas (unidades de timestamp RTP)
+        uint32_t lastSenderReport = 0; // LSR: 32 bits centrais do NTP do último SR
+        uint32_t delaySinceLastSenderReport = 0; // DLSR em 1/65536 s
+    };
+
+    // Extrai os report blocks de um pacote RTCP composto (SR e RR).
+    // Retorna false se o pacote não for RTCP válido.
+    TURBOVISION_API bool parseReportBlocks(const uint8_t* data, size_t size,
+                                           std::vector<ReportBlock>& blocks);
+
+    // 32 bits centrais do timestamp NTP atual (mesma base usada no SR)
+    TURBOVISION_API uint32_t ntpMiddle32Now();
+
+    // RTT em ms a partir de LSR/DLSR; negativo se o bloco não tiver LSR
+    TURBOVISION_API double roundTripTime(const ReportBlock& block, uint32_t ntpMiddle32);
+
+} // namespace rtcp
+} // namespace turbovision
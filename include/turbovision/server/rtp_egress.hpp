@@ -0,0 +1,123 @@
+#pragma once
+
+#include "rtp_packet.hpp"
+#include "server_config.hpp"
+#include "socket_utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace turbovision {
+
+// Contadores de envio (syscalls, datagramas e bytes entregues ao kernel)
+struct TURBOVISION_API EgressCounters {
+    std::atomic<uint64_t> syscalls{0};
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+struct TURBOVISION_API EgressOptions {
+    bool batched = true;    // sendmmsg (UDP) e writev (TCP)
+    bool gso = true;        // UDP_SEGMENT quando suportado pelo kernel
+    bool zeroCopy = false;  // MSG_ZEROCOPY nas conexões TCP
+
+    EgressOptions() = default;
+    explicit EgressOptions(const ServerConfig::NetworkConfig& network)
+        : batched(network.batchedSend)
+        , gso(network.udpSegmentOffload)
+        , zeroCopy(network.zeroCopy) {}
+};
+
+// Agrupa os datagramas de todos os clientes UDP de um frame e os envia com
+// o menor número possível de syscalls (sendmmsg + GSO no Linux).
+class TURBOVISION_API UdpEgress {
+public:
+    UdpEgress(const EgressOptions& options, EgressCounters& counters);
+    ~UdpEgress();
+
+    // Os pacotes precisam permanecer válidos até flush()
+    void add(net::SocketHandle socket, const sockaddr_in& target,
+             const RtpPacketPtr* packets, size_t count);
+    void flush();
+
+    // false depois que o kernel recusar UDP_SEGMENT uma vez
+    static bool isGsoAvailable();
+
+private:
+    struct Datagram {
+        net::SocketHandle socket;
+        sockaddr_in target;
+        size_t firstIov;
+        size_t iovCount;
+        uint16_t segmentSize;   // 0 = datagrama simples
+    };
+
+    EgressOptions options_;
+    EgressCounters& counters_;
+    std::vector<std::pair<const uint8_t*, size_t>> iovs_;
+    std::vector<Datagram> datagrams_;
+
+    void flushDatagrams(const std::vector<size_t>& indices, bool allowGso);
+    void sendUnbatched(const Datagram& datagram);
+};
+
+// Fila de saída de uma conexão RTSP (respostas e RTP interleaved). Os
+// payloads RTP são compartilhados entre clientes; apenas o cabeçalho
+// interleaved de 4 bytes é por conexão.
+class TURBOVISION_API InterleavedQueue {
+public:
+    InterleavedQueue();
+
+    void pushPacket(const RtpPacketPtr& packet, uint8_t channel);
+    void pushText(const std::string& text);
+
+    // Envia o máximo possível sem bloquear. Retorna false em erro fatal.
+    bool flush(net::SocketHandle socket, const EgressOptions& options, EgressCounters& counters);
+
+    // Libera buffers confirmados pelo kernel (notificações de MSG_ZEROCOPY)
+    void processCompletions(net::SocketHandle socket);
+
+    bool empty() const { return chunks_.empty(); }
+    size_t bytes() const { return bytes_; }
+    size_t size() const { return chunks_.size(); }
+    void clear();
+
+    // Idade do item mais antigo da fila em ms (0 se vazia)
+    double oldestDelay(std::chrono::steady_clock::time_point now) const;
+
+    // Descarta o RTP pendente anterior ao keyframe mais recente da fila
+    // (respostas RTSP e o item em envio parcial são mantidos). Retorna o
+    // número de pacotes descartados; keyframeKept indica se a fila ainda
+    // começa em um keyframe.
+    size_t dropUntilKeyframe(bool& keyframeKept);
+
+private:
+    struct Chunk {
+        RtpPacketPtr packet;
+        std::string text;
+        uint8_t header[4];
+        size_t offset = 0;      // Bytes já enviados
+        std::chrono::steady_clock::time_point queuedAt;
+
+        size_t size() const;
+    };
+    using ChunkPtr = std::shared_ptr<Chunk>;
+
+    std::deque<ChunkPtr> chunks_;
+    size_t bytes_;
+
+    // MSG_ZEROCOPY: chunks presos até a confirmação do envio
+    int zeroCopyState_;     // 0 = não testado, 1 = ativo, -1 = indisponível
+    uint32_t zeroCopyNextId_;
+    std::deque<std::pair<uint32_t, std::vector<ChunkPtr>>> zeroCopyPending_;
+
+    bool flushBatched(net::SocketHandle socket, bool zeroCopy, EgressCounters& counters);
+    bool flushPerChunk(net::SocketHandle socket, EgressCounters& counters);
+    void consume(size_t sent, EgressCounters& counters);
+};
+
+} // namespace turbovision
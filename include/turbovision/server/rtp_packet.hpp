@@ -0,0 +1,21 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace turbovision {
+
+// Pacote RTP/RTCP já serializado, compartilhado entre todos os clientes
+struct RtpPacket {
+    std::vector<uint8_t> data;
+    bool rtcp = false;          // Sender report gerado pelo muxer
+    bool keyframe = false;      // Pertence a um keyframe
+    bool frameStart = false;    // Primeiro pacote do frame
+};
+
+using RtpPacketPtr = std::shared_ptr<const RtpPacket>;
+using RtpPacketBatch = std::vector<RtpPacketPtr>;
+
+} // namespace turbovision
@@ -4,16 +4,26 @@
 #include "turbovision/core/video_config.hpp"
 #include "turbovision/core/hardware_manager.hpp"
 #include "turbovision/core/frame_data.hpp"
+#include "turbovision/core/worker_pool.hpp"
+#include "turbovision/core/latency_histogram.hpp"
 #include "server_config.hpp"
+#include "socket_utils.hpp"
+#include "rtp_egress.hpp"
 
 #include <thread>
 #include <mutex>
-#include <queue>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 #include <atomic>
 #include <functional>
 
 namespace turbovision {
 
+class ServerStream;
+class RTSPSession;
+
 class TURBOVISION_API RTSPServer {
 public:
     // Estatísticas do servidor
@@ -26,6 +36,71 @@ public:
         int64_t uptime;              // Tempo de execução em segundos
         float avgLatency;             // Latência média em ms
         int droppedFrames;           // Frames descartados
+        int64_t staticFrames;         // Frames sem mudança não codificados (VFR)
+        int64_t sendCalls;            // Syscalls de envio de mídia
+        int64_t sentPackets;          // Pacotes RTP/RTCP entregues ao kernel
+        int64_t targetBitrate;        // Bitrate alvo do encoder em bits/s
+        int targetFps;                // fps alvo do encoder
+        float encoderLoad;            // Tempo de codificação / orçamento de 1/fps
+        int governorLevel;            // Degradação atual do governador (0 = nominal)
+        int governorTransitions;      // Trocas de nível do governador
+
+        // Percentis por estágio em µs, desde o último resetLatency()
+        LatencyHistogram::Summary convertLatency;   // BGR24 -> YUV420P (ou escala) em pushFrame
+        LatencyHistogram::Summary encodeLatency;    // Frame no encoder -> pacote codificado
+        LatencyHistogram::Summary writeLatency;     // Empacotamento RTP e envio aos sockets
+    };
+
+    // Parâmetros do encoder alteráveis sem reiniciar o servidor (0 = manter).
+    // Bitrate, VBV e GOP entram no próximo keyframe; fps abaixo do nominal
+    // descarta frames antes do encoder, sem keyframe; resolução reabre
+    // apenas o encoder, sem derrubar os clientes.
+    struct EncoderUpdate {
+        int64_t bitrate = 0;          // bits/s
+        int vbvSize = 0;              // Buffer VBV em bits
+        int gopSize = 0;
+        int fps = 0;
+        int width = 0;                // Resolução codificada (a entrada é escalada)
+        int height = 0;
+    };
+
+    // Região de interesse de um frame, em pixels da entrada (VideoConfig).
+    // Vira AV_FRAME_DATA_REGIONS_OF_INTEREST quando EncoderConfig::roiEncoding
+    // está ativo; a primeira região da lista prevalece nas sobreposições.
+    struct RegionOfInterest {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        float qualityOffset = -0.5f;  // -1 a 1; negativo = menor QP (mais qualidade)
+    };
+
+    // Estatísticas de um cliente em PLAY
+    struct ClientStats {
+        std::string address;          // Endereço ip:porta da conexão RTSP
+        std::string sessionId;
+        std::string streamName;
+        std::string transport;        // "TCP", "UDP" ou "MULTICAST"
+        size_t queueBytes;            // Bytes aguardando envio (TCP)
+        size_t queuePackets;          // Itens aguardando envio (TCP)
+        float queueDelay;             // Idade do item mais antigo da fila em ms
+        int64_t droppedPackets;       // Pacotes descartados por atraso
+        int resyncs;                  // Descartes até o próximo keyframe
+        float rtt;                    // RTT estimado em ms (-1 = desconhecido)
+        float fractionLost;           // Perda reportada no último RTCP RR (0-1)
+        float jitter;                 // Jitter reportado no último RTCP RR em ms
+    };
+
+    // Marcos de tempo de um frame no servidor, em µs do steady_clock. A
+    // diferença entre marcos consecutivos é a contribuição de cada estágio.
+    struct FrameTrace {
+        std::string streamName;
+        int64_t timestamp;            // Timestamp do frame (FrameData ou relógio de chegada)
+        int64_t pushed;               // Entrada em pushFrame
+        int64_t converted;            // Conversão/escala concluída, frame na fila
+        int64_t encodeStart;          // Frame entregue ao encoder
+        int64_t encoded;              // Pacote saiu do encoder
+        int64_t written;              // Pacotes RTP entregues ao kernel
     };
 
     RTSPServer(const ServerConfig& config, const VideoConfig& videoConfig);
@@ -36,12 +111,39 @@ public:
     void stop();
     bool isRunning() const { return isRunning_; }
 
-    // Envio de frames
-    bool pushFrame(const uint8_t* frameData, int size);
-    bool pushFrame(const FramePtr& frame);
-
-    // Estatísticas
+    // Gerenciamento de streams (pontos de montagem). Podem ser chamados
+    // antes ou depois de start(); todos compartilham a mesma porta.
+    bool addStream(const std::string& name, const VideoConfig& videoConfig);
+    bool removeStream(const std::string& name);
+    bool hasStream(const std::string& name) const;
+    std::vector<std::string> getStreamNames() const;
+
+    // Envio de frames para o stream padrão (config.streamName)
+    bool pushFrame(const uint8_t* frameData, int size,
+                   const std::vector<RegionOfInterest>& regions = {});
+    bool pushFrame(const FramePtr& frame,
+                   const std::vector<RegionOfInterest>& regions = {});
+
+    // Envio de frames para um stream específico
+    bool pushFrame(const std::string& streamName, const uint8_t* frameData, int size,
+                   const std::vector<RegionOfInterest>& regions = {});
+    bool pushFrame(const std::string& streamName, const FramePtr& frame,
+                   const std::vector<RegionOfInterest>& regions = {});
+
+    // Reconfiguração do encoder em tempo de execução
+    bool reconfigure(const EncoderUpdate& update);
+    bool reconfigure(const std::string& streamName, const EncoderUpdate& update);
+
+    // Estatísticas agregadas de todos os streams
     ServerStats getStats() const;
+    // Estatísticas de um stream específico
+    ServerStats getStats(const std::string& streamName) const;
+    // Estatísticas por cliente
+    std::vector<ClientStats> getClientStats() const;
+
+    // Zera os histogramas de latência de todos os streams (estatística por
+    // intervalo: getStats() seguido de resetLatency())
+    void resetLatency();
 
     // Callbacks para eventos
     using ClientConnectedCallback = std::function<void(const std::string& clientAddress)>;
@@ -50,48 +152,63 @@ public:
     void setClientConnectedCallback(ClientConnectedCallback callback);
     void setClientDisconnectedCallback(ClientDisconnectedCallback callback);
 
+    // Um FrameTrace por frame enviado, na thread de codificação (deve ser
+    // rápido). Sem callback nada é medido; nullptr desativa.
+    using FrameTraceCallback = std::function<void(const FrameTrace& trace)>;
+    void setFrameTraceCallback(FrameTraceCallback callback);
+
 private:
+    friend class RTSPSession;
+
     // Configurações
     ServerConfig config_;
     VideoConfig videoConfig_;
     std::shared_ptr<HardwareManager> hwManager_;
 
-    // Contextos FFmpeg
-    AVFormatContext* formatContext_;
-    AVCodecContext* encoderContext_;
-    AVStream* videoStream_;
+    // Streams registrados e pool de codificação
+    std::unique_ptr<WorkerPool> workerPool_;
+    std::map<std::string, std::shared_ptr<ServerStream>> streams_;
+    mutable std::mutex streamsMutex_;
+
+    // Rede: listener RTSP, sockets RTP/RTCP (UDP) e sessões
+    net::SocketHandle listenSocket_;
+    net::SocketHandle rtpSocket_;
+    net::SocketHandle rtcpSocket_;
+    int wakeupPipe_[2];
+    std::map<net::SocketHandle, std::shared_ptr<RTSPSession>> sessions_;
+    mutable std::mutex sessionsMutex_;  // Escrita só no loop de I/O
+    std::atomic<int> playingSessions_;
+    EgressOptions egressOptions_;
+    EgressCounters egressCounters_;
 
     // Estado do servidor
     std::atomic<bool> isRunning_;
     std::thread serverThread_;
-    std::mutex frameMutex_;
-    std::queue<AVFrame*> frameQueue_;
-    ServerStats stats_;
-    mutable std::mutex statsMutex_;
 
     // Callbacks
     ClientConnectedCallback clientConnectedCallback_;
     ClientDisconnectedCallback clientDisconnectedCallback_;
+    std::mutex callbackMutex_;
+    FrameTraceCallback frameTraceCallback_;     // Protegido por streamsMutex_
 
     // Métodos de inicialização
     bool initializeServer();
-    bool setupEncoder();
-    bool configureOutput();
-    bool setupNetworking(AVDictionary** options);
+    bool setupNetworking(net::SocketHandle socket);
+    void shutdownNetworking();
 
-    // Loop principal e processamento
+    // Loop principal de I/O (único para todas as conexões)
     void serverLoop();
-    void processFrame(AVFrame* frame);
-    bool encodeAndTransmit(AVFrame* frame);
-    void clearFrameQueue();
-
-    // Gerenciamento de estatísticas
-    void updateStats();
-    void resetStats();
-
-    // Utilitários
-    static AVFrame* createVideoFrame(int width, int height, AVPixelFormat pixFormat);
-    bool convertFrame(const uint8_t* data, int size, AVFrame* frame);
+    void acceptConnections();
+    void receiveRtcp();
+    void closeSession(const std::shared_ptr<RTSPSession>& session);
+    void closeAllSessions();
+    void wakeup();
+
+    // Usados pelas sessões
+    std::shared_ptr<ServerStream> findStream(const std::string& name) const;
+    bool canAcceptPlayer() const;
+    void notifyClientConnected(const std::string& address);
+    void notifyClientDisconnected(const std::string& address);
 };
 
-} // namespace turbovision
\ No newline at end of file
+} // namespace turbovision
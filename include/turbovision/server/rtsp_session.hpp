@@ -0,0 +1,120 @@
+#pragma once
+
+#include "server_stream.hpp"
+#include "socket_utils.hpp"
+#include "rtp_egress.hpp"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace turbovision {
+
+// Conexão RTSP de um cliente. Requisições são tratadas no loop de I/O do
+// servidor; pacotes RTP chegam das threads do WorkerPool via sendPackets().
+class TURBOVISION_API RTSPSession : public std::enable_shared_from_this<RTSPSession> {
+public:
+    enum class Transport {
+        NONE,
+        UDP,
+        TCP,
+        MULTICAST
+    };
+
+    RTSPSession(net::SocketHandle socket, const sockaddr_in& peer, RTSPServer& server);
+    ~RTSPSession();
+
+    // Previne cópia
+    RTSPSession(const RTSPSession&) = delete;
+    RTSPSession& operator=(const RTSPSession&) = delete;
+
+    // Eventos do loop de I/O. Retornam false quando a conexão deve ser encerrada.
+    bool onReadable();
+    bool onWritable();
+    bool wantsWrite() const;
+    bool onError();
+
+    // Envio de mídia (thread-safe). Pacotes UDP são agregados em udp.
+    void sendPackets(const RtpPacketBatch& packets, UdpEgress& udp);
+
+    // RTCP recebido do cliente (receiver reports)
+    bool isRtcpPeer(const sockaddr_in& address) const;
+    void onRtcp(const uint8_t* data, size_t size);
+
+    RTSPServer::ClientStats getStats() const;
+
+    void close();
+    bool isClosed() const { return closed_; }
+    bool isPlaying() const { return playing_; }
+    Transport transport() const { return transport_; }
+
+    net::SocketHandle socket() const { return socket_; }
+    const std::string& address() const { return address_; }
+    const std::string& sessionId() const { return sessionId_; }
+    std::chrono::steady_clock::time_point lastActivity() const;
+
+private:
+    struct Request {
+        std::string method;
+        std::string uri;
+        std::map<std::string, std::string> headers;  // Chaves em minúsculas
+        std::string body;
+        int cseq = 0;
+    };
+
+    RTSPServer& server_;
+    net::SocketHandle socket_;
+    sockaddr_in peer_;
+    std::string address_;
+    std::string sessionId_;
+
+    // Estado RTSP
+    std::shared_ptr<ServerStream> stream_;
+    Transport transport_;
+    sockaddr_in clientRtpAddress_;
+    sockaddr_in clientRtcpAddress_;
+    int rtpChannel_;
+    int rtcpChannel_;
+    std::atomic<bool> playing_;
+    std::atomic<bool> closed_;
+    bool waitingKeyframe_;
+
+    // Buffers de rede
+    std::string inBuffer_;
+    InterleavedQueue outQueue_;
+    mutable std::mutex outMutex_;
+    std::atomic<int64_t> lastActivity_;
+
+    // Controle da fila por cliente e estatísticas (protegidos por outMutex_)
+    std::chrono::steady_clock::time_point lastDrained_;
+    std::chrono::steady_clock::time_point lastKeyframeRequest_;
+    int64_t droppedPackets_;
+    int resyncs_;
+    double rtt_;
+    double fractionLost_;
+    double jitter_;
+
+    // Processamento de requisições
+    bool parseRequests();
+    void handleRequest(const Request& request);
+    void handleOptions(const Request& request);
+    void handleDescribe(const Request& request);
+    void handleSetup(const Request& request);
+    void handlePlay(const Request& request);
+    void handleTeardown(const Request& request);
+    void sendResponse(const Request& request, int code, const std::string& reason,
+                      const std::string& headers = std::string(),
+                      const std::string& body = std::string());
+    void stopPlaying();
+
+    // Escrita no socket TCP; outMutex_ deve estar travado
+    bool flushLocked();
+    bool enforceQueueLimits(std::chrono::steady_clock::time_point now);
+    void touch();
+
+    static std::string streamNameFromUri(const std::string& uri);
+    static std::string generateSessionId();
+};
+
+} // namespace turbovision
@@ -12,24 +12,44 @@ struct TURBOVISION_API ServerConfig {
     std::string streamName = "stream";    // Nome do stream
     int maxClients = 10;                  // Máximo de clientes simultâneos
     bool useTCP = true;                   // Usar TCP ao invés de UDP
+    int maxStreams = 256;                 // Máximo de streams registrados
+    int workerThreads = 0;                // Threads de codificação (0 = auto)
+    int maxQueuedFrames = 30;             // Frames pendentes por stream
+    bool useFrameTimestamps = true;       // pts a partir de FrameData::timestamp() (µs)
+    int latencyTarget = 100;              // Fila máxima em ms antes de pular para o frame mais novo (0 = sem limite)
+    bool steadyCadence = true;            // Alinha os pts à grade de 1/fps
+    bool skipStaticFrames = false;        // VFR: não codifica frames sem mudança de cena
+    int staticFrameInterval = 1;          // Cena estática: no mínimo 1 frame a cada N segundos
+    int staticThreshold = 6;              // Diferença média de luma em um bloco 16x16 que conta como mudança
+    int clientQueueBytes = 4 * 1024 * 1024; // Fila máxima de saída por cliente TCP
+    int clientQueueDelay = 500;           // Atraso máximo da fila por cliente (ms)
+    int clientEvictTimeout = 10000;       // Cliente sem esvaziar a fila é removido (ms)
 
     // Configurações do codificador
     struct EncoderConfig {
-        std::string encoder = "h264_nvenc";  // Encoder padrão (NVIDIA)
+        std::string encoder = "h264_nvenc";  // Encoder padrão (NVIDIA); também libx264, libx265, libsvtav1, hevc_nvenc, av1_nvenc
         int bitrate = 4000000;               // 4 Mbps
         int gopSize = 30;                    // GOP size
-        bool lowLatency = true;              // Modo de baixa latência
+        int vbvSize = 0;                     // Buffer VBV em bits (0 = padrão do encoder)
+        bool lowLatency = true;              // Perfil de baixa latência do encoder (preset rápido e, com zeroLatency, sem atraso de frames)
+        bool intraRefresh = false;           // Refresh intra em onda a cada gopSize frames, sem IDRs periódicos
+        bool sliceOutput = false;            // Slices do tamanho de um pacote RTP, enviados assim que empacotados
+        bool roiEncoding = false;            // Aplica as ROIs de pushFrame (no x264 liga a AQ, que o preset ultrafast desliga)
+        float roiBackgroundOffset = 0.3f;    // qoffset fora das ROIs (-1 a 1; positivo = menos bits)
+        bool overloadGovernor = false;       // Degrada preset, fps e resolução quando o encoder não acompanha o tempo real
+        int governorMinFps = 10;             // fps mínimo do governador
+        int governorMinHeight = 360;         // Altura mínima do governador
 
         // Configurações avançadas do encoder
         struct Advanced {
-            std::string preset = "p4";       // Preset de qualidade
-            std::string tune = "ull";        // Ultra low latency
+            std::string preset = "p4";       // Preset de qualidade (ignorado se o encoder não o aceitar)
+            std::string tune = "ull";        // Ultra low latency (idem)
             bool zeroLatency = true;         // Zero latency mode
             int maxBFrames = 0;              // Sem B-frames para menor latência
             int keyintMin = 15;              // GOP mínimo
             int threads = 0;                 // 0 = auto
-            int qp = 23;                     // Qualidade (0-51, menor = melhor)
-            std::string profile = "high";    // Perfil H.264
+            int qp = 23;                     // Qualidade constante com bitrate 0 (0-51, menor = melhor)
+            std::string profile = "high";    // Perfil do codec (ignorado se o encoder não o aceitar)
 
             Advanced() = default;
         } advanced;
@@ -44,8 +64,17 @@ struct TURBOVISION_API ServerConfig {
         bool enableMulticast = false;        // Habilitar multicast
         std::string multicastAddress;        // Endereço multicast
         int multicastTTL = 1;               // TTL multicast
+        int multicastPort = 5004;           // Porta base; cada stream usa um par RTP/RTCP
+        std::string multicastInterface;     // IP da interface de saída (vazio = padrão)
         int maxBitrate = 10000000;          // Bitrate máximo em bps (10 Mbps)
         int rateControl = 0;                // 0 = auto
+        bool adaptiveBitrate = false;       // Ajusta bitrate e fps pelos RTCP RR dos clientes
+        int minBitrate = 300000;            // Piso do controle adaptativo em bps
+        int minFps = 5;                     // fps mínimo sob congestionamento
+        int adaptationInterval = 1000;      // Período entre decisões em ms
+        bool batchedSend = true;            // sendmmsg (UDP) / writev (TCP)
+        bool udpSegmentOffload = true;      // UDP GSO quando disponível (Linux)
+        bool zeroCopy = false;              // MSG_ZEROCOPY em TCP (Linux)
 
         // Configurações de QoS
         struct QoSConfig {
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "rtsp_server.hpp"
+#include "rtp_packet.hpp"
+#include "rtp_egress.hpp"
+#include "rate_controller.hpp"
+#include "change_detector.hpp"
+#include "encoder_governor.hpp"
+#include "codec_backend.hpp"
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace turbovision {
+
+// Ponto de montagem do servidor: encoder, empacotador RTP e assinantes
+class TURBOVISION_API ServerStream : public std::enable_shared_from_this<ServerStream> {
+public:
+    ServerStream(const std::string& name,
+                 const ServerConfig& config,
+                 const VideoConfig& videoConfig,
+                 std::shared_ptr<HardwareManager> hwManager,
+                 WorkerPool& workerPool,
+                 EgressCounters& egressCounters);
+    ~ServerStream();
+
+    // Previne cópia
+    ServerStream(const ServerStream&) = delete;
+    ServerStream& operator=(const ServerStream&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return isOpen_; }
+
+    const std::string& name() const { return name_; }
+    const VideoConfig& videoConfig() const { return videoConfig_; }
+    std::string getSDP() const;
+
+    // Multicast (NetworkConfig::enableMulticast): grupo e portas do stream
+    bool isMulticast() const;
+    const std::string& multicastAddress() const;
+    int multicastPort() const;
+    int multicastTTL() const;
+
+    // Converte e enfileira um frame BGR24; a codificação roda no WorkerPool.
+    // timestamp em µs (AV_NOPTS_VALUE = usar o relógio de chegada).
+    bool pushFrame(const uint8_t* frameData, int size, int64_t timestamp = AV_NOPTS_VALUE,
+                   const std::vector<RTSPServer::RegionOfInterest>& regions = {});
+
+    // Anexa as ROIs (coordenadas em sourceWidth x sourceHeight) como
+    // AV_FRAME_DATA_REGIONS_OF_INTEREST, seguidas do fundo com backgroundOffset
+    static bool attachRegionsOfInterest(AVFrame* frame,
+                                        const std::vector<RTSPServer::RegionOfInterest>& regions,
+                                        float backgroundOffset, int sourceWidth, int sourceHeight);
+
+    // BGR24 -> YUV420P nas dimensões de frame, sem swscale (width * 3 bytes
+    // por linha). Estático para ser medido isoladamente (turbovision_bench)
+    static bool convertFrame(const uint8_t* data, int size, AVFrame* frame);
+
+    // Agenda novos parâmetros do encoder (ver RTSPServer::EncoderUpdate)
+    bool reconfigure(const RTSPServer::EncoderUpdate& update);
+
+    // Assinantes (sessões em PLAY)
+    void addSubscriber(const std::shared_ptr<RTSPSession>& session);
+    void removeSubscriber(const RTSPSession* session);
+    size_t subscriberCount() const;
+
+    // Força um keyframe no próximo frame (novo cliente ou ressincronização)
+    void requestKeyframe() { forceKeyframe_ = true; }
+
+    // Retorno de um cliente para o controle adaptativo (RR ou fila TCP)
+    void onFeedback(const RateController::Feedback& feedback);
+
+    RTSPServer::ServerStats getStats() const;
+
+    // Histogramas de latência por estágio; snapshots de vários streams se somam
+    struct LatencySnapshots {
+        LatencyHistogram::Snapshot convert;
+        LatencyHistogram::Snapshot encode;
+        LatencyHistogram::Snapshot write;
+    };
+    void collectLatency(LatencySnapshots& snapshots) const;
+    void resetLatency();
+
+    // Marcos de tempo por frame (ver RTSPServer::setFrameTraceCallback)
+    void setFrameTraceCallback(RTSPServer::FrameTraceCallback callback);
+
+private:
+    std::string name_;
+    ServerConfig config_;
+    VideoConfig videoConfig_;
+    std::shared_ptr<HardwareManager> hwManager_;
+    WorkerPool& workerPool_;
+    EgressOptions egressOptions_;
+    EgressCounters& egressCounters_;
+
+    // Envio multicast compartilhado por todos os assinantes do grupo
+    net::SocketHandle multicastSocket_;
+    sockaddr_in multicastRtpAddress_;
+    sockaddr_in multicastRtcpAddress_;
+    std::atomic<int> multicastSubscribers_;
+
+    // Parâmetros efetivos do encoder (alterados só pela tarefa de codificação)
+    int encodeWidth_;
+    int encodeHeight_;
+    int encodeFps_;
+    int64_t bitrate_;
+    int vbvSize_;
+    int gopSize_;
+    int openedGopSize_;         // GOP com que o encoder foi aberto
+    int gopPosition_;           // Frames desde o último keyframe
+    std::string preset_;        // Preset passado ao encoder (vazio = padrão)
+    std::unique_ptr<CodecBackend> codecBackend_;
+
+    // VFR: frames sem mudança desde o último codificado são pulados
+    ChangeDetector changeDetector_;
+    std::chrono::steady_clock::time_point lastEncodedArrival_;
+
+    // Controle adaptativo (NetworkConfig::adaptiveBitrate)
+    std::unique_ptr<RateController> rateController_;
+
+    // Governador de sobrecarga (EncoderConfig::overloadGovernor): o nível
+    // percorre presets mais rápidos, depois fps e depois resolução
+    std::unique_ptr<EncoderGovernor> governor_;
+    int basePreset_;            // Índice do preset inicial na escada do encoder
+    int presetSteps_;
+    int fpsSteps_;
+    int scaleSteps_;
+    int governorFps_;           // Teto de fps imposto pelo governador
+    int governorScale_;         // Degrau de resolução aplicado
+
+    // Reconfiguração pendente
+    std::mutex updateMutex_;
+    RTSPServer::EncoderUpdate pendingUpdate_;
+    bool updatePending_;
+
+    // Conversão BGR24 -> YUV420P (com escala quando a resolução muda)
+    std::mutex convertMutex_;
+    int outputWidth_;
+    int outputHeight_;
+    SwsContext* scaler_;
+
+    // Contextos FFmpeg
+    AVCodecContext* encoderContext_;
+    AVFormatContext* rtpContext_;
+    AVStream* videoStream_;
+    std::string sdp_;
+
+    // Fila de frames e agendamento no pool
+    std::atomic<bool> isOpen_;
+    std::atomic<bool> scheduled_;
+    std::atomic<bool> forceKeyframe_;
+    std::mutex frameMutex_;
+    struct QueuedFrame {
+        AVFrame* frame;
+        int64_t timestamp;                                // µs (produtor ou relógio)
+        std::chrono::steady_clock::time_point arrival;
+        std::chrono::steady_clock::time_point pushed;    // Entrada em pushFrame (antes da conversão)
+    };
+    std::deque<QueuedFrame> frameQueue_;
+
+    // Frames no encoder aguardando o pacote correspondente (com trace ativo)
+    struct PendingTrace {
+        int64_t pts;                                      // Base de tempo do encoder
+        RTSPServer::FrameTrace trace;
+    };
+    std::deque<PendingTrace> pendingTraces_;
+    std::atomic<bool> tracing_;
+    std::mutex traceMutex_;
+    RTSPServer::FrameTraceCallback traceCallback_;
+
+    // Mapeamento de timestamps para pts (acessado só pela tarefa de codificação)
+    int64_t lastPts_;
+    int64_t anchorTimestamp_;
+    int64_t anchorPts_;
+    int64_t lastTimestamp_;
+    int64_t cadenceError_;      // Desvio filtrado em relação à grade de 1/fps
+    int64_t nextSlotPts_;       // Próximo slot de 1/fps na dizimação (pts antes da cadência)
+    bool headerWritten_;
+
+    // Pacotes RTP gerados durante av_write_frame
+    RtpPacketBatch pendingPackets_;
+    bool currentKeyframe_;
+    bool frameStartPending_;
+
+    // Assinantes
+    mutable std::mutex subscribersMutex_;
+    std::vector<std::shared_ptr<RTSPSession>> subscribers_;
+
+    // Latência por estágio (ns), sem lock
+    mutable LatencyHistogram convertLatency_;
+    mutable LatencyHistogram encodeLatency_;
+    mutable LatencyHistogram writeLatency_;
+
+    // Estatísticas
+    RTSPServer::ServerStats stats_;
+    mutable std::mutex statsMutex_;
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point lastStatsUpdate_;
+    int64_t lastFrames_;
+    int64_t lastBytes_;
+
+    // Métodos de inicialização
+    bool setupEncoder();
+    void logEncoderSelection() const;
+    bool setupPacketizer();
+    bool setupMulticast();
+
+    // Processamento (executado no WorkerPool)
+    void schedule();
+    void processQueue();
+    bool encodeAndTransmit(AVFrame* frame);
+    bool transmitPackets(int64_t encodeStart);
+    bool applyPendingUpdate(const AVFrame* frame);
+    bool reopenEncoder();
+    void restoreOutputSize(int failedWidth, int failedHeight);
+    void failStream();
+    void adaptRate();
+    void setupGovernor();
+    void governEncoder();
+    bool computePts(int64_t timestamp, int64_t& pts);
+    bool isStatic(const QueuedFrame& queued);
+    void deliverPending();
+    void traceEncoded(int64_t pts, int64_t encoded, int64_t written);
+    void clearFrameQueue();
+
+    // Callback de escrita do AVIOContext do muxer RTP
+    static int writeRtpPacket(void* opaque, const uint8_t* buf, int size);
+
+    // Gerenciamento de estatísticas
+    void updateStats();
+    void resetStats();
+
+    // Utilitários
+    static AVFrame* createVideoFrame(int width, int height, AVPixelFormat pixFormat);
+    bool scaleFrame(const uint8_t* data, AVFrame* frame);
+};
+
+} // namespace turbovision
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+#include <string>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+namespace turbovision {
+namespace net {
+
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    const SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+#else
+    using SocketHandle = int;
+    const SocketHandle INVALID_SOCKET_HANDLE = -1;
+#endif
+
+    // Criação de sockets (já configurados como não bloqueantes)
+    TURBOVISION_API SocketHandle createTcpListener(const std::string& address, int port, int backlog);
+    TURBOVISION_API SocketHandle createUdpSocket(const std::string& address, int port);
+
+    TURBOVISION_API bool setNonBlocking(SocketHandle socket);
+    TURBOVISION_API void closeSocket(SocketHandle socket);
+    TURBOVISION_API void shutdownSocket(SocketHandle socket);
+
+    // Ajustes de socket
+    TURBOVISION_API bool setSendBufferSize(SocketHandle socket, int size);
+    TURBOVISION_API bool setTypeOfService(SocketHandle socket, int dscp);
+    TURBOVISION_API bool setNoDelay(SocketHandle socket);
+
+    // Multicast: TTL, interface de saída (vazio = rota padrão) e loopback local
+    TURBOVISION_API bool setMulticastOptions(SocketHandle socket, int ttl, const std::string& interfaceAddress);
+    TURBOVISION_API bool isMulticastAddress(const std::string& host);
+
+    // Informações de endereço
+    TURBOVISION_API int localPort(SocketHandle socket);
+    TURBOVISION_API std::string addressToString(const sockaddr_in& address);
+    TURBOVISION_API bool parseAddress(const std::string& host, int port, sockaddr_in& address);
+
+    // true se o último erro de socket indica operação que bloquearia
+    TURBOVISION_API bool lastErrorWouldBlock();
+
+} // namespace net
+} // namespace turbovision
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "video_source.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace turbovision {
+
+    // Fonte alimentada pela aplicação: bytes de um transporte próprio (H.264/
+    // H.265 Annex-B, MPEG-TS, ...) entram por push() e chegam ao demuxer por
+    // um AVIOContext próprio, sem FIFO nem arquivo intermediário. Os chunks
+    // passam por uma fila lock-free (um produtor, o demuxer como consumidor)
+    // como AVBufferRef, sem cópia. Depois da fila há dois memcpy: do chunk
+    // para o buffer do AVIOContext (read_packet) e do demuxer montando o
+    // pacote; push(data, size) soma uma cópia na entrada.
+    class TURBOVISION_API BufferSource : public VideoSource {
+    public:
+        struct BufferConfig {
+            std::string format;                    // Demuxer ("h264", "hevc", "mpegts"; "" = detectar)
+            int queueChunks = 1024;                // Chunks na fila (potência de 2)
+            int64_t maxQueuedBytes = 8 * 1024 * 1024;  // Acima disso push() descarta o chunk
+            int probeSize = 32 * 1024;             // Bytes analisados para abrir o stream
+            bool lowLatency = true;                // Sem buffering extra no demuxer/decoder
+
+            BufferConfig() = default;
+        };
+
+        struct Stats {
+            int64_t chunks;
+            int64_t bytes;
+            int64_t dropped;           // Chunks descartados (fila cheia)
+            int64_t queuedBytes;
+            bool streamOpen;           // Demuxer já identificou o stream
+        };
+
+        BufferSource(const VideoConfig& config, const BufferConfig& bufferConfig);
+        ~BufferSource() override;
+
+        // Entrega um chunk ao demuxer. Uma thread produtora por vez; pode ser
+        // chamado antes de start(). Retorna false se a fila estiver cheia.
+        bool push(AVBufferRef* buffer);                 // Assume a referência
+        bool push(std::vector<uint8_t>&& chunk);        // Sem cópia
+        bool push(const uint8_t* data, size_t size);    // Copia para um AVBufferRef
+
+        // Fim do stream: o demuxer lê o que resta e a captura termina
+        void endOfStream();
+
+        Stats getStats() const;
+
+    protected:
+        bool initializeSource() override;
+        void captureLoop() override;
+        void cleanupSource() override;
+
+    private:
+        class ChunkQueue;
+
+        BufferConfig bufferConfig_;
+        std::unique_ptr<ChunkQueue> queue_;
+        AVIOContext* ioContext_;
+
+        // Lado do leitor (thread de captura)
+        AVBufferRef* current_;
+        size_t currentOffset_;
+
+        // Espera do leitor com a fila vazia
+        std::mutex waitMutex_;
+        std::condition_variable dataAvailable_;
+        std::atomic<bool> readerWaiting_;
+        std::atomic<bool> endOfStream_;
+        std::atomic<bool> streamOpen_;
+
+        std::atomic<int64_t> chunks_;
+        std::atomic<int64_t> bytes_;
+        std::atomic<int64_t> dropped_;
+        std::atomic<int64_t> queuedBytes_;
+
+        bool openStream();
+        void closeStream();
+        bool initializeDecoder();
+
+        static int readPacket(void* opaque, uint8_t* buffer, int size);
+        int read(uint8_t* buffer, int size);
+    };
+
+} // namespace turbovision
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "video_source.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace turbovision {
+
+    // Fonte de arquivo de vídeo com índice de pacotes (pts, dts, posição,
+    // keyframe), montado só com demux na primeira abertura e persistido em
+    // um sidecar (<arquivo>.tvidx). O arquivo é lido por um AVIOContext
+    // sobre mmap. O seek vai direto ao keyframe que precede o frame pedido e
+    // decodifica apenas o necessário: frames antes do alvo não são
+    // convertidos, e os não-referência nem são decodificados.
+    //
+    // Com decodeWorkers > 1 (e índice), o arquivo é dividido nos keyframes e
+    // cada GOP é decodificado de forma independente por um pool de workers,
+    // cada um com demuxer e decoder próprios. Os frames saem com
+    // FrameData::sequence(); em ordem (buffer de reordenação) ou na ordem em
+    // que ficam prontos. Pensado para reprocessamento offline: ignora realtime.
+    class TURBOVISION_API FileSource : public VideoSource {
+    public:
+        struct FileConfig {
+            std::string path;
+            bool loop = false;             // Recomeça do início ao chegar no fim
+            bool realtime = true;          // Entrega no ritmo dos timestamps (false = o mais rápido possível)
+            bool useIndex = true;          // Índice de pacotes para seek exato
+            bool persistIndex = true;      // Grava/reusa o sidecar <path>.tvidx
+            bool useMmap = true;           // AVIOContext sobre mmap (senão I/O padrão)
+            int decodeWorkers = 0;         // >1: decodifica GOPs em paralelo (0/1 = sequencial)
+            bool ordered = true;           // Com workers: entrega em ordem de exibição
+            int maxBufferedFrames = 128;   // Com workers: frames prontos aguardando entrega (aprox.)
+
+            FileConfig() = default;
+        };
+
+        struct IndexInfo {
+            int64_t frames;
+            int64_t keyframes;
+            bool fromSidecar;          // Carregado do sidecar (sem varrer o arquivo)
+            double buildTime;          // Segundos para montar ou carregar
+        };
+
+        FileSource(const VideoConfig& config, const FileConfig& fileConfig);
+        ~FileSource() override;
+
+        // Seek exato (µs, mesma unidade de FrameData::timestamp): o próximo
+        // frame entregue é o que está em exibição no instante pedido. Com a
+        // fonte rodando, é executado pela thread de captura.
+        bool seek(int64_t timestamp) override;
+
+        // Acesso aleatório com a fonte parada: decodifica e retorna o frame
+        // em exibição no instante pedido (nullptr em erro ou se rodando)
+        FramePtr frameAt(int64_t timestamp);
+
+        IndexInfo getIndexInfo() const;
+        std::vector<int64_t> getKeyframeTimestamps() const;  // µs
+
+    protected:
+        bool initializeSource() override;
+        void captureLoop() override;
+        void cleanupSource() override;
+
+    private:
+        struct IndexEntry {
+            int64_t pts;
+            int64_t dts;
+            int64_t position;
+            int32_t flags;
+        };
+        struct MappedFile;
+        struct GopWorker;
+        struct ParallelRun;
+
+        FileConfig fileConfig_;
+        std::unique_ptr<MappedFile> mappedFile_;
+        AVIOContext* ioContext_;
+
+        // Índice em ordem de decodificação e pts ordenados (ordem de exibição)
+        std::vector<IndexEntry> index_;
+        std::vector<int64_t> presentation_;
+        std::vector<size_t> keyframes_;    // Índices dos keyframes em ordem de pts (seek)
+        IndexInfo indexInfo_;
+
+        int64_t skipUntil_;            // Frames com pts menor são descartados (pts do stream)
+        int64_t lastPts_;              // Último frame entregue
+        std::atomic<int64_t> pendingSeek_;  // Seek pedido com a fonte rodando (µs)
+        bool endOfFile_;
+
+        bool open();
+        void close();
+        bool initializeDecoder();
+        bool openMappedInput(AVIOContext*& ioContext, std::unique_ptr<MappedFile>& mappedFile) const;
+
+        bool loadIndex();
+        bool buildIndex();
+        void finishIndex();
+        void saveIndex() const;
+        std::string indexPath() const;
+
+        bool seekToPts(int64_t target);
+        int keyframeFor(int64_t pts) const;
+
+        // Próximo frame com pts >= skipUntil_ (retorna AVERROR_EOF no fim)
+        int decodeNext(AVPacket* packet, AVFrame* frame);
+        int64_t framePts(const AVFrame* frame) const;
+        int64_t sequenceFor(int64_t pts) const;
+
+        // Decodificação paralela por GOP (false = sem workers, usa a sequencial)
+        bool parallelCaptureLoop();
+        bool openWorker(GopWorker& worker) const;
+        void workerLoop(GopWorker& worker, ParallelRun& run);
+        void decodeGop(GopWorker& worker, ParallelRun& run, size_t gop);
+    };
+
+} // namespace turbovision
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+#include "turbovision/core/frame_data.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace turbovision {
+
+// Barramento de frames em memória compartilhada (memfd) para entregar frames
+// decodificados a outros processos sem cópia nem serialização. A fonte
+// escreve direto em um ring de slots; os metadados do slot (formato, planos,
+// timestamp, sequência) são publicados sem locks. O fd é passado aos leitores
+// por um socket unix (SCM_RIGHTS); cada leitor mapeia a mesma memória e
+// segura o slot com uma referência até liberar o frame. Slots com
+// referências nunca são sobrescritos: sem slot livre o frame é descartado.
+// Somente Linux.
+class TURBOVISION_API FrameBus {
+public:
+    static const int MAX_SLOTS = 64;
+    static const int MAX_READERS = 16;
+
+    struct Settings {
+        std::string socketPath;                 // Socket unix para passar o fd ("" = só fd())
+        int slots = 8;                          // Frames no ring (máx. MAX_SLOTS)
+        int slotSize = 3840 * 2160 * 3 / 2;     // Bytes por slot (4K NV12/YUV420P)
+
+        Settings() = default;
+    };
+
+    struct Stats {
+        int64_t published;
+        int64_t dropped;         // Todos os slots referenciados por leitores
+        int64_t reclaimed;       // Referências recuperadas de leitores mortos
+        int readers;
+        int slotsInUse;
+    };
+
+    explicit FrameBus(const Settings& settings);
+    ~FrameBus();
+
+    // Previne cópia
+    FrameBus(const FrameBus&) = delete;
+    FrameBus& operator=(const FrameBus&) = delete;
+
+    bool start();
+    void stop();
+
+    // Copia o frame (CPU) para um slot livre e publica; timestamp em µs
+    bool publish(const AVFrame* frame, int64_t timestamp);
+    bool publish(const FrameData& frame);
+
+    // fd da memória (para herdar em fork ou passar por outro canal)
+    int fd() const { return fd_; }
+
+    Stats getStats() const;
+
+private:
+    struct Region;
+
+    Settings settings_;
+    int fd_;
+    std::unique_ptr<Region> region_;
+    uint64_t sequence_;
+    int nextSlot_;
+    mutable std::mutex publishMutex_;     // Um publicador por vez
+
+    int listenSocket_;
+    std::thread acceptThread_;
+    std::atomic<bool> running_;
+
+    std::atomic<int64_t> published_;
+    std::atomic<int64_t> dropped_;
+    std::atomic<int64_t> reclaimed_;
+
+    void acceptLoop();
+    int claimSlot();
+    void reclaimDeadReaders();
+    bool publishSlot(int width, int height, AVPixelFormat format, int64_t timestamp,
+                     const uint8_t* const source[4], const int sourceLinesize[4]);
+};
+
+// Lado do leitor (outro processo). Frames são mapeados da memória do
+// produtor; o slot volta ao produtor quando o último SharedFramePtr sai.
+class TURBOVISION_API FrameBusReader {
+public:
+    struct Frame {
+        int width;
+        int height;
+        AVPixelFormat format;
+        int64_t timestamp;        // µs
+        uint64_t sequence;        // Crescente; lacunas = frames não vistos
+        const uint8_t* data[4];
+        int linesize[4];
+    };
+    using SharedFramePtr = std::shared_ptr<const Frame>;
+
+    FrameBusReader();
+    ~FrameBusReader();
+
+    // Previne cópia
+    FrameBusReader(const FrameBusReader&) = delete;
+    FrameBusReader& operator=(const FrameBusReader&) = delete;
+
+    bool connect(const std::string& socketPath);
+    bool attach(int fd);          // Assume o fd (fechado em disconnect)
+    void disconnect();            // Frames ainda referenciados continuam válidos
+    bool isConnected() const { return mapping_ != nullptr; }
+
+    // Frame mais recente ainda não visto (nullptr se não houver)
+    SharedFramePtr acquireLatest();
+
+    // Espera até timeoutMs por um frame novo
+    SharedFramePtr waitFrame(int timeoutMs);
+
+    // Produtor encerrou o barramento
+    bool isClosed() const;
+
+private:
+    struct Mapping;
+
+    std::shared_ptr<Mapping> mapping_;
+    uint64_t lastSequence_;
+};
+
+} // namespace turbovision
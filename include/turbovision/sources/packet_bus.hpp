@@ -0,0 +1,108 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace turbovision {
+
+// Barramento de pacotes codificados em memória compartilhada (shm nomeado):
+// um escritor, qualquer número de leitores locais. Uma única sessão com a
+// câmera alimenta gravador, relay, upload etc. Os pacotes vão para um ring
+// de bytes; cada leitor guarda o próprio cursor e nunca atrasa o escritor.
+// Um leitor que fica para trás é sobrescrito e retoma no último keyframe.
+// Somente Linux.
+class TURBOVISION_API PacketBus {
+public:
+    struct Settings {
+        std::string name;                       // Nome do stream (leitores usam o mesmo)
+        int capacity = 16 * 1024 * 1024;        // Bytes do ring (~8 s de um stream 16 Mbps)
+
+        Settings() = default;
+    };
+
+    struct Stats {
+        int64_t packets;
+        int64_t bytes;
+        int64_t dropped;          // Pacotes maiores que metade do ring
+        int64_t generation;       // Trocas de stream (setStream)
+    };
+
+    explicit PacketBus(const Settings& settings);
+    ~PacketBus();
+
+    // Previne cópia
+    PacketBus(const PacketBus&) = delete;
+    PacketBus& operator=(const PacketBus&) = delete;
+
+    bool start();
+    void stop();      // Leitores veem isClosed(); o nome é removido
+    bool isRunning() const { return region_ != nullptr; }
+
+    // Parâmetros do stream; pacotes seguintes pertencem à nova geração
+    bool setStream(const AVCodecParameters* parameters, AVRational timeBase);
+
+    bool publish(const AVPacket* packet);
+
+    Stats getStats() const;
+
+private:
+    struct Region;
+
+    Settings settings_;
+    std::string shmName_;
+    std::unique_ptr<Region> region_;
+    mutable std::mutex mutex_;    // Um escritor por vez
+
+    int64_t packets_;
+    int64_t bytes_;
+    int64_t dropped_;
+};
+
+class TURBOVISION_API PacketBusReader {
+public:
+    enum class Result {
+        PACKET,
+        NONE,              // Sem pacote novo (timeout)
+        OVERRUN,           // Leitor foi sobrescrito; o cursor pulou para o último keyframe
+        STREAM_CHANGED,    // Nova geração: chamar getStream() antes de continuar
+        CLOSED             // Escritor encerrou (ou morreu)
+    };
+
+    PacketBusReader();
+    ~PacketBusReader();
+
+    // Previne cópia
+    PacketBusReader(const PacketBusReader&) = delete;
+    PacketBusReader& operator=(const PacketBusReader&) = delete;
+
+    // Conecta ao stream pelo nome; a leitura começa no último keyframe
+    bool attach(const std::string& name);
+    void detach();
+    bool isAttached() const { return mapping_ != nullptr; }
+
+    // Parâmetros da geração atual (parameters deve vir de avcodec_parameters_alloc)
+    bool getStream(AVCodecParameters* parameters, AVRational* timeBase);
+
+    // Próximo pacote do cursor deste leitor; espera até timeoutMs
+    Result read(AVPacket* packet, int timeoutMs);
+
+    int64_t overruns() const { return overruns_; }
+
+private:
+    struct Mapping;
+
+    std::unique_ptr<Mapping> mapping_;
+    uint64_t cursor_;
+    uint32_t generation_;
+    int64_t overruns_;
+
+    Result readOne(AVPacket* packet);
+    void resync();
+    bool writerAlive() const;
+};
+
+} // namespace turbovision
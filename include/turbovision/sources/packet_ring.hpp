@@ -0,0 +1,101 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace turbovision {
+
+// Ring de pacotes codificados para gravação pré-evento. Mantém os últimos
+// N segundos do stream (limitados também em bytes), sempre começando em um
+// keyframe, sem decodificar nada. Um trigger grava o ring (pré-roll) e os
+// pacotes seguintes em MP4 ou MP4 fragmentado por remux, sem recodificar,
+// até o pós-roll expirar; novos triggers durante a gravação a estendem.
+// Toda a escrita em disco roda numa thread própria: push() só enfileira.
+class TURBOVISION_API PacketRing {
+public:
+    enum class Format {
+        MP4,
+        FRAGMENTED_MP4       // Legível durante a gravação e sem perda em queda
+    };
+
+    struct Settings {
+        int duration = 30;                     // Pré-roll mínimo em segundos
+        int64_t maxBytes = 64 * 1024 * 1024;   // Memória máxima do ring
+
+        Settings() = default;
+    };
+
+    struct Stats {
+        int64_t packets;
+        int64_t bytes;
+        double duration;         // Segundos cobertos pelo ring
+        bool recording;
+        int64_t recordedPackets; // Pacotes gravados na gravação atual (ou última)
+    };
+
+    explicit PacketRing(const Settings& settings);
+    ~PacketRing();
+
+    // Previne cópia
+    PacketRing(const PacketRing&) = delete;
+    PacketRing& operator=(const PacketRing&) = delete;
+
+    // Parâmetros do stream de vídeo; esvazia o ring e encerra a gravação
+    void setStream(const AVCodecParameters* parameters, AVRational timeBase);
+
+    // Pacote do stream de vídeo (referenciado, não copiado); nunca espera o disco
+    void push(const AVPacket* packet);
+
+    // Grava pré-roll + pacotes ao vivo em path até postRoll segundos após o
+    // último trigger. Com uma gravação ativa só estende o prazo.
+    bool trigger(const std::string& path, Format format = Format::MP4, int postRoll = 10);
+
+    // Encerra a gravação; o que já foi enfileirado ainda é gravado e o
+    // arquivo é fechado pela thread de escrita
+    void stopRecording();
+    bool isRecording() const;
+
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        AVPacket* packet;
+        std::chrono::steady_clock::time_point arrival;
+    };
+    struct Recording;
+
+    Settings settings_;
+
+    // Ring e estado das gravações (mutex_, nunca segurado durante I/O)
+    mutable std::mutex mutex_;
+    std::deque<Entry> entries_;
+    int64_t bytes_;
+    AVCodecParameters* parameters_;
+    AVRational timeBase_;
+    uint64_t generation_;        // Incrementada por setStream
+
+    std::unique_ptr<Recording> recording_;          // Recebe os pacotes ao vivo
+    std::deque<std::unique_ptr<Recording>> closing_; // Encerradas, ainda esvaziando a fila
+    bool starting_;              // trigger() abrindo o arquivo
+    std::chrono::steady_clock::time_point deadline_;
+    int64_t recordedPackets_;
+
+    // Thread de escrita: grava as filas, encerra no prazo e fecha os arquivos
+    std::thread writer_;
+    std::condition_variable wake_;
+    bool stopping_;
+
+    void evict();
+    void clear();
+    void closeRecording();
+    void writeRecordings();
+};
+
+} // namespace turbovision
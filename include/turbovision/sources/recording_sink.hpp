@@ -0,0 +1,162 @@
+#pragma once
+
+#include "turbovision/core/common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace turbovision {
+
+// Sink de gravação para muitas fontes. Os pacotes de todas as fontes são
+// agregados em buffers grandes e alinhados, escritos em sequência em
+// arquivos de segmento pré-alocados (fallocate) via io_uring, com O_DIRECT
+// opcional; sem io_uring (ou fora do Linux) uma thread faz pwrite. Troca
+// milhares de escritas pequenas e aleatórias por poucas escritas grandes.
+//
+// Segmento (.tvr): registros de 32 bytes de cabeçalho + payload, alinhados
+// a 8 bytes. Cada segmento começa com os registros de stream de todas as
+// fontes; o fim de um buffer é preenchido com zeros até 4 KiB.
+class TURBOVISION_API RecordingSink {
+public:
+    struct Settings {
+        std::string directory = ".";
+        std::string prefix = "recording";
+        int bufferSize = 4 * 1024 * 1024;           // Tamanho de cada escrita
+        int buffers = 16;                           // Buffers (escritas em voo + preenchimento)
+        bool directIO = false;                      // O_DIRECT (sem page cache)
+        bool useIoUring = true;                     // false: pwrite em thread
+        int64_t segmentBytes = 1024LL * 1024 * 1024; // Rotação por tamanho (pré-alocado)
+        int segmentDuration = 300;                  // Rotação por tempo em s (0 = só tamanho)
+        int flushInterval = 500;                    // Buffer parcial vai ao disco após N ms
+
+        Settings() = default;
+    };
+
+    struct Stats {
+        int64_t packets;
+        int64_t bytes;            // Payload recebido
+        int64_t droppedPackets;   // Sem buffer livre (disco não acompanha)
+        int64_t writes;
+        int64_t bytesWritten;     // Inclui cabeçalhos e alinhamento
+        int64_t segments;
+        double throughput;        // MB/s escritos desde start()
+        double writeLatency;      // Média em µs (submissão até conclusão)
+        double maxWriteLatency;   // µs
+        bool ioUring;             // io_uring em uso
+    };
+
+    // Registro lido de um segmento (readSegment)
+    struct Record {
+        int source;
+        bool stream;              // Registro de stream (codecId, width, height, timeBase, name)
+        int flags;                // AV_PKT_FLAG_*
+        int64_t pts;
+        int64_t dts;
+        const uint8_t* data;      // Pacote ou extradata do stream
+        int size;
+        AVCodecID codecId;
+        int width;
+        int height;
+        AVRational timeBase;
+        std::string name;
+    };
+    using RecordCallback = std::function<void(const Record&)>;
+
+    explicit RecordingSink(const Settings& settings);
+    ~RecordingSink();
+
+    // Previne cópia
+    RecordingSink(const RecordingSink&) = delete;
+    RecordingSink& operator=(const RecordingSink&) = delete;
+
+    bool start();
+    void stop();   // Grava o que estiver em buffer e fecha o segmento
+
+    // Registra uma fonte; retorna o id usado em write() (-1 em erro)
+    int addSource(const std::string& name, const AVCodecParameters* parameters, AVRational timeBase);
+
+    // Copia o pacote para o buffer atual; nunca espera pelo disco
+    bool write(int source, const AVPacket* packet);
+    bool write(int source, const uint8_t* data, int size, int64_t pts, int64_t dts, int flags);
+
+    Stats getStats() const;
+
+    // Percorre os registros de um segmento
+    static bool readSegment(const std::string& path, const RecordCallback& callback);
+
+private:
+    struct Buffer {
+        uint8_t* data;
+        int capacity;
+        int used;
+        int length;               // used alinhado a 4 KiB
+        int64_t offset;           // Posição no segmento
+        bool pooled;              // Volta para free_ ao concluir (senão é liberado)
+        std::chrono::steady_clock::time_point submitted;
+    };
+    struct SourceInfo {
+        std::string name;
+        AVCodecID codecId;
+        int width;
+        int height;
+        AVRational timeBase;
+        std::vector<uint8_t> extradata;
+    };
+    class IoRing;
+
+    Settings settings_;
+
+    // Preenchimento (produtores)
+    mutable std::mutex mutex_;
+    std::condition_variable readyCondition_;
+    Buffer* current_;
+    std::chrono::steady_clock::time_point currentSince_;
+    std::vector<Buffer*> free_;
+    std::deque<Buffer*> ready_;
+    std::vector<SourceInfo> sources_;
+
+    // Escrita (thread do sink)
+    std::thread writerThread_;
+    std::atomic<bool> running_;
+    std::unique_ptr<IoRing> ioRing_;
+    std::atomic<bool> ioUring_;           // Exposto em getStats()
+    int fd_;
+    int64_t offset_;
+    int64_t segmentIndex_;
+    std::chrono::steady_clock::time_point segmentStart_;
+    int inflight_;
+    std::vector<Buffer*> allBuffers_;
+
+    // Estatísticas
+    std::atomic<int64_t> packets_;
+    std::atomic<int64_t> bytes_;
+    std::atomic<int64_t> dropped_;
+    std::atomic<int64_t> writes_;
+    std::atomic<int64_t> bytesWritten_;
+    std::atomic<int64_t> segments_;
+    std::atomic<int64_t> latencySum_;
+    std::atomic<int64_t> latencyMax_;
+    std::chrono::steady_clock::time_point startTime_;
+
+    void writerLoop();
+    bool openSegment();
+    void closeSegment();
+    bool submit(Buffer* buffer);
+    void reap(bool wait);
+    void completed(Buffer* buffer, int result);
+    bool appendRecord(int type, int source, int flags, int64_t pts, int64_t dts,
+                      const std::vector<uint8_t>& prefix, const uint8_t* data, int size);
+    Buffer* takeBuffer(int size);
+    void recycle(Buffer* buffer);
+    Buffer* streamRecords();
+};
+
+} // namespace turbovision
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "video_source.hpp"
+#include "packet_ring.hpp"
+#include "packet_bus.hpp"
+#include "turbovision/core/seqlock.hpp"
+#include <atomic>
+#include <cstdarg>
+#include <memory>
 #include <string>
 
 namespace turbovision {
@@ -13,6 +19,11 @@ namespace turbovision {
             int timeout = 5000000;        // Timeout em microsegundos (5 segundos)
             bool reconnectOnError = true;  // Tentar reconectar em caso de erro
             int maxReconnectAttempts = 5;  // Número máximo de tentativas de reconexão
+            int preEventDuration = 0;      // Segundos de pacotes mantidos para gravação pré-evento (0 = desligado)
+            int64_t preEventMaxBytes = 64 * 1024 * 1024; // Memória máxima do ring pré-evento
+            bool decodeFrames = true;      // false: só alimenta o ring, sem decodificar (sem FrameCallback)
+            std::string packetBusName;     // Publica os pacotes no PacketBus com este nome ("" = desligado)
+            int packetBusSize = 16 * 1024 * 1024; // Bytes do ring compartilhado
 
             struct Advanced {
                 int bufferSize = 1024*1024;  // Buffer de rede (1MB)
@@ -29,18 +40,73 @@ namespace turbovision {
         RTSPSource(const VideoConfig& config, const RTSPConfig& rtspConfig);
         ~RTSPSource() override;
 
+        // Saúde da rede e do decoder desde a criação da fonte. Os contadores
+        // são atualizados pela thread de captura e publicados juntos a cada
+        // pacote (SeqLock): a leitura não bloqueia a captura e nunca mistura
+        // duas publicações. Perdas e atrasos RTP vêm dos avisos do demuxer
+        // do FFmpeg e exigem o callback de log instalado por initialize(); o
+        // rtpdec só os emite na fila de reordenação UDP, então sobre TCP
+        // (interleaved) ficam indisponíveis e zerados.
+        struct NetworkStats {
+            bool connected;
+            int reconnectAttempts;         // Tentativas desde a última leitura com sucesso
+            int64_t reconnects;            // Reconexões bem-sucedidas
+            int64_t packetsReceived;       // Pacotes de vídeo do demuxer (um por frame codificado)
+            int64_t bytesReceived;
+            bool rtpStatsAvailable;        // rtpLost/rtpLate medidos (só com useTCP = false)
+            int64_t rtpLost;               // Lacunas no número de sequência RTP (só UDP)
+            int64_t rtpLate;               // Chegaram após a janela de reordenação e foram descartados (só UDP)
+            int64_t reordered;             // Timestamp menor que o anterior em stream sem B-frames
+            int64_t corruptPackets;        // Marcados como corrompidos pelo demuxer
+            double frameIntervalJitter;    // Variação do intervalo entre frames lidos vs. timestamps RTP
+                                           // (filtro do RFC 3550), em ms; inclui a decodificação do loop
+            double maxFrameIntervalJitter; // Maior valor observado, em ms
+            int64_t framesDecoded;
+            int64_t corruptFrames;         // Decodificados com erro (entregues assim mesmo)
+
+            // Frames perdidos entre o demuxer e o callback, por motivo
+            struct Dropped {
+                int64_t decodeError;       // Pacote rejeitado ou erro ao receber frame
+                int64_t gpuTransfer;       // Falha na cópia GPU -> CPU
+                int64_t processing;        // Falha ao montar/entregar o FrameData
+            } dropped;
+
+            int64_t updated;               // Última publicação, em µs do steady_clock
+        };
+
+        NetworkStats getNetworkStats() const;
+
         // Status do RTSP
         struct RTSPStatus {
             bool connected;
             int reconnectAttempts;
-            float averageLatency;
-            float packetLoss;
+            float averageLatency;          // Média de decode + cópia + callback, em ms
+            float packetLoss;              // (Frames com erro ou descartados + RTP perdidos) / (pacotes recebidos + RTP perdidos)
             int64_t bytesReceived;
             int64_t framesReceived;
+            StageLatency latency;          // Percentis por estágio (ver getStageLatency)
+            NetworkStats network;
         };
 
         RTSPStatus getStatus() const;
 
+        // Chamado pelo callback de log do FFmpeg (initialize()): conta os
+        // avisos de perda/atraso RTP do demuxer de cada fonte
+        static void handleDemuxerLog(void* context, int level, const char* fmt, va_list args);
+
+        // Gravação pré-evento (RTSPConfig::preEventDuration): grava o ring
+        // e os pacotes seguintes por remux, até postRoll segundos após o
+        // último trigger
+        bool triggerRecording(const std::string& path,
+                              PacketRing::Format format = PacketRing::Format::MP4,
+                              int postRoll = 10);
+        void stopRecording();
+        bool isRecording() const;
+        PacketRing::Stats getPreEventStats() const;
+
+        // Barramento de pacotes para consumidores locais (RTSPConfig::packetBusName)
+        PacketBus::Stats getPacketBusStats() const;
+
     protected:
         bool initializeSource() override;
         void captureLoop() override;
@@ -48,14 +114,29 @@ namespace turbovision {
 
     private:
         RTSPConfig rtspConfig_;
-        RTSPStatus status_;
         int reconnectAttempts_;
 
+        // Estado das estatísticas: stats_ e os marcos de jitter só são
+        // tocados pela thread de captura (ou por start/stop, fora dela); os
+        // avisos do demuxer chegam pelo callback de log, por isso atômicos
+        NetworkStats stats_;
+        SeqLock<NetworkStats> publishedStats_;
+        std::atomic<int64_t> rtpLost_;
+        std::atomic<int64_t> rtpLate_;
+        double lastArrival_;               // s; < 0 = sem pacote anterior
+        double lastRtpTime_;               // s
+        int64_t lastPts_;
+        std::unique_ptr<PacketRing> packetRing_;
+        std::unique_ptr<PacketBus> packetBus_;
+
         bool initializeDecoder();
         bool connect();
         void disconnect();
         bool reconnect();
         bool setupNetworking();
+        void registerDemuxer();
+        void unregisterDemuxer();
+        void trackPacket(const AVPacket* packet);
         void updateStatus();
 
         // Configurações de rede
@@ -3,6 +3,9 @@
 #include "video_source.hpp"
 #include "camera_source.hpp"
 #include "rtsp_source.hpp"
+#include "file_source.hpp"
+#include "buffer_source.hpp"
+#include "synthetic_source.hpp"
 #include <memory>
 
 namespace turbovision {
@@ -24,12 +27,25 @@ namespace turbovision {
             const VideoConfig& config,
             const RTSPSource::RTSPConfig& rtspConfig);
 
+        static std::shared_ptr<FileSource> createFileSource(
+            const VideoConfig& config,
+            const FileSource::FileConfig& fileConfig);
+
+        static std::shared_ptr<BufferSource> createBufferSource(
+            const VideoConfig& config,
+            const BufferSource::BufferConfig& bufferConfig);
+
+        static std::shared_ptr<SyntheticSource> createSyntheticSource(
+            const VideoConfig& config,
+            const SyntheticSource::SyntheticConfig& syntheticConfig);
+
         // Métodos de descoberta de dispositivos
         static std::vector<CameraSource::CameraInfo> listAvailableCameras();
 
         // Métodos utilitários
         static bool isCameraPath(const std::string& path);
         static bool isRTSPUrl(const std::string& path);
+        static bool isSyntheticPath(const std::string& path);   // "synthetic" ou "synthetic:<padrão>"
 
     private:
         // Previne instanciação
@@ -39,6 +55,9 @@ namespace turbovision {
         // Helpers internos
         static CameraSource::CameraConfig createDefaultCameraConfig(const std::string& path);
         static RTSPSource::RTSPConfig createDefaultRTSPConfig(const std::string& url);
+        static FileSource::FileConfig createDefaultFileConfig(const std::string& path);
+        static BufferSource::BufferConfig createDefaultBufferConfig(const std::string& format);
+        static SyntheticSource::SyntheticConfig createDefaultSyntheticConfig(const std::string& path);
     };
 
 } // namespace turbovision
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "video_source.hpp"
+#include <atomic>
+#include <string>
+
+namespace turbovision {
+
+    // Fonte sintética para benchmarks e testes sem câmera nem rede. Gera
+    // frames na resolução do VideoConfig com um padrão determinístico (o
+    // conteúdo depende só do índice do frame e da semente), no fps pedido ou
+    // o mais rápido possível. Com encode, cada frame passa por um encoder
+    // (CodecBackend) e volta pelo decoder da fonte, exercitando o mesmo
+    // caminho de decodificação das fontes reais.
+    class TURBOVISION_API SyntheticSource : public VideoSource {
+    public:
+        enum class Pattern {
+            SOLID,
+            COLOR_BARS,
+            GRADIENT,        // Rampa horizontal que desliza a cada frame
+            MOVING_BOX,      // Quadrado em movimento sobre fundo fixo
+            NOISE            // Ruído pseudoaleatório (pior caso para o encoder)
+        };
+
+        struct SyntheticConfig {
+            Pattern pattern = Pattern::MOVING_BOX;
+            AVPixelFormat format = AV_PIX_FMT_YUV420P;  // Nativos: YUV420P, NV12, GRAY8; outros via swscale
+            int fps = -1;                  // -1 = VideoConfig::fps; 0 = o mais rápido possível
+            int64_t frameCount = 0;        // Para após N frames (0 = sem fim)
+            uint32_t seed = 1;             // Semente do NOISE
+            bool encode = false;           // Codifica e decodifica cada frame
+            std::string encoder = "libx264";  // Com encode (VideoConfig::bitrate; 0 = qualidade constante)
+            int gopSize = 30;              // Com encode
+
+            SyntheticConfig() = default;
+        };
+
+        struct Stats {
+            int64_t frames;            // Frames gerados
+            int64_t packets;           // Com encode
+            int64_t bytes;             // Com encode
+            int64_t late;              // Frames gerados depois do horário (fps fixo)
+        };
+
+        SyntheticSource(const VideoConfig& config, const SyntheticConfig& syntheticConfig);
+        ~SyntheticSource() override;
+
+        Stats getStats() const;
+
+        // Padrão pelo nome ("solid", "bars", "gradient", "box", "noise")
+        static bool parsePattern(const std::string& name, Pattern& pattern);
+
+    protected:
+        bool initializeSource() override;
+        void captureLoop() override;
+        void cleanupSource() override;
+
+    private:
+        SyntheticConfig syntheticConfig_;
+        AVFrame* canvas_;              // Frame gerado no formato nativo
+        AVFrame* converted_;           // No formato pedido, quando não é nativo
+        SwsContext* scaler_;
+        AVCodecContext* encoderContext_;
+        bool staticPattern_;           // Gerado uma vez só (SOLID, COLOR_BARS)
+
+        std::atomic<int64_t> frames_;
+        std::atomic<int64_t> packets_;
+        std::atomic<int64_t> bytes_;
+        std::atomic<int64_t> late_;
+
+        bool initializeCodecs();
+        void render(int64_t index);
+        AVFrame* nextFrame(int64_t index);
+        bool encodeFrame(AVFrame* frame, AVPacket* packet);
+    };
+
+} // namespace turbovision
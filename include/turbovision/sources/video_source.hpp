@@ -4,10 +4,14 @@
 #include "turbovision/core/video_config.hpp"
 #include "turbovision/core/frame_data.hpp"
 #include "turbovision/core/hardware_manager.hpp"
+#include "turbovision/core/latency_histogram.hpp"
+#include "turbovision/sources/frame_bus.hpp"
 
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <deque>
 #include <functional>
 
 namespace turbovision {
@@ -31,6 +35,33 @@ public:
     virtual bool seek(int64_t timestamp);
     void setFrameCallback(FrameCallback callback);
 
+    // Frames decodificados também são publicados no barramento (nullptr remove)
+    void setFrameBus(std::shared_ptr<FrameBus> frameBus);
+
+    // Marcos de tempo de um frame na fonte, em µs do steady_clock
+    struct FrameTrace {
+        int64_t received;          // Pacote entregue ao decoder (0 = fonte sem pacotes)
+        int64_t decoded;           // Frame saiu do decoder
+        int64_t delivered;         // Planos copiados, antes do callback de frame
+    };
+
+    // Chamado antes do callback de frame, na thread de captura, com o mesmo
+    // FramePtr. Sem callback nada é medido; nullptr desativa.
+    using FrameTraceCallback = std::function<void(const FramePtr& frame, const FrameTrace& trace)>;
+    void setFrameTraceCallback(FrameTraceCallback callback);
+
+    // Latência por estágio (percentis em µs) desde o último reset
+    struct StageLatency {
+        LatencyHistogram::Summary packetRead;    // Leitura do demuxer (inclui a espera por dados)
+        LatencyHistogram::Summary decode;        // Pacote no decoder -> frame decodificado
+        LatencyHistogram::Summary gpuTransfer;   // Frame de hardware -> memória da CPU
+        LatencyHistogram::Summary planeCopy;     // Cópia dos planos para o FrameData
+        LatencyHistogram::Summary callback;      // Callback de frame da aplicação
+    };
+
+    // reset: zera os histogramas na mesma leitura (estatística por intervalo)
+    StageLatency getStageLatency(bool reset = false) const;
+
     // Status
     bool isRunning() const { return isRunning_; }
     bool isPaused() const { return isPaused_; }
@@ -48,6 +79,10 @@ public:
 
     virtual StreamInfo getStreamInfo() const;
 
+    // Cópia dos planos de um frame em CPU para um FrameData (caminho de
+    // processFrame); estático para ser medido isoladamente
+    static FramePtr createFrameData(const AVFrame* frame, int64_t timestamp);
+
 protected:
     // Métodos que devem ser implementados pelas classes derivadas
     virtual bool initializeSource() = 0;
@@ -68,6 +103,29 @@ protected:
     std::mutex frameMutex_;
     std::queue<FramePtr> frameQueue_;
     FrameCallback frameCallback_;
+    std::shared_ptr<FrameBus> frameBus_;
+
+    // Histogramas por estágio (ns); a leitura de pacotes é medida pelas
+    // derivadas em volta de av_read_frame
+    struct StageHistograms {
+        LatencyHistogram packetRead;
+        LatencyHistogram decode;
+        LatencyHistogram gpuTransfer;
+        LatencyHistogram planeCopy;
+        LatencyHistogram callback;
+    };
+    std::unique_ptr<StageHistograms> stageHistograms_;
+
+    // Desfecho de cada pacote/frame no decoder (thread de captura); as
+    // derivadas publicam nas próprias estatísticas
+    struct DecodeCounters {
+        std::atomic<int64_t> decoded{0};
+        std::atomic<int64_t> decodeErrors{0};    // Pacote rejeitado ou erro ao receber frame
+        std::atomic<int64_t> corrupt{0};         // Decodificados com erro (entregues assim mesmo)
+        std::atomic<int64_t> transferErrors{0};  // Falha na cópia GPU -> CPU (frame descartado)
+        std::atomic<int64_t> frameErrors{0};     // Falha ao montar/entregar o FrameData
+    };
+    DecodeCounters decodeCounters_;
 
     // Métodos utilitários protegidos
     bool processPacket(AVPacket* packet);
@@ -76,6 +134,13 @@ protected:
 
     // Helper para lidar com frames de hardware
     bool transferFrameFromGPU(AVFrame* hwFrame, AVFrame* swFrame);
+
+private:
+    // Trace por frame (acessado pela thread de captura, exceto o callback)
+    FrameTraceCallback traceCallback_;     // Protegido por frameMutex_
+    std::atomic<bool> tracing_;
+    std::deque<std::pair<int64_t, int64_t>> packetTimes_;  // pts do pacote -> chegada
+    int64_t decodedAt_;                    // 0 = frame não veio de processPacket
 };
 
 } // namespace turbovision
\ No newline at end of file
@@ -6,16 +6,27 @@
 #include "core/hardware_manager.hpp"
 #include "core/video_config.hpp"
 #include "core/utils.hpp"
+#include "core/worker_pool.hpp"
+#include "core/latency_histogram.hpp"
+#include "core/seqlock.hpp"
 
 // Sources
 #include "sources/video_source.hpp"
 #include "sources/camera_source.hpp"
 #include "sources/rtsp_source.hpp"
+#include "sources/file_source.hpp"
+#include "sources/buffer_source.hpp"
+#include "sources/synthetic_source.hpp"
+#include "sources/packet_ring.hpp"
+#include "sources/recording_sink.hpp"
+#include "sources/frame_bus.hpp"
+#include "sources/packet_bus.hpp"
 #include "sources/source_factory.hpp"
 
 // Server
 #include "server/server_config.hpp"
 #include "server/rtsp_server.hpp"
+#include "server/codec_backend.hpp"
 
 namespace turbovision {
 
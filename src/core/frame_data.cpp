@@ -6,7 +6,8 @@ namespace turbovision {
         : width_(width)
           , height_(height)
           , format_(format)
-          , timestamp_(0) {
+          , timestamp_(0)
+          , sequence_(-1) {
         // Calcular o tamanho necessário do buffer baseado no formato
         dataSize_ = av_image_get_buffer_size(format, width, height, 1);
         data_ = new uint8_t[dataSize_];
@@ -23,6 +24,7 @@ namespace turbovision {
           , height_(other.height_)
           , format_(other.format_)
           , timestamp_(other.timestamp_)
+          , sequence_(other.sequence_)
           , dataSize_(other.dataSize_) {
         other.data_ = nullptr;
         other.dataSize_ = 0;
@@ -37,6 +39,7 @@ namespace turbovision {
             height_ = other.height_;
             format_ = other.format_;
             timestamp_ = other.timestamp_;
+            sequence_ = other.sequence_;
             dataSize_ = other.dataSize_;
 
             other.data_ = nullptr;
@@ -0,0 +1,102 @@
+#include "turbovision/core/latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace turbovision {
+    LatencyHistogram::Snapshot::Snapshot()
+        : counts_(BUCKETS, 0)
+          , count_(0)
+          , sum_(0)
+          , max_(0) {
+    }
+
+    void LatencyHistogram::Snapshot::merge(const Snapshot &other) {
+        for (int i = 0; i < BUCKETS; i++) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    double LatencyHistogram::Snapshot::percentile(double quantile) const {
+        if (count_ == 0) {
+            return 0.0;
+        }
+
+        // Posição da amostra (1..count) que responde pelo quantil
+        const int64_t target = std::max<int64_t>(
+            1, static_cast<int64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * count_)));
+        int64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts_[i];
+            if (seen >= target) {
+                return std::min(bucketValue(i), static_cast<double>(max_)) / 1000.0;
+            }
+        }
+        return max_ / 1000.0;
+    }
+
+    LatencyHistogram::Summary LatencyHistogram::Snapshot::summary() const {
+        Summary summary;
+        summary.count = count_;
+        if (count_ == 0) {
+            return summary;
+        }
+        summary.mean = static_cast<double>(sum_) / count_ / 1000.0;
+        summary.p50 = percentile(0.5);
+        summary.p90 = percentile(0.9);
+        summary.p99 = percentile(0.99);
+        summary.p999 = percentile(0.999);
+        summary.max = max_ / 1000.0;
+        return summary;
+    }
+
+    LatencyHistogram::LatencyHistogram()
+        : sum_(0)
+          , max_(0) {
+        for (auto &count: counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void LatencyHistogram::collect(Snapshot &snapshot, bool reset) {
+        // Contagem total a partir dos buckets: soma e máximo podem divergir
+        // por amostras em voo, nunca a distribuição
+        for (int i = 0; i < BUCKETS; i++) {
+            const uint64_t count = reset
+                                       ? counts_[i].exchange(0, std::memory_order_relaxed)
+                                       : counts_[i].load(std::memory_order_relaxed);
+            snapshot.counts_[i] += static_cast<int64_t>(count);
+            snapshot.count_ += static_cast<int64_t>(count);
+        }
+        snapshot.sum_ += reset ? sum_.exchange(0, std::memory_order_relaxed) : sum_.load(std::memory_order_relaxed);
+        snapshot.max_ = std::max(snapshot.max_, reset
+                                                    ? max_.exchange(0, std::memory_order_relaxed)
+                                                    : max_.load(std::memory_order_relaxed));
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::snapshot(bool reset) {
+        Snapshot snapshot;
+        collect(snapshot, reset);
+        return snapshot;
+    }
+
+    void LatencyHistogram::reset() {
+        for (auto &count: counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::bucketValue(int index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const int shift = index / SUB_BUCKETS - 1;
+        const double lower = static_cast<double>(static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << shift);
+        return lower + static_cast<double>(uint64_t(1) << shift) / 2.0;
+    }
+} // namespace turbovision
@@ -0,0 +1,74 @@
+#include "turbovision/core/worker_pool.hpp"
+
+#include <algorithm>
+
+namespace turbovision {
+    WorkerPool::WorkerPool(size_t threadCount)
+        : stopping_(false) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        workers_.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++) {
+            workers_.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        shutdown();
+    }
+
+    bool WorkerPool::post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return false;
+            }
+            tasks_.push(std::move(task));
+        }
+        condition_.notify_one();
+        return true;
+    }
+
+    void WorkerPool::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            stopping_ = true;
+        }
+        condition_.notify_all();
+
+        for (auto &worker: workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    size_t WorkerPool::pendingTasks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_.size();
+    }
+
+    void WorkerPool::workerLoop() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+
+                if (tasks_.empty()) {
+                    return; // stopping_ e nada mais a executar
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+
+            task();
+        }
+    }
+} // namespace turbovision
@@ -0,0 +1,98 @@
+#include "turbovision/server/change_detector.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace turbovision {
+    namespace {
+        const int BLOCK_SIZE = 16;
+        const int ROW_STEP = 4;                          // Subamostragem vertical
+        const int ROWS_PER_BLOCK = BLOCK_SIZE / ROW_STEP;
+        const int SAMPLES_PER_BLOCK = BLOCK_SIZE * ROWS_PER_BLOCK;
+
+        // Soma das diferenças absolutas de 16 bytes
+        inline uint32_t sad16(const uint8_t *a, const uint8_t *b) {
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128i sad = _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(b)));
+            return static_cast<uint32_t>(_mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4));
+#elif defined(__aarch64__)
+            return vaddlvq_u8(vabdq_u8(vld1q_u8(a), vld1q_u8(b)));
+#else
+            uint32_t sum = 0;
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                sum += static_cast<uint32_t>(a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]);
+            }
+            return sum;
+#endif
+        }
+    }
+
+    ChangeDetector::ChangeDetector(int threshold)
+        : threshold_(threshold)
+          , width_(0)
+          , height_(0) {
+    }
+
+    bool ChangeDetector::hasChanged(const AVFrame *frame) const {
+        if (reference_.empty() || frame->width != width_ || frame->height != height_) {
+            return true;
+        }
+
+        // Colunas e linhas que não completam um bloco ficam de fora
+        const int blockColumns = width_ / BLOCK_SIZE;
+        const int blockRows = height_ / BLOCK_SIZE;
+        const size_t rowBytes = static_cast<size_t>(blockColumns) * BLOCK_SIZE;
+        const uint32_t limit = static_cast<uint32_t>(threshold_ * SAMPLES_PER_BLOCK);
+
+        std::vector<uint32_t> blockSad(static_cast<size_t>(blockColumns));
+        const uint8_t *reference = reference_.data();
+
+        for (int blockRow = 0; blockRow < blockRows; blockRow++) {
+            std::fill(blockSad.begin(), blockSad.end(), 0);
+            for (int row = 0; row < ROWS_PER_BLOCK; row++) {
+                const uint8_t *luma = frame->data[0] +
+                                      static_cast<size_t>(blockRow * BLOCK_SIZE + row * ROW_STEP) * frame->linesize[0];
+                for (int column = 0; column < blockColumns; column++) {
+                    blockSad[column] += sad16(luma + column * BLOCK_SIZE, reference + column * BLOCK_SIZE);
+                }
+                reference += rowBytes;
+            }
+
+            for (uint32_t sad: blockSad) {
+                if (sad > limit) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void ChangeDetector::setReference(const AVFrame *frame) {
+        width_ = frame->width;
+        height_ = frame->height;
+
+        const int blockRows = height_ / BLOCK_SIZE;
+        const size_t rowBytes = static_cast<size_t>(width_ / BLOCK_SIZE) * BLOCK_SIZE;
+        reference_.resize(rowBytes * blockRows * ROWS_PER_BLOCK);
+
+        uint8_t *reference = reference_.data();
+        for (int row = 0; row < blockRows * BLOCK_SIZE; row += ROW_STEP) {
+            std::memcpy(reference, frame->data[0] + static_cast<size_t>(row) * frame->linesize[0], rowBytes);
+            reference += rowBytes;
+        }
+    }
+
+    void ChangeDetector::reset() {
+        reference_.clear();
+        width_ = 0;
+        height_ = 0;
+    }
+
+} // namespace turbovision
@@ -0,0 +1,321 @@
+#include "turbovision/server/codec_backend.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace turbovision {
+    namespace {
+        // Linhas de pixels por slice em encoders sem limite de tamanho de slice
+        const int SLICE_HEIGHT = 64;
+
+        // Faixa de qp do H.264/HEVC, usada por advanced.qp
+        const int MAX_QP = 51;
+
+        const std::vector<std::string> X264_PRESETS = {
+            "ultrafast", "superfast", "veryfast", "faster", "fast", "medium", "slow", "slower", "veryslow"
+        };
+        const std::vector<std::string> NVENC_PRESETS = {"p1", "p2", "p3", "p4", "p5", "p6", "p7"};
+
+        // SVT-AV1: presets numéricos, maiores são mais rápidos (tempo real a partir de 10)
+        const std::vector<std::string> SVT_AV1_PRESETS = {
+            "13", "12", "11", "10", "9", "8", "7", "6", "5", "4", "3", "2", "1", "0"
+        };
+
+        const std::vector<std::string> KNOWN_ENCODERS = {
+            "libx264", "libx265", "libsvtav1", "h264_nvenc", "hevc_nvenc", "av1_nvenc"
+        };
+
+        // O empacotador RTP de AV1 entrou no libavformat 61.7 (FFmpeg 7.1);
+        // antes disso avformat_write_header falha ao abrir o stream
+        bool rtpSupports(AVCodecID codecId) {
+#if LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(61, 7, 100)
+            return codecId != AV_CODEC_ID_AV1;
+#else
+            (void) codecId;
+            return true;
+#endif
+        }
+
+        bool contains(const std::vector<std::string> &values, const std::string &value) {
+            return std::find(values.begin(), values.end(), value) != values.end();
+        }
+
+        // qp de 0-51 na escala do encoder
+        int scaledQp(int qp, int maxQp) {
+            return std::clamp(qp, 0, MAX_QP) * maxQp / MAX_QP;
+        }
+
+        // Lista "chave=valor" das opções *-params do x265 e do SVT-AV1
+        void setParams(AVDictionary **options, const char *key, const std::vector<std::string> &params) {
+            std::string joined;
+            for (const auto &param: params) {
+                joined += (joined.empty() ? "" : ":") + param;
+            }
+            if (!joined.empty()) {
+                av_dict_set(options, key, joined.c_str(), 0);
+            }
+        }
+
+        class X264Backend : public CodecBackend {
+        public:
+            explicit X264Backend(const AVCodec *codec)
+                : CodecBackend("libx264", AV_CODEC_ID_H264, codec) {
+                capabilities_.intraRefresh = true;
+                capabilities_.sliceSize = true;
+                capabilities_.regionsOfInterest = true;
+                capabilities_.presets = X264_PRESETS;
+                capabilities_.defaultPreset = "medium";
+                capabilities_.lowLatencyPreset = "ultrafast";
+                capabilities_.tunes = {
+                    "film", "animation", "grain", "stillimage", "psnr", "ssim", "fastdecode", "zerolatency"
+                };
+                capabilities_.lowLatencyTune = "zerolatency";
+                capabilities_.profiles = {"baseline", "main", "high"};
+            }
+
+        protected:
+            void configureCodec(AVCodecContext *context, AVDictionary **options,
+                                const ServerConfig::EncoderConfig &config, int maxSliceSize) const override {
+                if (context->bit_rate <= 0) {
+                    av_dict_set_int(options, "crf", config.advanced.qp, 0);
+                }
+                // ROIs exigem AQ; o preset ultrafast a desliga
+                if (config.roiEncoding) {
+                    av_dict_set(options, "aq-mode", "1", 0);
+                }
+                if (config.intraRefresh) {
+                    av_dict_set(options, "intra-refresh", "1", 0);
+                }
+                if (config.sliceOutput) {
+                    av_dict_set_int(options, "slice-max-size", maxSliceSize, 0);
+                }
+            }
+        };
+
+        class X265Backend : public CodecBackend {
+        public:
+            explicit X265Backend(const AVCodec *codec)
+                : CodecBackend("libx265", AV_CODEC_ID_HEVC, codec) {
+                capabilities_.intraRefresh = true;
+                capabilities_.regionsOfInterest = true;
+                capabilities_.presets = X264_PRESETS;
+                capabilities_.defaultPreset = "medium";
+                capabilities_.lowLatencyPreset = "ultrafast";
+                capabilities_.tunes = {"psnr", "ssim", "grain", "zerolatency", "fastdecode", "animation"};
+                capabilities_.lowLatencyTune = "zerolatency";
+                capabilities_.profiles = {"main", "main10"};
+            }
+
+        protected:
+            void configureCodec(AVCodecContext *context, AVDictionary **options,
+                                const ServerConfig::EncoderConfig &config, int) const override {
+                if (context->bit_rate <= 0) {
+                    av_dict_set_int(options, "crf", config.advanced.qp, 0);
+                }
+                // Keyframes forçados (novo cliente) precisam ser IDR para o decoder entrar
+                av_dict_set(options, "forced-idr", "1", 0);
+
+                std::vector<std::string> params;
+                if (config.roiEncoding) {
+                    params.push_back("aq-mode=1");
+                }
+                if (config.intraRefresh) {
+                    params.push_back("intra-refresh=1");
+                }
+                if (config.sliceOutput) {
+                    params.push_back("slices=" + std::to_string(std::max(1, context->height / SLICE_HEIGHT)));
+                }
+                setParams(options, "x265-params", params);
+            }
+        };
+
+        class SvtAv1Backend : public CodecBackend {
+        public:
+            explicit SvtAv1Backend(const AVCodec *codec)
+                : CodecBackend("libsvtav1", AV_CODEC_ID_AV1, codec) {
+                capabilities_.presets = SVT_AV1_PRESETS;
+                capabilities_.defaultPreset = "10";
+                capabilities_.lowLatencyPreset = "12";
+                capabilities_.profiles = {"main"};
+            }
+
+        protected:
+            void configureCodec(AVCodecContext *context, AVDictionary **options,
+                                const ServerConfig::EncoderConfig &config, int) const override {
+                if (context->bit_rate <= 0) {
+                    av_dict_set_int(options, "crf", std::max(1, scaledQp(config.advanced.qp, 63)), 0);
+                }
+
+                // Estrutura low delay: só frames P, sem lookahead
+                std::vector<std::string> params;
+                if (zeroLatency(config)) {
+                    params.push_back("pred-struct=1");
+                    params.push_back("lookahead=0");
+                }
+                setParams(options, "svtav1-params", params);
+            }
+        };
+
+        class NvencBackend : public CodecBackend {
+        public:
+            NvencBackend(const std::string &encoder, AVCodecID codecId, const AVCodec *codec)
+                : CodecBackend(encoder, codecId, codec) {
+                capabilities_.hardware = true;
+                capabilities_.intraRefresh = true;
+                capabilities_.presets = NVENC_PRESETS;
+                capabilities_.defaultPreset = "p4";
+                capabilities_.lowLatencyPreset = "p1";
+                capabilities_.tunes = {"hq", "ll", "ull", "lossless"};
+                capabilities_.lowLatencyTune = "ull";
+                capabilities_.profiles = codecId == AV_CODEC_ID_H264
+                                             ? std::vector<std::string>{"baseline", "main", "high"}
+                                             : codecId == AV_CODEC_ID_HEVC
+                                                   ? std::vector<std::string>{"main", "main10"}
+                                                   : std::vector<std::string>{"main"};
+            }
+
+        protected:
+            void configureCodec(AVCodecContext *context, AVDictionary **options,
+                                const ServerConfig::EncoderConfig &config, int) const override {
+                if (context->bit_rate <= 0) {
+                    av_dict_set(options, "rc", "constqp", 0);
+                    av_dict_set_int(options, "qp", scaledQp(config.advanced.qp,
+                                                            capabilities_.codecId == AV_CODEC_ID_AV1 ? 255 : MAX_QP), 0);
+                }
+                if (zeroLatency(config)) {
+                    av_dict_set(options, "zerolatency", "1", 0);
+                    av_dict_set(options, "delay", "0", 0);
+                }
+                if (config.intraRefresh) {
+                    av_dict_set(options, "intra-refresh", "1", 0);
+                }
+            }
+        };
+
+        // Encoders fora da tabela recebem só as opções genéricas
+        class GenericBackend : public CodecBackend {
+        public:
+            GenericBackend(const std::string &encoder, const AVCodec *codec)
+                : CodecBackend(encoder, codec ? codec->id : AV_CODEC_ID_NONE, codec) {
+                capabilities_.hardware = codec && (codec->capabilities & AV_CODEC_CAP_HARDWARE) != 0;
+            }
+        };
+
+        std::unique_ptr<CodecBackend> makeBackend(const std::string &encoder, const AVCodec *codec) {
+            if (encoder == "libx264") {
+                return std::make_unique<X264Backend>(codec);
+            }
+            if (encoder == "libx265") {
+                return std::make_unique<X265Backend>(codec);
+            }
+            if (encoder == "libsvtav1") {
+                return std::make_unique<SvtAv1Backend>(codec);
+            }
+            if (encoder == "h264_nvenc") {
+                return std::make_unique<NvencBackend>(encoder, AV_CODEC_ID_H264, codec);
+            }
+            if (encoder == "hevc_nvenc") {
+                return std::make_unique<NvencBackend>(encoder, AV_CODEC_ID_HEVC, codec);
+            }
+            if (encoder == "av1_nvenc") {
+                return std::make_unique<NvencBackend>(encoder, AV_CODEC_ID_AV1, codec);
+            }
+            return std::make_unique<GenericBackend>(encoder, codec);
+        }
+    }
+
+    CodecBackend::CodecBackend(const std::string &encoder, AVCodecID codecId, const AVCodec *codec)
+        : codec_(codec) {
+        capabilities_.encoder = encoder;
+        capabilities_.codecId = codecId;
+        capabilities_.rtp = rtpSupports(codecId);
+        capabilities_.available = codec != nullptr && capabilities_.rtp;
+    }
+
+    bool CodecBackend::zeroLatency(const ServerConfig::EncoderConfig &config) {
+        return config.lowLatency && config.advanced.zeroLatency;
+    }
+
+    std::string CodecBackend::selectPreset(const ServerConfig::EncoderConfig &config) const {
+        if (contains(capabilities_.presets, config.advanced.preset)) {
+            return config.advanced.preset;
+        }
+        return config.lowLatency ? capabilities_.lowLatencyPreset : std::string();
+    }
+
+    std::string CodecBackend::selectTune(const ServerConfig::EncoderConfig &config) const {
+        if (contains(capabilities_.tunes, config.advanced.tune)) {
+            return config.advanced.tune;
+        }
+        return zeroLatency(config) ? capabilities_.lowLatencyTune : std::string();
+    }
+
+    void CodecBackend::configure(AVCodecContext *context, AVDictionary **options,
+                                 const ServerConfig::EncoderConfig &config,
+                                 const std::string &preset, int maxSliceSize) const {
+        context->max_b_frames = config.advanced.maxBFrames;
+        context->keyint_min = config.advanced.keyintMin;
+        context->thread_count = config.advanced.threads;
+
+        if (!preset.empty()) {
+            av_dict_set(options, "preset", preset.c_str(), 0);
+        }
+        const std::string tune = selectTune(config);
+        if (!tune.empty()) {
+            av_dict_set(options, "tune", tune.c_str(), 0);
+        }
+        if (contains(capabilities_.profiles, config.advanced.profile)) {
+            av_dict_set(options, "profile", config.advanced.profile.c_str(), 0);
+        }
+
+        // Sem limite de bytes por slice: slices por altura
+        if (config.sliceOutput && !capabilities_.sliceSize) {
+            context->slices = std::max(1, context->height / SLICE_HEIGHT);
+        }
+
+        configureCodec(context, options, config, maxSliceSize);
+    }
+
+    void CodecBackend::configureCodec(AVCodecContext *, AVDictionary **,
+                                      const ServerConfig::EncoderConfig &, int) const {
+    }
+
+    std::unique_ptr<CodecBackend> CodecBackend::create(const std::string &encoder, bool hardwareAvailable) {
+        const AVCodec *codec = avcodec_find_encoder_by_name(encoder.c_str());
+        std::unique_ptr<CodecBackend> backend = makeBackend(encoder, codec);
+        if (!backend->capabilities().rtp) {
+            std::cerr << "CodecBackend::create() - " << encoder << ": o muxer RTP deste FFmpeg não empacota "
+                    << avcodec_get_name(backend->capabilities().codecId)
+                    << " (AV1 exige libavformat >= 61.7, FFmpeg 7.1)" << std::endl;
+            return nullptr;
+        }
+        if (codec && (!backend->capabilities().hardware || hardwareAvailable)) {
+            return backend;
+        }
+
+        // Fallback para o encoder por software do mesmo codec (H.264 se desconhecido)
+        const AVCodecID codecId = backend->capabilities().codecId != AV_CODEC_ID_NONE
+                                      ? backend->capabilities().codecId
+                                      : AV_CODEC_ID_H264;
+        const char *software = codecId == AV_CODEC_ID_HEVC ? "libx265"
+                               : codecId == AV_CODEC_ID_AV1 ? "libsvtav1"
+                               : "libx264";
+        codec = avcodec_find_encoder_by_name(software);
+        if (!codec) {
+            codec = avcodec_find_encoder(codecId);
+        }
+        if (!codec || (codec->capabilities & AV_CODEC_CAP_HARDWARE) != 0) {
+            return nullptr;
+        }
+        return makeBackend(codec->name, codec);
+    }
+
+    std::vector<CodecBackend::Capabilities> CodecBackend::query() {
+        std::vector<Capabilities> result;
+        for (const auto &encoder: KNOWN_ENCODERS) {
+            result.push_back(makeBackend(encoder, avcodec_find_encoder_by_name(encoder.c_str()))->capabilities());
+        }
+        return result;
+    }
+
+} // namespace turbovision
@@ -0,0 +1,91 @@
+#include "turbovision/server/encoder_governor.hpp"
+
+#include <algorithm>
+
+namespace turbovision {
+    namespace {
+        const double OVERLOAD = 0.9;          // Fração do orçamento considerada sobrecarga
+        const double UNDERLOAD = 0.5;         // Abaixo disso há folga para recuperar
+        const int OVERLOAD_WINDOWS = 2;       // Janelas seguidas antes de degradar
+
+        const auto WINDOW = std::chrono::seconds(1);
+        const auto SETTLE = std::chrono::seconds(2);          // Espera o efeito da última troca
+        const auto RECOVERY_HOLD = std::chrono::seconds(10);
+        const auto MAX_RECOVERY_HOLD = std::chrono::seconds(160);
+        const auto FAILED_RECOVERY = std::chrono::seconds(15); // Degradar logo após recuperar
+    }
+
+    EncoderGovernor::EncoderGovernor(int maxLevel)
+        : maxLevel_(maxLevel)
+          , level_(0)
+          , transitions_(0)
+          , load_(0.0f)
+          , loadSum_(0.0)
+          , samples_(0)
+          , missed_(0)
+          , overloadedWindows_(0)
+          , windowStart_(std::chrono::steady_clock::now())
+          , lastChange_(windowStart_)
+          , underloadSince_(windowStart_)
+          , lastRecovery_()
+          , recoveryHold_(RECOVERY_HOLD)
+          , underloaded_(false) {
+    }
+
+    void EncoderGovernor::addSample(double encodeTime, double budget) {
+        if (budget > 0.0) {
+            loadSum_ += encodeTime / budget;
+            samples_++;
+        }
+    }
+
+    void EncoderGovernor::addMissed(int frames) {
+        missed_ += frames;
+    }
+
+    bool EncoderGovernor::update(std::chrono::steady_clock::time_point now) {
+        if (now - windowStart_ < WINDOW || samples_ == 0) {
+            return false;
+        }
+
+        load_ = static_cast<float>(loadSum_ / samples_);
+        const bool overloaded = load_ > OVERLOAD || missed_ > 0;
+        const bool underloaded = load_ < UNDERLOAD && missed_ == 0;
+        windowStart_ = now;
+        loadSum_ = 0.0;
+        samples_ = 0;
+        missed_ = 0;
+
+        overloadedWindows_ = overloaded ? overloadedWindows_ + 1 : 0;
+        if (!underloaded) {
+            underloaded_ = false;
+        } else if (!underloaded_) {
+            underloaded_ = true;
+            underloadSince_ = now;
+        }
+
+        if (overloadedWindows_ >= OVERLOAD_WINDOWS && level_ < maxLevel_ && now - lastChange_ >= SETTLE) {
+            // Recuperação que não se sustentou: exige mais folga na próxima
+            if (transitions_ > 0 && now - lastRecovery_ < FAILED_RECOVERY) {
+                recoveryHold_ = std::min(recoveryHold_ * 2, MAX_RECOVERY_HOLD);
+            }
+            level_++;
+            transitions_++;
+            overloadedWindows_ = 0;
+            underloaded_ = false;
+            lastChange_ = now;
+            return true;
+        }
+
+        if (underloaded_ && level_ > 0 && now - underloadSince_ >= recoveryHold_ && now - lastChange_ >= SETTLE) {
+            level_--;
+            transitions_++;
+            underloaded_ = false;
+            lastChange_ = now;
+            lastRecovery_ = now;
+            return true;
+        }
+        return false;
+    }
+
+} // namespace turbovision
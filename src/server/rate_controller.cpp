@@ -0,0 +1,119 @@
+#include "turbovision/server/rate_controller.hpp"
+
+#include <algorithm>
+
+namespace turbovision {
+    namespace {
+        // Limiares do controlador por perda (GCC)
+        const double LOSS_DECREASE = 0.10;
+        const double LOSS_INCREASE = 0.02;
+        const double PROBE_FACTOR = 1.08;
+
+        // Reação a atraso crescente
+        const double DELAY_FACTOR = 0.85;
+        const double JITTER_MARGIN = 30.0;     // ms acima da referência
+        const double RTT_MARGIN = 50.0;        // ms acima do menor RTT
+        const double QUEUE_DELAY_LIMIT = 150.0; // ms na fila TCP
+
+        // Trocar o fps reabre o encoder (keyframe): no máximo a cada 5 s
+        const auto FPS_HOLD = std::chrono::seconds(5);
+    }
+
+    RateController::RateController(const Settings &settings)
+        : settings_(settings)
+          , bitrate_(std::clamp(settings.startBitrate, settings.minBitrate, settings.maxBitrate))
+          , fps_(settings.maxFps)
+          , samples_(0)
+          , minRtt_(-1.0)
+          , jitterBaseline_(-1.0)
+          , lastUpdate_(std::chrono::steady_clock::now())
+          , lastFpsChange_(lastUpdate_) {
+    }
+
+    void RateController::onFeedback(const Feedback &feedback) {
+        std::lock_guard<std::mutex> lock(feedbackMutex_);
+        if (samples_ == 0) {
+            worst_ = feedback;
+        } else {
+            worst_.fractionLost = std::max(worst_.fractionLost, feedback.fractionLost);
+            worst_.jitter = std::max(worst_.jitter, feedback.jitter);
+            worst_.rtt = std::max(worst_.rtt, feedback.rtt);
+            worst_.queueDelay = std::max(worst_.queueDelay, feedback.queueDelay);
+        }
+        samples_++;
+    }
+
+    bool RateController::update(std::chrono::steady_clock::time_point now, Decision &decision) {
+        if (now - lastUpdate_ < std::chrono::milliseconds(settings_.interval)) {
+            return false;
+        }
+        lastUpdate_ = now;
+
+        Feedback worst; {
+            std::lock_guard<std::mutex> lock(feedbackMutex_);
+            if (samples_ == 0) {
+                return false; // Sem RR no período: mantém a taxa
+            }
+            worst = worst_;
+            samples_ = 0;
+        }
+
+        // Referências de atraso; o menor RTT sobe devagar para acompanhar
+        // mudanças de rota
+        if (worst.rtt >= 0.0) {
+            minRtt_ = minRtt_ < 0.0 ? worst.rtt : std::min(worst.rtt, minRtt_ + 1.0);
+        }
+        if (jitterBaseline_ < 0.0) {
+            jitterBaseline_ = worst.jitter;
+        }
+
+        const bool delayed = worst.queueDelay > QUEUE_DELAY_LIMIT ||
+                             worst.jitter > jitterBaseline_ + JITTER_MARGIN ||
+                             (worst.rtt >= 0.0 && worst.rtt > minRtt_ + std::max(RTT_MARGIN, minRtt_));
+
+        int64_t target = bitrate_;
+        bool congested = true;
+        decision.reason = "hold";
+        if (worst.fractionLost > LOSS_DECREASE) {
+            target = static_cast<int64_t>(bitrate_ * (1.0 - 0.5 * worst.fractionLost));
+            decision.reason = "loss";
+        } else if (delayed) {
+            target = static_cast<int64_t>(bitrate_ * DELAY_FACTOR);
+            decision.reason = "delay";
+        } else {
+            congested = false;
+        }
+        if (!congested && worst.fractionLost < LOSS_INCREASE) {
+            target = static_cast<int64_t>(bitrate_ * PROBE_FACTOR);
+            decision.reason = "probe";
+        }
+        target = std::clamp(target, settings_.minBitrate, settings_.maxBitrate);
+
+        if (!delayed) {
+            jitterBaseline_ += (worst.jitter - jitterBaseline_) / 16.0;
+        }
+
+        // Sem margem para reduzir bitrate: troca fluidez por qualidade por frame
+        int fps = fps_;
+        if (now - lastFpsChange_ >= FPS_HOLD) {
+            if (congested && bitrate_ <= settings_.minBitrate) {
+                fps = std::max(settings_.minFps, fps_ * 3 / 4);
+            } else if (!congested && fps_ < settings_.maxFps && target >= 2 * settings_.minBitrate) {
+                fps = std::min(settings_.maxFps, fps_ * 4 / 3 + 1);
+            }
+        }
+
+        const bool changed = target != bitrate_ || fps != fps_;
+        if (fps != fps_) {
+            lastFpsChange_ = now;
+        }
+        bitrate_ = target;
+        fps_ = fps;
+
+        decision.bitrate = bitrate_;
+        decision.fps = fps_;
+        decision.worst = worst;
+        return changed;
+    }
+
+} // namespace turbovision
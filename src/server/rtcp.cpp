@@ -0,0 +1,92 @@
+#include "turbovision/server/rtcp.hpp"
+
+#include <chrono>
+
+namespace turbovision {
+namespace rtcp {
+    namespace {
+        const uint8_t PT_SENDER_REPORT = 200;
+        const uint8_t PT_RECEIVER_REPORT = 201;
+        const size_t REPORT_BLOCK_SIZE = 24;
+        const size_t SENDER_INFO_SIZE = 20;
+
+        // Segundos entre 1900 (NTP) e 1970 (Unix)
+        const uint64_t NTP_UNIX_OFFSET = 2208988800ULL;
+
+        uint32_t read32(const uint8_t *p) {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+        }
+    }
+
+    bool parseReportBlocks(const uint8_t *data, size_t size, std::vector<ReportBlock> &blocks) {
+        bool valid = false;
+
+        while (size >= 8) {
+            const uint8_t version = data[0] >> 6;
+            const uint8_t count = data[0] & 0x1F;
+            const uint8_t type = data[1];
+            const size_t length = (static_cast<size_t>((data[2] << 8) | data[3]) + 1) * 4;
+
+            if (version != 2 || length > size) {
+                break;
+            }
+            valid = true;
+
+            size_t offset = 8;
+            if (type == PT_SENDER_REPORT) {
+                offset += SENDER_INFO_SIZE;
+            }
+
+            if (type == PT_SENDER_REPORT || type == PT_RECEIVER_REPORT) {
+                const uint32_t reporter = read32(data + 4);
+                for (uint8_t i = 0; i < count && offset + REPORT_BLOCK_SIZE <= length; i++) {
+                    const uint8_t *p = data + offset;
+
+                    ReportBlock block;
+                    block.reporterSsrc = reporter;
+                    block.sourceSsrc = read32(p);
+                    block.fractionLost = p[4];
+                    // Perda acumulada: inteiro de 24 bits com sinal
+                    int32_t lost = static_cast<int32_t>((p[5] << 16) | (p[6] << 8) | p[7]);
+                    block.cumulativeLost = (lost & 0x800000) ? lost - 0x1000000 : lost;
+                    block.highestSequence = read32(p + 8);
+                    block.jitter = read32(p + 12);
+                    block.lastSenderReport = read32(p + 16);
+                    block.delaySinceLastSenderReport = read32(p + 20);
+                    blocks.push_back(block);
+
+                    offset += REPORT_BLOCK_SIZE;
+                }
+            }
+
+            data += length;
+            size -= length;
+        }
+
+        return valid;
+    }
+
+    uint32_t ntpMiddle32Now() {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+
+        uint64_t seconds = static_cast<uint64_t>(micros / 1000000) + NTP_UNIX_OFFSET;
+        uint64_t fraction = (static_cast<uint64_t>(micros % 1000000) << 32) / 1000000;
+        return static_cast<uint32_t>(((seconds & 0xFFFF) << 16) | (fraction >> 16));
+    }
+
+    double roundTripTime(const ReportBlock &block, uint32_t ntpMiddle32) {
+        if (block.lastSenderReport == 0) {
+            return -1.0;
+        }
+
+        // RFC 3550, 6.4.1: A - LSR - DLSR em unidades de 1/65536 s
+        const uint32_t rtt = ntpMiddle32 - block.lastSenderReport - block.delaySinceLastSenderReport;
+        if (rtt > 0x7FFFFFFF) {
+            return -1.0; // Relógio inconsistente
+        }
+        return rtt * 1000.0 / 65536.0;
+    }
+} // namespace rtcp
+} // namespace turbovision
@@ -0,0 +1,554 @@
+#include "turbovision/server/rtp_egress.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/uio.h>
+#endif
+
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace turbovision {
+    namespace {
+        // Limites do kernel para um datagrama com UDP_SEGMENT
+        const size_t MAX_GSO_SEGMENTS = 64;
+        const size_t MAX_GSO_BYTES = 65000;
+
+        // Mensagens por sendmmsg e iovecs por sendmsg (UIO_MAXIOV = 1024)
+        const size_t MAX_BATCH_MESSAGES = 256;
+        const size_t MAX_STREAM_IOVS = 128;
+
+        // Desativado globalmente na primeira recusa do kernel
+        std::atomic<bool> gsoSupported{true};
+
+        const size_t INTERLEAVED_HEADER_SIZE = 4;
+    }
+
+    // ==================== UdpEgress ====================
+
+    UdpEgress::UdpEgress(const EgressOptions &options, EgressCounters &counters)
+        : options_(options)
+          , counters_(counters) {
+    }
+
+    UdpEgress::~UdpEgress() {
+        flush();
+    }
+
+    bool UdpEgress::isGsoAvailable() {
+#ifdef __linux__
+        return gsoSupported;
+#else
+        return false;
+#endif
+    }
+
+    void UdpEgress::add(net::SocketHandle socket, const sockaddr_in &target,
+                        const RtpPacketPtr *packets, size_t count) {
+        const bool gso = options_.batched && options_.gso && isGsoAvailable();
+
+        size_t i = 0;
+        while (i < count) {
+            const size_t segment = packets[i]->data.size();
+
+            Datagram datagram{socket, target, iovs_.size(), 1, 0};
+            iovs_.emplace_back(packets[i]->data.data(), segment);
+            size_t total = segment;
+            i++;
+
+            // Pacotes consecutivos do mesmo tamanho viram um único datagrama
+            // GSO; apenas o último segmento pode ser menor.
+            while (gso && i < count && datagram.iovCount < MAX_GSO_SEGMENTS) {
+                const size_t size = packets[i]->data.size();
+                if (size > segment || total + size > MAX_GSO_BYTES) {
+                    break;
+                }
+
+                iovs_.emplace_back(packets[i]->data.data(), size);
+                datagram.iovCount++;
+                total += size;
+                i++;
+
+                if (size < segment) {
+                    break;
+                }
+            }
+
+            if (datagram.iovCount > 1) {
+                datagram.segmentSize = static_cast<uint16_t>(segment);
+            }
+            datagrams_.push_back(datagram);
+        }
+    }
+
+    void UdpEgress::flush() {
+        if (datagrams_.empty()) {
+            return;
+        }
+
+#ifdef __linux__
+        if (options_.batched) {
+            std::vector<size_t> indices(datagrams_.size());
+            for (size_t i = 0; i < indices.size(); i++) {
+                indices[i] = i;
+            }
+            flushDatagrams(indices, isGsoAvailable());
+        } else
+#endif
+        {
+            for (const auto &datagram: datagrams_) {
+                sendUnbatched(datagram);
+            }
+        }
+
+        datagrams_.clear();
+        iovs_.clear();
+    }
+
+    void UdpEgress::flushDatagrams(const std::vector<size_t> &indices, bool allowGso) {
+#ifdef __linux__
+        const size_t controlSize = CMSG_SPACE(sizeof(uint16_t));
+
+        // Sem GSO cada segmento vira uma mensagem própria
+        size_t messageCount = 0;
+        for (size_t index: indices) {
+            const auto &datagram = datagrams_[index];
+            messageCount += (allowGso && datagram.segmentSize) ? 1 : datagram.iovCount;
+        }
+
+        std::vector<iovec> iov(iovs_.size());
+        for (size_t i = 0; i < iovs_.size(); i++) {
+            iov[i].iov_base = const_cast<uint8_t *>(iovs_[i].first);
+            iov[i].iov_len = iovs_[i].second;
+        }
+
+        std::vector<mmsghdr> messages(messageCount);
+        std::vector<char> control(messageCount * controlSize, 0);
+        std::vector<size_t> owner(messageCount);     // Índice do datagrama
+        std::vector<size_t> packets(messageCount);
+        std::vector<size_t> bytes(messageCount);
+
+        // Os sockets podem ser diferentes (RTP e RTCP); cada sendmmsg usa um só
+        std::vector<net::SocketHandle> sockets(messageCount);
+
+        size_t m = 0;
+        for (size_t index: indices) {
+            auto &datagram = datagrams_[index];
+            const bool segmented = allowGso && datagram.segmentSize;
+            const size_t parts = segmented ? 1 : datagram.iovCount;
+
+            for (size_t part = 0; part < parts; part++, m++) {
+                msghdr &header = messages[m].msg_hdr;
+                header.msg_name = &datagram.target;
+                header.msg_namelen = sizeof(datagram.target);
+                header.msg_iov = &iov[datagram.firstIov + part];
+                header.msg_iovlen = segmented ? datagram.iovCount : 1;
+
+                bytes[m] = 0;
+                for (size_t k = 0; k < header.msg_iovlen; k++) {
+                    bytes[m] += header.msg_iov[k].iov_len;
+                }
+                packets[m] = header.msg_iovlen;
+                owner[m] = index;
+                sockets[m] = datagram.socket;
+
+                if (segmented) {
+                    char *buffer = control.data() + m * controlSize;
+                    header.msg_control = buffer;
+                    header.msg_controllen = controlSize;
+
+                    cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+                    cmsg->cmsg_level = SOL_UDP;
+                    cmsg->cmsg_type = UDP_SEGMENT;
+                    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    std::memcpy(CMSG_DATA(cmsg), &datagram.segmentSize, sizeof(uint16_t));
+                }
+            }
+        }
+
+        size_t sent = 0;
+        while (sent < messageCount) {
+            size_t batch = 1;
+            while (sent + batch < messageCount && batch < MAX_BATCH_MESSAGES &&
+                   sockets[sent + batch] == sockets[sent]) {
+                batch++;
+            }
+
+            int result = sendmmsg(sockets[sent], &messages[sent], static_cast<unsigned int>(batch), 0);
+            counters_.syscalls++;
+
+            if (result > 0) {
+                for (size_t k = sent; k < sent + static_cast<size_t>(result); k++) {
+                    counters_.packets += packets[k];
+                    counters_.bytes += bytes[k];
+                }
+                sent += static_cast<size_t>(result);
+                continue;
+            }
+
+            if (result < 0 && allowGso && messages[sent].msg_hdr.msg_control &&
+                (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT || errno == EOPNOTSUPP)) {
+                // Kernel ou interface sem suporte: reenvia o restante sem GSO
+                gsoSupported = false;
+                std::vector<size_t> remaining;
+                for (size_t k = sent; k < messageCount; k++) {
+                    if (remaining.empty() || remaining.back() != owner[k]) {
+                        remaining.push_back(owner[k]);
+                    }
+                }
+                flushDatagrams(remaining, false);
+                return;
+            }
+
+            if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+                // Destino inválido (ex.: ECONNREFUSED): descarta só esta mensagem
+                counters_.dropped += packets[sent];
+                sent++;
+                continue;
+            }
+
+            // Buffer do socket cheio: o restante do lote é descartado
+            for (size_t k = sent; k < messageCount; k++) {
+                counters_.dropped += packets[k];
+            }
+            break;
+        }
+#else
+        (void) allowGso;
+        for (size_t index: indices) {
+            sendUnbatched(datagrams_[index]);
+        }
+#endif
+    }
+
+    void UdpEgress::sendUnbatched(const Datagram &datagram) {
+        for (size_t i = 0; i < datagram.iovCount; i++) {
+            const auto &iov = iovs_[datagram.firstIov + i];
+            int result = sendto(datagram.socket,
+                                reinterpret_cast<const char *>(iov.first),
+                                static_cast<int>(iov.second), 0,
+                                reinterpret_cast<const sockaddr *>(&datagram.target),
+                                sizeof(datagram.target));
+            counters_.syscalls++;
+
+            if (result < 0) {
+                counters_.dropped++;
+            } else {
+                counters_.packets++;
+                counters_.bytes += iov.second;
+            }
+        }
+    }
+
+    // ==================== InterleavedQueue ====================
+
+    size_t InterleavedQueue::Chunk::size() const {
+        return packet ? packet->data.size() + INTERLEAVED_HEADER_SIZE : text.size();
+    }
+
+    InterleavedQueue::InterleavedQueue()
+        : bytes_(0)
+          , zeroCopyState_(0)
+          , zeroCopyNextId_(0) {
+    }
+
+    void InterleavedQueue::pushPacket(const RtpPacketPtr &packet, uint8_t channel) {
+        auto chunk = std::make_shared<Chunk>();
+        const size_t size = packet->data.size();
+
+        chunk->packet = packet;
+        chunk->queuedAt = std::chrono::steady_clock::now();
+        chunk->header[0] = '$';
+        chunk->header[1] = channel;
+        chunk->header[2] = static_cast<uint8_t>((size >> 8) & 0xFF);
+        chunk->header[3] = static_cast<uint8_t>(size & 0xFF);
+
+        bytes_ += chunk->size();
+        chunks_.push_back(std::move(chunk));
+    }
+
+    void InterleavedQueue::pushText(const std::string &text) {
+        if (text.empty()) {
+            return;
+        }
+
+        auto chunk = std::make_shared<Chunk>();
+        chunk->text = text;
+        chunk->queuedAt = std::chrono::steady_clock::now();
+
+        bytes_ += chunk->size();
+        chunks_.push_back(std::move(chunk));
+    }
+
+    void InterleavedQueue::clear() {
+        chunks_.clear();
+        bytes_ = 0;
+    }
+
+    double InterleavedQueue::oldestDelay(std::chrono::steady_clock::time_point now) const {
+        if (chunks_.empty()) {
+            return 0.0;
+        }
+        return std::chrono::duration<double, std::milli>(now - chunks_.front()->queuedAt).count();
+    }
+
+    size_t InterleavedQueue::dropUntilKeyframe(bool &keyframeKept) {
+        // Keyframe mais recente que ainda não começou a ser enviado
+        size_t keep = chunks_.size();
+        for (size_t i = chunks_.size(); i-- > 0;) {
+            const auto &chunk = chunks_[i];
+            if (chunk->packet && chunk->packet->keyframe && chunk->packet->frameStart &&
+                chunk->offset == 0) {
+                keep = i;
+                break;
+            }
+        }
+        keyframeKept = keep < chunks_.size();
+
+        std::deque<ChunkPtr> remaining;
+        size_t dropped = 0;
+        for (size_t i = 0; i < chunks_.size(); i++) {
+            auto &chunk = chunks_[i];
+            if (i >= keep || !chunk->packet || chunk->offset > 0) {
+                remaining.push_back(std::move(chunk));
+                continue;
+            }
+            bytes_ -= chunk->size();
+            dropped++;
+        }
+
+        chunks_.swap(remaining);
+        return dropped;
+    }
+
+    bool InterleavedQueue::flush(net::SocketHandle socket, const EgressOptions &options,
+                                 EgressCounters &counters) {
+        if (options.zeroCopy) {
+            processCompletions(socket);
+        }
+
+        if (chunks_.empty()) {
+            return true;
+        }
+
+#ifdef _WIN32
+        return flushPerChunk(socket, counters);
+#else
+        if (!options.batched) {
+            return flushPerChunk(socket, counters);
+        }
+
+        bool zeroCopy = false;
+#ifdef __linux__
+        if (options.zeroCopy && zeroCopyState_ == 0) {
+            int enable = 1;
+            zeroCopyState_ = setsockopt(socket, SOL_SOCKET, SO_ZEROCOPY,
+                                        &enable, sizeof(enable)) == 0 ? 1 : -1;
+        }
+        zeroCopy = options.zeroCopy && zeroCopyState_ == 1;
+#endif
+        return flushBatched(socket, zeroCopy, counters);
+#endif
+    }
+
+    bool InterleavedQueue::flushBatched(net::SocketHandle socket, bool zeroCopy,
+                                        EgressCounters &counters) {
+#ifdef _WIN32
+        (void) zeroCopy;
+        return flushPerChunk(socket, counters);
+#else
+        iovec iov[MAX_STREAM_IOVS];
+
+        while (!chunks_.empty()) {
+            size_t count = 0;
+            size_t total = 0;
+            std::vector<ChunkPtr> touched;
+
+            for (const auto &chunk: chunks_) {
+                if (count + 2 > MAX_STREAM_IOVS) {
+                    break;
+                }
+
+                size_t offset = chunk->offset;
+                if (chunk->packet) {
+                    // Cabeçalho interleaved próprio + payload compartilhado
+                    if (offset < INTERLEAVED_HEADER_SIZE) {
+                        iov[count].iov_base = chunk->header + offset;
+                        iov[count].iov_len = INTERLEAVED_HEADER_SIZE - offset;
+                        total += iov[count++].iov_len;
+                        offset = 0;
+                    } else {
+                        offset -= INTERLEAVED_HEADER_SIZE;
+                    }
+                    iov[count].iov_base = const_cast<uint8_t *>(chunk->packet->data.data() + offset);
+                    iov[count].iov_len = chunk->packet->data.size() - offset;
+                } else {
+                    iov[count].iov_base = &chunk->text[offset];
+                    iov[count].iov_len = chunk->text.size() - offset;
+                }
+                total += iov[count++].iov_len;
+
+                if (zeroCopy) {
+                    touched.push_back(chunk);
+                }
+            }
+
+            msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = count;
+
+            int flags = MSG_NOSIGNAL;
+#ifdef __linux__
+            if (zeroCopy) {
+                flags |= MSG_ZEROCOPY;
+            }
+#endif
+            ssize_t sent = sendmsg(socket, &message, flags);
+            counters.syscalls++;
+
+            if (sent < 0) {
+                if (net::lastErrorWouldBlock()) {
+                    return true;
+                }
+                if (zeroCopy && errno == ENOBUFS) {
+                    // Limite de páginas presas (optmem) atingido; tenta no próximo POLLOUT
+                    return true;
+                }
+                return false;
+            }
+
+            if (zeroCopy && sent > 0) {
+                // Os buffers ficam referenciados até a notificação do kernel
+                zeroCopyPending_.emplace_back(zeroCopyNextId_++, std::move(touched));
+            }
+
+            counters.bytes += static_cast<uint64_t>(sent);
+            consume(static_cast<size_t>(sent), counters);
+
+            if (static_cast<size_t>(sent) < total) {
+                return true; // Socket cheio, aguarda POLLOUT
+            }
+        }
+
+        return true;
+#endif
+    }
+
+    bool InterleavedQueue::flushPerChunk(net::SocketHandle socket, EgressCounters &counters) {
+        std::vector<uint8_t> buffer;
+
+        while (!chunks_.empty()) {
+            const auto &chunk = chunks_.front();
+
+            const uint8_t *data;
+            size_t size;
+            if (chunk->packet) {
+                buffer.assign(chunk->header, chunk->header + INTERLEAVED_HEADER_SIZE);
+                buffer.insert(buffer.end(), chunk->packet->data.begin(), chunk->packet->data.end());
+                data = buffer.data() + chunk->offset;
+                size = buffer.size() - chunk->offset;
+            } else {
+                data = reinterpret_cast<const uint8_t *>(chunk->text.data()) + chunk->offset;
+                size = chunk->text.size() - chunk->offset;
+            }
+
+            int sent = send(socket, reinterpret_cast<const char *>(data),
+                            static_cast<int>(size), MSG_NOSIGNAL);
+            counters.syscalls++;
+
+            if (sent < 0) {
+                return net::lastErrorWouldBlock();
+            }
+
+            counters.bytes += static_cast<uint64_t>(sent);
+            consume(static_cast<size_t>(sent), counters);
+
+            if (static_cast<size_t>(sent) < size) {
+                return true;
+            }
+        }
+
+        return true;
+    }
+
+    void InterleavedQueue::consume(size_t sent, EgressCounters &counters) {
+        while (sent > 0 && !chunks_.empty()) {
+            auto &chunk = chunks_.front();
+            const size_t remaining = chunk->size() - chunk->offset;
+
+            if (sent < remaining) {
+                chunk->offset += sent;
+                bytes_ -= sent;
+                return;
+            }
+
+            if (chunk->packet) {
+                counters.packets++;
+            }
+            sent -= remaining;
+            bytes_ -= remaining;
+            chunks_.pop_front();
+        }
+    }
+
+    void InterleavedQueue::processCompletions(net::SocketHandle socket) {
+#ifdef __linux__
+        while (!zeroCopyPending_.empty()) {
+            char control[128];
+            msghdr message{};
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            if (recvmsg(socket, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+                return;
+            }
+
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+                if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                      (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) {
+                    continue;
+                }
+
+                sock_extended_err error;
+                std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+                if (error.ee_errno != 0 || error.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                    continue;
+                }
+
+                // Intervalo [ee_info, ee_data] de envios concluídos
+                const uint32_t first = error.ee_info;
+                const uint32_t last = error.ee_data;
+                zeroCopyPending_.erase(
+                    std::remove_if(zeroCopyPending_.begin(), zeroCopyPending_.end(),
+                                   [first, last](const std::pair<uint32_t, std::vector<ChunkPtr>> &entry) {
+                                       return entry.first - first <= last - first;
+                                   }),
+                    zeroCopyPending_.end());
+            }
+        }
+#else
+        (void) socket;
+#endif
+    }
+} // namespace turbovision
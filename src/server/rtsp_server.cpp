@@ -1,32 +1,69 @@
 #include "turbovision/server/rtsp_server.hpp"
+#include "turbovision/server/server_stream.hpp"
+#include "turbovision/server/rtsp_session.hpp"
+#include <algorithm>
 #include <chrono>
-#include <sstream>
+#include <set>
+
+#ifdef _WIN32
+#define poll WSAPoll
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 namespace turbovision {
     RTSPServer::RTSPServer(const ServerConfig &config, const VideoConfig &videoConfig)
         : config_(config)
           , videoConfig_(videoConfig)
-          , formatContext_(nullptr)
-          , encoderContext_(nullptr)
-          , videoStream_(nullptr)
+          , listenSocket_(net::INVALID_SOCKET_HANDLE)
+          , rtpSocket_(net::INVALID_SOCKET_HANDLE)
+          , rtcpSocket_(net::INVALID_SOCKET_HANDLE)
+          , wakeupPipe_{-1, -1}
+          , playingSessions_(0)
+          , egressOptions_(config.network)
           , isRunning_(false) {
-        hwManager_ = std::make_shared<HardwareManager>(videoConfig.deviceType);
-        resetStats();
+        // Sem GPU os streams usam encoders por software
+        try {
+            hwManager_ = std::make_shared<HardwareManager>(videoConfig.deviceType);
+        } catch (const Exception &) {
+            hwManager_.reset();
+        }
+
+        workerPool_ = std::make_unique<WorkerPool>(
+            static_cast<size_t>(std::max(0, config_.workerThreads)));
+
+#ifndef _WIN32
+        // Pipe usado pelas threads de codificação para acordar o loop de I/O
+        if (pipe(wakeupPipe_) == 0) {
+            net::setNonBlocking(wakeupPipe_[0]);
+            net::setNonBlocking(wakeupPipe_[1]);
+        }
+#endif
     }
 
     RTSPServer::~RTSPServer() {
         stop();
 
-        if (encoderContext_) {
-            avcodec_free_context(&encoderContext_);
+        std::map<std::string, std::shared_ptr<ServerStream>> streams; {
+            std::lock_guard<std::mutex> lock(streamsMutex_);
+            streams.swap(streams_);
+        }
+        for (auto &entry: streams) {
+            entry.second->close();
         }
 
-        if (formatContext_) {
-            if (!(formatContext_->oformat->flags & AVFMT_NOFILE)) {
-                avio_closep(&formatContext_->pb);
+        // Aguarda as codificações em andamento antes de liberar os encoders
+        workerPool_->shutdown();
+
+#ifndef _WIN32
+        for (int &fd: wakeupPipe_) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
             }
-            avformat_free_context(formatContext_);
         }
+#endif
     }
 
     bool RTSPServer::start() {
@@ -35,408 +72,442 @@ namespace turbovision {
         }
 
         if (!initializeServer()) {
+            shutdownNetworking();
+            return false;
+        }
+
+        // Stream padrão, mantendo a interface de stream único
+        if (!config_.streamName.empty() && !hasStream(config_.streamName) &&
+            !addStream(config_.streamName, videoConfig_)) {
+            shutdownNetworking();
             return false;
         }
 
         isRunning_ = true;
-        resetStats();
         serverThread_ = std::thread(&RTSPServer::serverLoop, this);
 
         return true;
     }
 
     void RTSPServer::stop() {
-        isRunning_ = false;
+        if (!isRunning_.exchange(false)) {
+            return;
+        }
 
+        wakeup();
         if (serverThread_.joinable()) {
             serverThread_.join();
         }
 
-        clearFrameQueue();
+        closeAllSessions();
+        shutdownNetworking();
     }
 
-    bool RTSPServer::pushFrame(const uint8_t *frameData, int size) {
-        if (!isRunning_ || !frameData) {
-            return false;
-        }
-
-        AVFrame *frame = createVideoFrame(videoConfig_.width,
-                                          videoConfig_.height,
-                                          encoderContext_->pix_fmt);
-        if (!frame) {
+    bool RTSPServer::addStream(const std::string &name, const VideoConfig &videoConfig) {
+        if (name.empty()) {
             return false;
         }
 
-        if (!convertFrame(frameData, size, frame)) {
-            av_frame_free(&frame);
-            return false;
-        } {
-            std::lock_guard<std::mutex> lock(frameMutex_);
-            frameQueue_.push(frame);
-
-            // Limitar tamanho da fila
-            while (frameQueue_.size() > 30) {
-                AVFrame *oldFrame = frameQueue_.front();
-                frameQueue_.pop();
-                av_frame_free(&oldFrame);
-
-                std::lock_guard<std::mutex> statsLock(statsMutex_);
-                stats_.droppedFrames++;
+        ServerConfig streamConfig = config_;
+        {
+            std::lock_guard<std::mutex> lock(streamsMutex_);
+            if (streams_.count(name) ||
+                streams_.size() >= static_cast<size_t>(config_.maxStreams)) {
+                return false;
             }
-        }
-
-        return true;
-    }
 
-    bool RTSPServer::pushFrame(const FramePtr &frame) {
-        if (!frame) {
-            return false;
+            // Cada stream multicast usa o próximo par de portas livre do grupo
+            if (config_.network.enableMulticast) {
+                std::set<int> usedPorts;
+                for (const auto &entry: streams_) {
+                    usedPorts.insert(entry.second->multicastPort());
+                }
+                while (usedPorts.count(streamConfig.network.multicastPort)) {
+                    streamConfig.network.multicastPort += 2;
+                }
+            }
         }
-        return pushFrame(frame->data(), frame->dataSize());
-    }
-
-    bool RTSPServer::initializeServer() {
-        // Criar contexto de saída
-        std::string url = "rtsp://" + config_.address + ":" +
-                          std::to_string(config_.port) + "/" +
-                          config_.streamName;
 
-        avformat_alloc_output_context2(&formatContext_, nullptr, "rtsp", url.c_str());
-        if (!formatContext_) {
+        // Abrir o encoder fora do lock para não bloquear os outros streams
+        auto stream = std::make_shared<ServerStream>(name, streamConfig, videoConfig,
+                                                     hwManager_, *workerPool_, egressCounters_);
+        if (!stream->open()) {
             return false;
         }
 
-        if (!setupEncoder()) {
-            return false;
-        }
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        stream->setFrameTraceCallback(frameTraceCallback_);
+        return streams_.emplace(name, stream).second;
+    }
 
-        if (!configureOutput()) {
-            return false;
+    bool RTSPServer::removeStream(const std::string &name) {
+        std::shared_ptr<ServerStream> stream; {
+            std::lock_guard<std::mutex> lock(streamsMutex_);
+            auto it = streams_.find(name);
+            if (it == streams_.end()) {
+                return false;
+            }
+            stream = it->second;
+            streams_.erase(it);
         }
 
+        stream->close();
+        wakeup();
         return true;
     }
 
-    bool RTSPServer::setupEncoder() {
-        // Encontrar encoder apropriado
-        const AVCodec *codec = nullptr;
-        if (hwManager_->isHardwareAvailable()) {
-            // Tentar usar encoder de hardware
-            codec = avcodec_find_encoder_by_name(config_.encoder.encoder.c_str());
-        }
+    bool RTSPServer::hasStream(const std::string &name) const {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        return streams_.count(name) > 0;
+    }
 
-        if (!codec) {
-            // Fallback para encoder por software
-            codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    std::vector<std::string> RTSPServer::getStreamNames() const {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        std::vector<std::string> names;
+        names.reserve(streams_.size());
+        for (const auto &entry: streams_) {
+            names.push_back(entry.first);
         }
+        return names;
+    }
 
-        if (!codec) {
-            return false;
-        }
+    bool RTSPServer::pushFrame(const uint8_t *frameData, int size,
+                               const std::vector<RegionOfInterest> &regions) {
+        return pushFrame(config_.streamName, frameData, size, regions);
+    }
 
-        // Criar stream
-        videoStream_ = avformat_new_stream(formatContext_, codec);
-        if (!videoStream_) {
-            return false;
-        }
+    bool RTSPServer::pushFrame(const FramePtr &frame, const std::vector<RegionOfInterest> &regions) {
+        return pushFrame(config_.streamName, frame, regions);
+    }
 
-        // Configurar encoder
-        encoderContext_ = avcodec_alloc_context3(codec);
-        if (!encoderContext_) {
+    bool RTSPServer::pushFrame(const std::string &streamName, const uint8_t *frameData, int size,
+                               const std::vector<RegionOfInterest> &regions) {
+        if (!isRunning_ || !frameData) {
             return false;
         }
 
-        // Configurações básicas
-        encoderContext_->width = videoConfig_.width;
-        encoderContext_->height = videoConfig_.height;
-        encoderContext_->time_base = AVRational{1, videoConfig_.fps};
-        encoderContext_->framerate = AVRational{videoConfig_.fps, 1};
-        encoderContext_->bit_rate = videoConfig_.bitrate;
-        encoderContext_->gop_size = config_.encoder.gopSize;
-        encoderContext_->max_b_frames = config_.encoder.advanced.maxBFrames;
-        encoderContext_->pix_fmt = AV_PIX_FMT_YUV420P;
-
-        // Configurar hardware
-        if (hwManager_->isHardwareAvailable()) {
-            encoderContext_->hw_device_ctx = av_buffer_ref(hwManager_->getContext());
+        auto stream = findStream(streamName);
+        if (!stream) {
+            return false;
         }
+        return stream->pushFrame(frameData, size, AV_NOPTS_VALUE, regions);
+    }
 
-        // Configurar opções específicas do encoder
-        AVDictionary *opts = nullptr;
-        if (config_.encoder.lowLatency) {
-            av_dict_set(&opts, "preset", "ultrafast", 0);
-            av_dict_set(&opts, "tune", "zerolatency", 0);
+    bool RTSPServer::pushFrame(const std::string &streamName, const FramePtr &frame,
+                               const std::vector<RegionOfInterest> &regions) {
+        if (!isRunning_ || !frame) {
+            return false;
         }
 
-        int ret = avcodec_open2(encoderContext_, codec, &opts);
-        av_dict_free(&opts);
-
-        if (ret < 0) {
+        auto stream = findStream(streamName);
+        if (!stream) {
             return false;
         }
+        return stream->pushFrame(frame->data(), frame->dataSize(), frame->timestamp(), regions);
+    }
+
+    bool RTSPServer::reconfigure(const EncoderUpdate &update) {
+        return reconfigure(config_.streamName, update);
+    }
 
-        return avcodec_parameters_from_context(videoStream_->codecpar,
-                                               encoderContext_) >= 0;
+    bool RTSPServer::reconfigure(const std::string &streamName, const EncoderUpdate &update) {
+        auto stream = findStream(streamName);
+        return stream && stream->reconfigure(update);
     }
 
-    bool RTSPServer::configureOutput() {
-        AVDictionary *options = nullptr;
-        if (!setupNetworking(&options)) {
+    bool RTSPServer::initializeServer() {
+        listenSocket_ = net::createTcpListener(config_.address, config_.port, 128);
+        if (listenSocket_ == net::INVALID_SOCKET_HANDLE) {
             return false;
         }
 
-        // Abrir saída
-        if (!(formatContext_->oformat->flags & AVFMT_NOFILE)) {
-            if (avio_open(&formatContext_->pb,
-                          formatContext_->url,
-                          AVIO_FLAG_WRITE) < 0) {
-                av_dict_free(&options);
-                return false;
-            }
+        // Sockets UDP compartilhados por todos os clientes RTP/UDP
+        rtpSocket_ = net::createUdpSocket(config_.address, 0);
+        rtcpSocket_ = net::createUdpSocket(config_.address, 0);
+        if (rtpSocket_ == net::INVALID_SOCKET_HANDLE ||
+            rtcpSocket_ == net::INVALID_SOCKET_HANDLE) {
+            return false;
         }
 
-        // Escrever header
-        int ret = avformat_write_header(formatContext_, &options);
-        av_dict_free(&options);
-
-        return ret >= 0;
+        return setupNetworking(rtpSocket_) && setupNetworking(rtcpSocket_);
     }
 
-    bool RTSPServer::setupNetworking(AVDictionary **options) {
-        // Configurar protocolo de transporte
-        av_dict_set(options, "rtsp_transport",
-                    config_.useTCP ? "tcp" : "udp", 0);
-
+    bool RTSPServer::setupNetworking(net::SocketHandle socket) {
         // Configurar buffer
-        av_dict_set_int(options, "buffer_size",
-                        config_.network.bufferSize, 0);
-
-        // Configurar timeout
-        av_dict_set_int(options, "timeout",
-                        config_.network.timeout * 1000000, 0);
+        net::setSendBufferSize(socket, config_.network.bufferSize);
 
-        // Configurar multicast se necessário
-        if (config_.network.enableMulticast) {
-            av_dict_set(options, "ttl",
-                        std::to_string(config_.network.multicastTTL).c_str(), 0);
-            av_dict_set(options, "mcast_rate",
-                        std::to_string(config_.network.maxBitrate).c_str(), 0);
+        // Configurar QoS
+        if (config_.network.qos.enabled) {
+            net::setTypeOfService(socket, config_.network.qos.dscp);
         }
 
         return true;
     }
 
+    void RTSPServer::shutdownNetworking() {
+        net::closeSocket(listenSocket_);
+        net::closeSocket(rtpSocket_);
+        net::closeSocket(rtcpSocket_);
+        listenSocket_ = rtpSocket_ = rtcpSocket_ = net::INVALID_SOCKET_HANDLE;
+    }
+
     void RTSPServer::serverLoop() {
-        AVPacket *packet = av_packet_alloc();
-        int64_t pts = 0;
-        auto lastStatsUpdate = std::chrono::steady_clock::now();
-        auto startTime = std::chrono::steady_clock::now();
+        std::vector<pollfd> fds;
+        std::vector<std::shared_ptr<RTSPSession>> polled;
+        const auto timeout = std::chrono::seconds(config_.network.timeout);
 
         while (isRunning_) {
-            AVFrame *frame = nullptr; {
-                std::lock_guard<std::mutex> lock(frameMutex_);
-                if (!frameQueue_.empty()) {
-                    frame = frameQueue_.front();
-                    frameQueue_.pop();
+            fds.clear();
+            polled.clear();
+
+            fds.push_back(pollfd{listenSocket_, POLLIN, 0});
+            fds.push_back(pollfd{rtcpSocket_, POLLIN, 0});
+#ifndef _WIN32
+            fds.push_back(pollfd{wakeupPipe_[0], POLLIN, 0});
+#endif
+            const size_t firstSession = fds.size();
+
+            for (auto &entry: sessions_) {
+                short events = POLLIN;
+                if (entry.second->wantsWrite()) {
+                    events |= POLLOUT;
                 }
+                fds.push_back(pollfd{entry.first, events, 0});
+                polled.push_back(entry.second);
             }
 
-            if (frame) {
-                frame->pts = pts++;
+#ifdef _WIN32
+            int ready = poll(fds.data(), static_cast<ULONG>(fds.size()), 10);
+#else
+            int ready = poll(fds.data(), fds.size(), 100);
+#endif
+            if (ready < 0) {
+                continue;
+            }
 
-                if (encodeAndTransmit(frame)) {
-                    std::lock_guard<std::mutex> statsLock(statsMutex_);
-                    stats_.framesTransferred++;
+#ifndef _WIN32
+            if (fds[2].revents & POLLIN) {
+                char drain[64];
+                while (read(wakeupPipe_[0], drain, sizeof(drain)) > 0) {
                 }
+            }
+#endif
 
-                av_frame_free(&frame);
-
-                // Atualizar estatísticas a cada segundo
-                auto now = std::chrono::steady_clock::now();
-                if (std::chrono::duration_cast<std::chrono::seconds>(
-                        now - lastStatsUpdate).count() >= 1) {
-                    updateStats();
-                    lastStatsUpdate = now;
-                }
-            } else {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (fds[0].revents & POLLIN) {
+                acceptConnections();
+            }
+            if (fds[1].revents & POLLIN) {
+                receiveRtcp();
             }
-        }
 
-        // Escrever trailer
-        av_write_trailer(formatContext_);
-        av_packet_free(&packet);
-    }
+            auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < polled.size(); i++) {
+                auto &session = polled[i];
+                short revents = fds[firstSession + i].revents;
 
-    bool RTSPServer::encodeAndTransmit(AVFrame *frame) {
-        if (!encoderContext_ || !frame) {
-            return false;
-        }
+                bool keep = !session->isClosed();
+                if (keep && (revents & POLLIN)) {
+                    keep = session->onReadable();
+                }
+                if (keep && (revents & POLLOUT)) {
+                    keep = session->onWritable();
+                }
+                if (keep && (revents & POLLERR)) {
+                    keep = session->onError();
+                }
+                if (keep && (revents & (POLLHUP | POLLNVAL))) {
+                    keep = false;
+                }
+                if (keep && now - session->lastActivity() > timeout) {
+                    keep = false; // Cliente sem keep-alive
+                }
 
-        if (avcodec_send_frame(encoderContext_, frame) < 0) {
-            return false;
+                if (!keep) {
+                    closeSession(session);
+                }
+            }
         }
+    }
 
-        AVPacket *packet = av_packet_alloc();
-        bool success = false;
-
-        while (avcodec_receive_packet(encoderContext_, packet) >= 0) {
-            packet->stream_index = videoStream_->index;
-
-            // Converter timestamps
-            av_packet_rescale_ts(packet,
-                                 encoderContext_->time_base,
-                                 videoStream_->time_base);
+    void RTSPServer::acceptConnections() {
+        while (true) {
+            sockaddr_in peer{};
+            socklen_t length = sizeof(peer);
+            net::SocketHandle client = accept(listenSocket_,
+                                              reinterpret_cast<sockaddr *>(&peer), &length);
+            if (client == net::INVALID_SOCKET_HANDLE) {
+                break;
+            }
 
-            if (av_interleaved_write_frame(formatContext_, packet) >= 0) {
-                std::lock_guard<std::mutex> lock(statsMutex_);
-                stats_.bytesTransferred += packet->size;
-                success = true;
+            if (!net::setNonBlocking(client)) {
+                net::closeSocket(client);
+                continue;
             }
+            net::setNoDelay(client);
+            setupNetworking(client);
 
-            av_packet_unref(packet);
+            auto session = std::make_shared<RTSPSession>(client, peer, *this);
+            std::lock_guard<std::mutex> lock(sessionsMutex_);
+            sessions_[client] = session;
         }
-
-        av_packet_free(&packet);
-        return success;
     }
 
-    void RTSPServer::updateStats() {
-        std::lock_guard<std::mutex> lock(statsMutex_);
+    void RTSPServer::receiveRtcp() {
+        uint8_t buffer[1500];
 
-        auto now = std::chrono::steady_clock::now();
-        auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
-            now - std::chrono::steady_clock::time_point()).count();
-
-        stats_.uptime = uptime;
+        while (true) {
+            sockaddr_in peer{};
+            socklen_t length = sizeof(peer);
+            int received = recvfrom(rtcpSocket_, reinterpret_cast<char *>(buffer), sizeof(buffer), 0,
+                                    reinterpret_cast<sockaddr *>(&peer), &length);
+            if (received <= 0) {
+                break;
+            }
 
-        // Calcular FPS atual
-        if (uptime > 0) {
-            stats_.currentFps = static_cast<float>(stats_.framesTransferred) / uptime;
+            // Receiver reports dos clientes UDP chegam na porta RTCP do servidor
+            for (auto &entry: sessions_) {
+                if (entry.second->isRtcpPeer(peer)) {
+                    entry.second->onRtcp(buffer, static_cast<size_t>(received));
+                    break;
+                }
+            }
         }
-
-        // Calcular bitrate atual
-        stats_.currentBitrate = (stats_.bytesTransferred * 8) / uptime;
-
-        // Outros campos são atualizados durante a operação
     }
 
-    void RTSPServer::resetStats() {
-        std::lock_guard<std::mutex> lock(statsMutex_);
-        stats_ = ServerStats{};
+    void RTSPServer::closeSession(const std::shared_ptr<RTSPSession> &session) {
+        session->close();
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        sessions_.erase(session->socket());
     }
 
-    void RTSPServer::clearFrameQueue() {
-        std::lock_guard<std::mutex> lock(frameMutex_);
-        while (!frameQueue_.empty()) {
-            AVFrame *frame = frameQueue_.front();
-            frameQueue_.pop();
-            av_frame_free(&frame);
+    void RTSPServer::closeAllSessions() {
+        std::map<net::SocketHandle, std::shared_ptr<RTSPSession>> sessions; {
+            std::lock_guard<std::mutex> lock(sessionsMutex_);
+            sessions.swap(sessions_);
+        }
+        for (auto &entry: sessions) {
+            entry.second->close();
         }
     }
 
-    AVFrame *RTSPServer::createVideoFrame(int width, int height, AVPixelFormat pixFormat) {
-        AVFrame *frame = av_frame_alloc();
-        if (!frame) {
-            return nullptr;
+    void RTSPServer::wakeup() {
+#ifndef _WIN32
+        if (wakeupPipe_[1] >= 0) {
+            char signal = 1;
+            (void) !write(wakeupPipe_[1], &signal, 1);
         }
+#endif
+    }
 
-        frame->format = pixFormat;
-        frame->width = width;
-        frame->height = height;
+    std::shared_ptr<ServerStream> RTSPServer::findStream(const std::string &name) const {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        auto it = streams_.find(name);
+        return it != streams_.end() ? it->second : nullptr;
+    }
 
-        // Alocar buffers para o frame
-        if (av_frame_get_buffer(frame, 32) < 0) {
-            av_frame_free(&frame);
-            return nullptr;
-        }
+    bool RTSPServer::canAcceptPlayer() const {
+        return playingSessions_ < config_.maxClients;
+    }
 
-        // Garantir que o frame seja gravável
-        if (av_frame_make_writable(frame) < 0) {
-            av_frame_free(&frame);
-            return nullptr;
+    void RTSPServer::notifyClientConnected(const std::string &address) {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
+        if (clientConnectedCallback_) {
+            clientConnectedCallback_(address);
         }
-
-        return frame;
     }
 
-    bool RTSPServer::convertFrame(const uint8_t *data, int size, AVFrame *frame) {
-        if (!data || !frame || size <= 0) {
-            return false;
+    void RTSPServer::notifyClientDisconnected(const std::string &address) {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
+        if (clientDisconnectedCallback_) {
+            clientDisconnectedCallback_(address);
         }
+    }
 
-        // Assumindo entrada BGR24 e saída YUV420P
-        const int in_linesize = frame->width * 3; // BGR24 = 3 bytes por pixel
-
-        // Conversão de cor usando tabelas de lookup (mais rápido que cálculos diretos)
-        static const int YR = 77; // 0.299 * 256
-        static const int YG = 150; // 0.587 * 256
-        static const int YB = 29; // 0.114 * 256
-        static const int UR = -43; // -0.169 * 256
-        static const int UG = -84; // -0.331 * 256
-        static const int UB = 127; // 0.500 * 256
-        static const int VR = 127; // 0.500 * 256
-        static const int VG = -106; // -0.419 * 256
-        static const int VB = -21; // -0.081 * 256
-
-        // Y plane
-        for (int y = 0; y < frame->height; y++) {
-            for (int x = 0; x < frame->width; x++) {
-                const uint8_t *pixel = data + y * in_linesize + x * 3;
-                uint8_t b = pixel[0];
-                uint8_t g = pixel[1];
-                uint8_t r = pixel[2];
-
-                frame->data[0][y * frame->linesize[0] + x] = static_cast<uint8_t>(
-                    (YR * r + YG * g + YB * b + 128) >> 8);
+    RTSPServer::ServerStats RTSPServer::getStats() const {
+        std::vector<std::shared_ptr<ServerStream>> streams; {
+            std::lock_guard<std::mutex> lock(streamsMutex_);
+            for (const auto &entry: streams_) {
+                streams.push_back(entry.second);
             }
         }
 
-        // U and V planes (chroma subsampling 4:2:0)
-        for (int y = 0; y < frame->height / 2; y++) {
-            for (int x = 0; x < frame->width / 2; x++) {
-                int sum_r = 0, sum_g = 0, sum_b = 0;
-
-                // Soma dos 4 pixels adjacentes
-                for (int dy = 0; dy < 2; dy++) {
-                    for (int dx = 0; dx < 2; dx++) {
-                        const uint8_t *pixel = data +
-                                               (y * 2 + dy) * in_linesize +
-                                               (x * 2 + dx) * 3;
-                        sum_b += pixel[0];
-                        sum_g += pixel[1];
-                        sum_r += pixel[2];
-                    }
-                }
-
-                // Média dos 4 pixels
-                int r = sum_r / 4;
-                int g = sum_g / 4;
-                int b = sum_b / 4;
+        ServerStats total{};
+        ServerStream::LatencySnapshots latency;
+        for (const auto &stream: streams) {
+            stream->collectLatency(latency);
+            ServerStats stats = stream->getStats();
+            total.currentFps += stats.currentFps;
+            total.currentBitrate += stats.currentBitrate;
+            total.bytesTransferred += stats.bytesTransferred;
+            total.framesTransferred += stats.framesTransferred;
+            total.uptime = std::max(total.uptime, stats.uptime);
+            total.avgLatency = std::max(total.avgLatency, stats.avgLatency);
+            total.droppedFrames += stats.droppedFrames;
+            total.staticFrames += stats.staticFrames;
+            total.targetBitrate += stats.targetBitrate;
+            total.targetFps = std::max(total.targetFps, stats.targetFps);
+            total.encoderLoad = std::max(total.encoderLoad, stats.encoderLoad);
+            total.governorLevel = std::max(total.governorLevel, stats.governorLevel);
+            total.governorTransitions += stats.governorTransitions;
+        }
+
+        // FPS médio por stream
+        if (!streams.empty()) {
+            total.currentFps /= static_cast<float>(streams.size());
+        }
+        total.convertLatency = latency.convert.summary();
+        total.encodeLatency = latency.encode.summary();
+        total.writeLatency = latency.write.summary();
+        total.connectedClients = playingSessions_;
+        total.sendCalls = static_cast<int64_t>(egressCounters_.syscalls.load());
+        total.sentPackets = static_cast<int64_t>(egressCounters_.packets.load());
+        return total;
+    }
 
-                // U plane (Cb)
-                frame->data[1][y * frame->linesize[1] + x] = static_cast<uint8_t>(
-                    ((UR * r + UG * g + UB * b + 128) >> 8) + 128);
+    RTSPServer::ServerStats RTSPServer::getStats(const std::string &streamName) const {
+        auto stream = findStream(streamName);
+        return stream ? stream->getStats() : ServerStats{};
+    }
 
-                // V plane (Cr)
-                frame->data[2][y * frame->linesize[2] + x] = static_cast<uint8_t>(
-                    ((VR * r + VG * g + VB * b + 128) >> 8) + 128);
+    std::vector<RTSPServer::ClientStats> RTSPServer::getClientStats() const {
+        std::vector<std::shared_ptr<RTSPSession>> sessions; {
+            std::lock_guard<std::mutex> lock(sessionsMutex_);
+            for (const auto &entry: sessions_) {
+                sessions.push_back(entry.second);
             }
         }
 
-        return true;
+        std::vector<ClientStats> stats;
+        for (const auto &session: sessions) {
+            if (session->isPlaying()) {
+                stats.push_back(session->getStats());
+            }
+        }
+        return stats;
     }
 
-    RTSPServer::ServerStats RTSPServer::getStats() const {
-        std::lock_guard<std::mutex> lock(statsMutex_);
-        return stats_;
+    void RTSPServer::resetLatency() {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        for (const auto &entry: streams_) {
+            entry.second->resetLatency();
+        }
     }
 
     void RTSPServer::setClientConnectedCallback(ClientConnectedCallback callback) {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
         clientConnectedCallback_ = std::move(callback);
     }
 
+    void RTSPServer::setFrameTraceCallback(FrameTraceCallback callback) {
+        std::lock_guard<std::mutex> lock(streamsMutex_);
+        frameTraceCallback_ = std::move(callback);
+        for (const auto &entry: streams_) {
+            entry.second->setFrameTraceCallback(frameTraceCallback_);
+        }
+    }
+
     void RTSPServer::setClientDisconnectedCallback(ClientDisconnectedCallback callback) {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
         clientDisconnectedCallback_ = std::move(callback);
     }
 } // namespace turbovision
@@ -0,0 +1,618 @@
+#include "turbovision/server/rtsp_session.hpp"
+#include "turbovision/server/rtcp.hpp"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace turbovision {
+    namespace {
+        // Tamanho máximo de um cabeçalho de requisição RTSP
+        const size_t MAX_REQUEST_SIZE = 64 * 1024;
+
+        std::string toLower(std::string value) {
+            std::transform(value.begin(), value.end(), value.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return value;
+        }
+
+        std::string trim(const std::string &value) {
+            size_t begin = value.find_first_not_of(" \t");
+            if (begin == std::string::npos) {
+                return std::string();
+            }
+            size_t end = value.find_last_not_of(" \t\r");
+            return value.substr(begin, end - begin + 1);
+        }
+
+        // Lê um par "a-b" de um parâmetro do cabeçalho Transport
+        bool parseRange(const std::string &transport, const std::string &key, int &first, int &second) {
+            size_t pos = transport.find(key + "=");
+            if (pos == std::string::npos) {
+                return false;
+            }
+            pos += key.size() + 1;
+            first = std::atoi(transport.c_str() + pos);
+            size_t dash = transport.find('-', pos);
+            size_t end = transport.find(';', pos);
+            if (dash != std::string::npos && (end == std::string::npos || dash < end)) {
+                second = std::atoi(transport.c_str() + dash + 1);
+            } else {
+                second = first + 1;
+            }
+            return true;
+        }
+
+        int64_t steadyNow() {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+    }
+
+    RTSPSession::RTSPSession(net::SocketHandle socket, const sockaddr_in &peer, RTSPServer &server)
+        : server_(server)
+          , socket_(socket)
+          , peer_(peer)
+          , address_(net::addressToString(peer))
+          , sessionId_(generateSessionId())
+          , transport_(Transport::NONE)
+          , clientRtpAddress_{}
+          , clientRtcpAddress_{}
+          , rtpChannel_(0)
+          , rtcpChannel_(1)
+          , playing_(false)
+          , closed_(false)
+          , waitingKeyframe_(true)
+          , lastActivity_(steadyNow())
+          , lastDrained_(std::chrono::steady_clock::now())
+          , lastKeyframeRequest_()
+          , droppedPackets_(0)
+          , resyncs_(0)
+          , rtt_(-1.0)
+          , fractionLost_(0.0)
+          , jitter_(0.0) {
+    }
+
+    RTSPSession::~RTSPSession() {
+        close();
+        net::closeSocket(socket_);
+    }
+
+    bool RTSPSession::onReadable() {
+        char buffer[4096];
+
+        while (true) {
+            int received = recv(socket_, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                inBuffer_.append(buffer, received);
+                continue;
+            }
+            if (received == 0) {
+                return false; // Conexão encerrada pelo cliente
+            }
+            if (net::lastErrorWouldBlock()) {
+                break;
+            }
+            return false;
+        }
+
+        touch();
+        return parseRequests();
+    }
+
+    bool RTSPSession::onWritable() {
+        std::lock_guard<std::mutex> lock(outMutex_);
+        return flushLocked() && enforceQueueLimits(std::chrono::steady_clock::now());
+    }
+
+    bool RTSPSession::wantsWrite() const {
+        std::lock_guard<std::mutex> lock(outMutex_);
+        return !outQueue_.empty();
+    }
+
+    bool RTSPSession::onError() {
+        std::lock_guard<std::mutex> lock(outMutex_);
+
+        // Com MSG_ZEROCOPY o POLLERR também sinaliza notificações de envio
+        outQueue_.processCompletions(socket_);
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(socket_, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&error), &length) < 0) {
+            return false;
+        }
+        return error == 0;
+    }
+
+    void RTSPSession::sendPackets(const RtpPacketBatch &packets, UdpEgress &udp) {
+        if (!playing_ || closed_) {
+            return;
+        }
+
+        bool pending = false; {
+            std::lock_guard<std::mutex> lock(outMutex_);
+            // Multicast é enviado uma única vez pelo ServerStream
+            if (closed_ || transport_ == Transport::MULTICAST) {
+                return;
+            }
+
+            RtpPacketBatch rtp;
+            RtpPacketBatch rtcp;
+            for (const auto &packet: packets) {
+                // Aguardar o início de um keyframe antes de enviar mídia
+                if (waitingKeyframe_ && !packet->rtcp) {
+                    if (!packet->keyframe || !packet->frameStart) {
+                        if (resyncs_ > 0) {
+                            droppedPackets_++;
+                        }
+                        continue;
+                    }
+                    waitingKeyframe_ = false;
+                }
+
+                if (transport_ == Transport::TCP) {
+                    // Cabeçalho interleaved: '$', canal e tamanho (RFC 2326, 10.12)
+                    outQueue_.pushPacket(packet, static_cast<uint8_t>(packet->rtcp ? rtcpChannel_ : rtpChannel_));
+                } else if (transport_ == Transport::UDP) {
+                    (packet->rtcp ? rtcp : rtp).push_back(packet);
+                }
+            }
+
+            if (transport_ == Transport::UDP) {
+                // Enviados junto com os demais clientes em UdpEgress::flush()
+                udp.add(server_.rtpSocket_, clientRtpAddress_, rtp.data(), rtp.size());
+                udp.add(server_.rtcpSocket_, clientRtcpAddress_, rtcp.data(), rtcp.size());
+            } else if (transport_ == Transport::TCP) {
+                if (!flushLocked() || !enforceQueueLimits(std::chrono::steady_clock::now())) {
+                    closed_ = true;
+                    net::shutdownSocket(socket_);
+                    return;
+                }
+                pending = !outQueue_.empty();
+            }
+        }
+
+        // Restante será enviado quando o socket ficar disponível para escrita
+        if (pending) {
+            server_.wakeup();
+        }
+    }
+
+    void RTSPSession::close() {
+        {
+            std::lock_guard<std::mutex> lock(outMutex_);
+            if (!closed_.exchange(true)) {
+                net::shutdownSocket(socket_);
+            }
+        }
+        stopPlaying();
+    }
+
+    std::chrono::steady_clock::time_point RTSPSession::lastActivity() const {
+        return std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(lastActivity_.load()));
+    }
+
+    bool RTSPSession::parseRequests() {
+        while (!inBuffer_.empty() && !closed_) {
+            // Dados interleaved enviados pelo cliente (ex.: RTCP receiver reports)
+            if (inBuffer_[0] == '$') {
+                if (inBuffer_.size() < 4) {
+                    break;
+                }
+                size_t length = (static_cast<uint8_t>(inBuffer_[2]) << 8) |
+                                static_cast<uint8_t>(inBuffer_[3]);
+                if (inBuffer_.size() < 4 + length) {
+                    break;
+                }
+                if (static_cast<uint8_t>(inBuffer_[1]) == rtcpChannel_) {
+                    onRtcp(reinterpret_cast<const uint8_t *>(inBuffer_.data()) + 4, length);
+                }
+                inBuffer_.erase(0, 4 + length);
+                continue;
+            }
+
+            size_t headerEnd = inBuffer_.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) {
+                return inBuffer_.size() <= MAX_REQUEST_SIZE;
+            }
+
+            Request request;
+            std::istringstream stream(inBuffer_.substr(0, headerEnd));
+            std::string line;
+
+            std::getline(stream, line);
+            std::istringstream requestLine(line);
+            std::string version;
+            requestLine >> request.method >> request.uri >> version;
+            if (request.method.empty() || version.compare(0, 5, "RTSP/") != 0) {
+                return false;
+            }
+
+            while (std::getline(stream, line)) {
+                size_t colon = line.find(':');
+                if (colon == std::string::npos) {
+                    continue;
+                }
+                request.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+            }
+
+            size_t contentLength = 0;
+            auto it = request.headers.find("content-length");
+            if (it != request.headers.end()) {
+                contentLength = std::strtoul(it->second.c_str(), nullptr, 10);
+            }
+            if (contentLength > MAX_REQUEST_SIZE) {
+                return false;
+            }
+            if (inBuffer_.size() < headerEnd + 4 + contentLength) {
+                break; // Corpo ainda incompleto
+            }
+
+            request.body = inBuffer_.substr(headerEnd + 4, contentLength);
+            inBuffer_.erase(0, headerEnd + 4 + contentLength);
+
+            it = request.headers.find("cseq");
+            if (it != request.headers.end()) {
+                request.cseq = std::atoi(it->second.c_str());
+            }
+
+            handleRequest(request);
+        }
+
+        return !closed_;
+    }
+
+    void RTSPSession::handleRequest(const Request &request) {
+        if (request.method == "OPTIONS") {
+            handleOptions(request);
+        } else if (request.method == "DESCRIBE") {
+            handleDescribe(request);
+        } else if (request.method == "SETUP") {
+            handleSetup(request);
+        } else if (request.method == "PLAY") {
+            handlePlay(request);
+        } else if (request.method == "TEARDOWN") {
+            handleTeardown(request);
+        } else if (request.method == "GET_PARAMETER" || request.method == "SET_PARAMETER") {
+            // Usados pelos clientes como keep-alive
+            sendResponse(request, 200, "OK");
+        } else {
+            sendResponse(request, 501, "Not Implemented");
+        }
+    }
+
+    void RTSPSession::handleOptions(const Request &request) {
+        sendResponse(request, 200, "OK",
+                     "Public: OPTIONS, DESCRIBE, SETUP, PLAY, TEARDOWN, GET_PARAMETER\r\n");
+    }
+
+    void RTSPSession::handleDescribe(const Request &request) {
+        auto stream = server_.findStream(streamNameFromUri(request.uri));
+        if (!stream) {
+            sendResponse(request, 404, "Not Found");
+            return;
+        }
+
+        std::string base = request.uri;
+        if (base.empty() || base.back() != '/') {
+            base += '/';
+        }
+
+        sendResponse(request, 200, "OK",
+                     "Content-Base: " + base + "\r\n"
+                     "Content-Type: application/sdp\r\n",
+                     stream->getSDP());
+    }
+
+    void RTSPSession::handleSetup(const Request &request) {
+        auto stream = server_.findStream(streamNameFromUri(request.uri));
+        if (!stream) {
+            sendResponse(request, 404, "Not Found");
+            return;
+        }
+
+        if (stream_ && stream_ != stream) {
+            sendResponse(request, 459, "Aggregate Operation Not Allowed");
+            return;
+        }
+
+        if (!server_.canAcceptPlayer()) {
+            sendResponse(request, 453, "Not Enough Bandwidth");
+            return;
+        }
+
+        auto it = request.headers.find("transport");
+        std::string transport = it != request.headers.end() ? it->second : std::string();
+        std::string reply;
+
+        const bool wantsMulticast = transport.find("multicast") != std::string::npos ||
+                                    (stream->isMulticast() &&
+                                     transport.find("client_port=") == std::string::npos &&
+                                     transport.find("interleaved=") == std::string::npos &&
+                                     transport.find("RTP/AVP/TCP") == std::string::npos);
+
+        if (wantsMulticast) {
+            if (!stream->isMulticast()) {
+                sendResponse(request, 461, "Unsupported Transport");
+                return;
+            }
+
+            // Todos os receptores compartilham o grupo anunciado no SDP
+            transport_ = Transport::MULTICAST;
+            reply = "RTP/AVP;multicast;destination=" + stream->multicastAddress() +
+                    ";port=" + std::to_string(stream->multicastPort()) + "-" +
+                    std::to_string(stream->multicastPort() + 1) +
+                    ";ttl=" + std::to_string(stream->multicastTTL());
+        } else if (transport.find("RTP/AVP/TCP") != std::string::npos ||
+                   transport.find("interleaved=") != std::string::npos) {
+            if (!parseRange(transport, "interleaved", rtpChannel_, rtcpChannel_)) {
+                rtpChannel_ = 0;
+                rtcpChannel_ = 1;
+            }
+            transport_ = Transport::TCP;
+            reply = "RTP/AVP/TCP;unicast;interleaved=" + std::to_string(rtpChannel_) + "-" +
+                    std::to_string(rtcpChannel_);
+        } else {
+            int rtpPort = 0;
+            int rtcpPort = 0;
+            if (!parseRange(transport, "client_port", rtpPort, rtcpPort)) {
+                sendResponse(request, 461, "Unsupported Transport");
+                return;
+            }
+
+            clientRtpAddress_ = peer_;
+            clientRtpAddress_.sin_port = htons(static_cast<uint16_t>(rtpPort));
+            clientRtcpAddress_ = peer_;
+            clientRtcpAddress_.sin_port = htons(static_cast<uint16_t>(rtcpPort));
+
+            transport_ = Transport::UDP;
+            reply = "RTP/AVP;unicast;client_port=" + std::to_string(rtpPort) + "-" +
+                    std::to_string(rtcpPort) + ";server_port=" +
+                    std::to_string(net::localPort(server_.rtpSocket_)) + "-" +
+                    std::to_string(net::localPort(server_.rtcpSocket_));
+        }
+
+        stream_ = stream;
+        sendResponse(request, 200, "OK", "Transport: " + reply + "\r\n");
+    }
+
+    void RTSPSession::handlePlay(const Request &request) {
+        if (!stream_ || transport_ == Transport::NONE) {
+            sendResponse(request, 455, "Method Not Valid in This State");
+            return;
+        }
+
+        sendResponse(request, 200, "OK", "Range: npt=0.000-\r\n");
+
+        if (!playing_.exchange(true)) {
+            {
+                std::lock_guard<std::mutex> lock(outMutex_);
+                waitingKeyframe_ = true;
+            }
+            stream_->addSubscriber(shared_from_this());
+            server_.playingSessions_++;
+            server_.notifyClientConnected(address_);
+        }
+    }
+
+    void RTSPSession::handleTeardown(const Request &request) {
+        stopPlaying();
+        sendResponse(request, 200, "OK");
+        close();
+    }
+
+    void RTSPSession::sendResponse(const Request &request, int code, const std::string &reason,
+                                   const std::string &headers, const std::string &body) {
+        std::string response = "RTSP/1.0 " + std::to_string(code) + " " + reason + "\r\n";
+        response += "CSeq: " + std::to_string(request.cseq) + "\r\n";
+        response += "Server: TurboVision\r\n";
+        if (transport_ != Transport::NONE) {
+            response += "Session: " + sessionId_ + ";timeout=" +
+                    std::to_string(server_.config_.network.timeout) + "\r\n";
+        }
+        response += headers;
+        if (!body.empty()) {
+            response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        response += "\r\n";
+        response += body;
+
+        std::lock_guard<std::mutex> lock(outMutex_);
+        outQueue_.pushText(response);
+        if (!flushLocked()) {
+            closed_ = true;
+            net::shutdownSocket(socket_);
+        }
+    }
+
+    void RTSPSession::stopPlaying() {
+        if (!playing_.exchange(false)) {
+            return;
+        }
+
+        if (stream_) {
+            stream_->removeSubscriber(this);
+        }
+        server_.playingSessions_--;
+        server_.notifyClientDisconnected(address_);
+    }
+
+    bool RTSPSession::flushLocked() {
+        return outQueue_.flush(socket_, server_.egressOptions_, server_.egressCounters_);
+    }
+
+    bool RTSPSession::enforceQueueLimits(std::chrono::steady_clock::time_point now) {
+        // Em TCP não há perda: o atraso da fila de saída indica congestionamento
+        if (stream_) {
+            RateController::Feedback feedback;
+            feedback.rtt = rtt_;
+            feedback.queueDelay = outQueue_.empty() ? 0.0 : outQueue_.oldestDelay(now);
+            stream_->onFeedback(feedback);
+        }
+
+        if (outQueue_.empty()) {
+            lastDrained_ = now;
+            return true;
+        }
+
+        const auto &config = server_.config_;
+        if (outQueue_.bytes() > static_cast<size_t>(config.clientQueueBytes) ||
+            outQueue_.oldestDelay(now) > config.clientQueueDelay) {
+            // Cliente atrasado: descarta até o keyframe mais recente para não
+            // acumular latência; sem keyframe na fila espera o próximo
+            bool keyframeKept = false;
+            droppedPackets_ += static_cast<int64_t>(outQueue_.dropUntilKeyframe(keyframeKept));
+            resyncs_++;
+
+            // Um cliente preso não pode forçar keyframes para todos a cada frame
+            if (!keyframeKept) {
+                waitingKeyframe_ = true;
+                if (stream_ && now - lastKeyframeRequest_ > std::chrono::seconds(1)) {
+                    stream_->requestKeyframe();
+                    lastKeyframeRequest_ = now;
+                }
+            }
+        }
+
+        // Cliente que não consegue esvaziar a fila por muito tempo é removido
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - lastDrained_).count() <=
+               config.clientEvictTimeout;
+    }
+
+    bool RTSPSession::isRtcpPeer(const sockaddr_in &address) const {
+        return transport_ == Transport::UDP &&
+               address.sin_addr.s_addr == clientRtcpAddress_.sin_addr.s_addr &&
+               address.sin_port == clientRtcpAddress_.sin_port;
+    }
+
+    void RTSPSession::onRtcp(const uint8_t *data, size_t size) {
+        std::vector<rtcp::ReportBlock> blocks;
+        if (!rtcp::parseReportBlocks(data, size, blocks)) {
+            return;
+        }
+
+        // RTCP do próprio cliente mantém a sessão viva (RFC 2326, 10.2):
+        // clientes UDP podem não mandar GET_PARAMETER
+        touch();
+        if (blocks.empty()) {
+            return;
+        }
+
+        const rtcp::ReportBlock &block = blocks.front();
+        const double rtt = rtcp::roundTripTime(block, rtcp::ntpMiddle32Now());
+        const double clockRate = 90000.0; // Relógio RTP de vídeo
+
+        RateController::Feedback feedback; {
+            std::lock_guard<std::mutex> lock(outMutex_);
+            if (rtt >= 0.0) {
+                // Média móvel exponencial como no SRTT do TCP
+                rtt_ = rtt_ < 0.0 ? rtt : rtt_ * 0.875 + rtt * 0.125;
+            }
+            fractionLost_ = block.fractionLost / 256.0;
+            jitter_ = block.jitter * 1000.0 / clockRate;
+
+            feedback.fractionLost = fractionLost_;
+            feedback.jitter = jitter_;
+            feedback.rtt = rtt_;
+            feedback.queueDelay = outQueue_.empty() ? 0.0 : outQueue_.oldestDelay(std::chrono::steady_clock::now());
+        }
+
+        if (stream_) {
+            stream_->onFeedback(feedback);
+        }
+    }
+
+    RTSPServer::ClientStats RTSPSession::getStats() const {
+        RTSPServer::ClientStats stats{};
+        stats.address = address_;
+        stats.sessionId = sessionId_;
+        stats.streamName = stream_ ? stream_->name() : std::string();
+        switch (transport_) {
+            case Transport::TCP: stats.transport = "TCP"; break;
+            case Transport::UDP: stats.transport = "UDP"; break;
+            case Transport::MULTICAST: stats.transport = "MULTICAST"; break;
+            default: break;
+        }
+
+        std::lock_guard<std::mutex> lock(outMutex_);
+        stats.queueBytes = outQueue_.bytes();
+        stats.queuePackets = outQueue_.size();
+        stats.queueDelay = static_cast<float>(outQueue_.oldestDelay(std::chrono::steady_clock::now()));
+        stats.droppedPackets = droppedPackets_;
+        stats.resyncs = resyncs_;
+        stats.rtt = static_cast<float>(rtt_);
+        stats.fractionLost = static_cast<float>(fractionLost_);
+        stats.jitter = static_cast<float>(jitter_);
+
+#ifdef __linux__
+        // Sem receiver reports em TCP usa o SRTT do kernel
+        if (stats.rtt < 0.0f && transport_ == Transport::TCP) {
+            tcp_info info{};
+            socklen_t length = sizeof(info);
+            if (getsockopt(socket_, IPPROTO_TCP, TCP_INFO, &info, &length) == 0) {
+                stats.rtt = info.tcpi_rtt / 1000.0f;
+            }
+        }
+#endif
+        return stats;
+    }
+
+    void RTSPSession::touch() {
+        lastActivity_ = steadyNow();
+    }
+
+    std::string RTSPSession::streamNameFromUri(const std::string &uri) {
+        std::string path = uri;
+
+        // Remover esquema e host (rtsp://host:porta/)
+        size_t scheme = path.find("://");
+        if (scheme != std::string::npos) {
+            size_t slash = path.find('/', scheme + 3);
+            path = slash != std::string::npos ? path.substr(slash + 1) : std::string();
+        }
+
+        size_t query = path.find('?');
+        if (query != std::string::npos) {
+            path.erase(query);
+        }
+
+        while (!path.empty() && path.front() == '/') {
+            path.erase(0, 1);
+        }
+        while (!path.empty() && path.back() == '/') {
+            path.pop_back();
+        }
+
+        // Remover o controle de trilha usado no SETUP (ex.: /streamid=0)
+        size_t control = path.rfind('/');
+        if (control != std::string::npos) {
+            std::string last = path.substr(control + 1);
+            if (last.compare(0, 9, "streamid=") == 0 || last.compare(0, 8, "trackID=") == 0) {
+                path.erase(control);
+            }
+        }
+
+        return path;
+    }
+
+    std::string RTSPSession::generateSessionId() {
+        static std::mt19937_64 generator{std::random_device{}()};
+        static std::mutex generatorMutex;
+
+        std::lock_guard<std::mutex> lock(generatorMutex);
+        std::ostringstream id;
+        id << std::hex << generator();
+        return id.str();
+    }
+} // namespace turbovision
@@ -0,0 +1,1287 @@
+#include "turbovision/server/server_stream.hpp"
+#include "turbovision/server/rtsp_session.hpp"
+#include "turbovision/core/utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace turbovision {
+    namespace {
+        // Tamanho máximo de um pacote RTP (cabe em um MTU Ethernet)
+        const int RTP_PACKET_SIZE = 1400;
+
+        // Slice que cabe em um pacote RTP (cabeçalho RTP de 12 bytes)
+        const int MAX_SLICE_SIZE = RTP_PACKET_SIZE - 12;
+
+        // Tipos de NAL de fragmentação: FU-A do H.264 (RFC 6184, 5.8) e FU do HEVC (RFC 7798, 4.4.3)
+        const uint8_t NAL_FU_A = 28;
+        const uint8_t HEVC_NAL_FU = 49;
+
+        // Cada degrau de fps ou resolução reduz 1/4
+        const double GOVERNOR_STEP = 0.75;
+
+        int scaledValue(int value, int steps) {
+            return static_cast<int>(value * std::pow(GOVERNOR_STEP, steps));
+        }
+
+        // Frames codificados por tarefa antes de devolver a thread ao pool
+        const int FRAMES_PER_TASK = 4;
+
+        // Base de tempo do encoder (mesma do relógio RTP de vídeo)
+        const AVRational ENCODER_TIME_BASE = {1, 90000};
+
+        // Frames aguardando pacote do encoder com trace ativo (atraso do encoder)
+        const size_t MAX_PENDING_TRACES = 64;
+
+        // Saltos maiores que isso nos timestamps do produtor reiniciam o mapeamento
+        const int64_t TIMESTAMP_DISCONTINUITY = 1000000;
+
+        // Pacote RTP H.264/HEVC que encerra uma NAL: NAL única, agregação ou
+        // último fragmento. Outros codecs só entregam no fim do frame.
+        bool isNalEnd(const uint8_t *packet, int size, AVCodecID codecId) {
+            const int headerSize = 12 + (packet[0] & 0x0F) * 4;
+            if (codecId == AV_CODEC_ID_H264 && size > headerSize + 1) {
+                const uint8_t type = packet[headerSize] & 0x1F;
+                return type != NAL_FU_A || (packet[headerSize + 1] & 0x40) != 0;
+            }
+            if (codecId == AV_CODEC_ID_HEVC && size > headerSize + 2) {
+                const uint8_t type = (packet[headerSize] >> 1) & 0x3F;
+                return type != HEVC_NAL_FU || (packet[headerSize + 2] & 0x40) != 0;
+            }
+            return false;
+        }
+
+        int64_t steadyMicros(std::chrono::steady_clock::time_point time) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        }
+    }
+
+    ServerStream::ServerStream(const std::string &name,
+                               const ServerConfig &config,
+                               const VideoConfig &videoConfig,
+                               std::shared_ptr<HardwareManager> hwManager,
+                               WorkerPool &workerPool,
+                               EgressCounters &egressCounters)
+        : name_(name)
+          , config_(config)
+          , videoConfig_(videoConfig)
+          , hwManager_(std::move(hwManager))
+          , workerPool_(workerPool)
+          , egressOptions_(config.network)
+          , egressCounters_(egressCounters)
+          , multicastSocket_(net::INVALID_SOCKET_HANDLE)
+          , multicastRtpAddress_{}
+          , multicastRtcpAddress_{}
+          , multicastSubscribers_(0)
+          , encodeWidth_(videoConfig.width)
+          , encodeHeight_(videoConfig.height)
+          , encodeFps_(videoConfig.fps)
+          , bitrate_(videoConfig.bitrate)
+          , vbvSize_(config.encoder.vbvSize)
+          , gopSize_(config.encoder.gopSize)
+          , openedGopSize_(config.encoder.gopSize)
+          , gopPosition_(0)
+          , changeDetector_(config.staticThreshold)
+          , basePreset_(0)
+          , presetSteps_(0)
+          , fpsSteps_(0)
+          , scaleSteps_(0)
+          , governorFps_(videoConfig.fps)
+          , governorScale_(0)
+          , updatePending_(false)
+          , outputWidth_(videoConfig.width)
+          , outputHeight_(videoConfig.height)
+          , scaler_(nullptr)
+          , encoderContext_(nullptr)
+          , rtpContext_(nullptr)
+          , videoStream_(nullptr)
+          , isOpen_(false)
+          , scheduled_(false)
+          , forceKeyframe_(false)
+          , tracing_(false)
+          , lastPts_(AV_NOPTS_VALUE)
+          , anchorTimestamp_(AV_NOPTS_VALUE)
+          , anchorPts_(0)
+          , lastTimestamp_(AV_NOPTS_VALUE)
+          , cadenceError_(0)
+          , nextSlotPts_(AV_NOPTS_VALUE)
+          , headerWritten_(false)
+          , currentKeyframe_(false)
+          , frameStartPending_(false)
+          , lastFrames_(0)
+          , lastBytes_(0) {
+        if (config.network.adaptiveBitrate) {
+            RateController::Settings settings;
+            settings.minBitrate = config.network.minBitrate;
+            settings.maxBitrate = std::max(config.network.maxBitrate, config.network.minBitrate);
+            settings.startBitrate = videoConfig.bitrate;
+            settings.minFps = std::min(config.network.minFps, videoConfig.fps);
+            settings.maxFps = videoConfig.fps;
+            settings.interval = config.network.adaptationInterval;
+            rateController_ = std::make_unique<RateController>(settings);
+            bitrate_ = rateController_->bitrate();
+        }
+        resetStats();
+    }
+
+    ServerStream::~ServerStream() {
+        close();
+        clearFrameQueue();
+
+        if (rtpContext_) {
+            if (headerWritten_) {
+                av_write_trailer(rtpContext_);
+            }
+            if (rtpContext_->pb) {
+                av_freep(&rtpContext_->pb->buffer);
+                avio_context_free(&rtpContext_->pb);
+            }
+            avformat_free_context(rtpContext_);
+        }
+
+        if (encoderContext_) {
+            avcodec_free_context(&encoderContext_);
+        }
+
+        net::closeSocket(multicastSocket_);
+
+        if (scaler_) {
+            sws_freeContext(scaler_);
+        }
+    }
+
+    bool ServerStream::open() {
+        if (isOpen_) {
+            return true;
+        }
+
+        if (!setupEncoder() || !setupMulticast() || !setupPacketizer()) {
+            return false;
+        }
+        setupGovernor();
+
+        resetStats();
+        isOpen_ = true;
+        return true;
+    }
+
+    void ServerStream::close() {
+        if (!isOpen_.exchange(false)) {
+            return;
+        }
+
+        clearFrameQueue();
+
+        // Encerrar as sessões que assistiam este stream
+        std::vector<std::shared_ptr<RTSPSession>> subscribers;
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex_);
+            subscribers.swap(subscribers_);
+        }
+        for (auto &session: subscribers) {
+            session->close();
+        }
+    }
+
+    std::string ServerStream::getSDP() const {
+        return sdp_;
+    }
+
+    bool ServerStream::isMulticast() const {
+        return config_.network.enableMulticast;
+    }
+
+    int ServerStream::multicastPort() const {
+        return config_.network.multicastPort;
+    }
+
+    const std::string &ServerStream::multicastAddress() const {
+        return config_.network.multicastAddress;
+    }
+
+    int ServerStream::multicastTTL() const {
+        return config_.network.multicastTTL;
+    }
+
+    bool ServerStream::pushFrame(const uint8_t *frameData, int size, int64_t timestamp,
+                                 const std::vector<RTSPServer::RegionOfInterest> &regions) {
+        if (!isOpen_ || !frameData) {
+            return false;
+        }
+
+        // Entrada BGR24 na geometria declarada em VideoConfig
+        if (size < videoConfig_.width * videoConfig_.height * 3) {
+            return false;
+        }
+        const auto pushed = std::chrono::steady_clock::now();
+
+        AVFrame *frame = nullptr; {
+            std::lock_guard<std::mutex> lock(convertMutex_);
+            frame = createVideoFrame(outputWidth_, outputHeight_, AV_PIX_FMT_YUV420P);
+            if (!frame) {
+                return false;
+            }
+
+            // Resolução codificada diferente da entrada (reconfigure): escala
+            const int64_t convertStart = LatencyHistogram::now();
+            const bool converted = outputWidth_ == videoConfig_.width && outputHeight_ == videoConfig_.height
+                                       ? convertFrame(frameData, size, frame)
+                                       : scaleFrame(frameData, frame);
+            if (!converted) {
+                av_frame_free(&frame);
+                return false;
+            }
+            convertLatency_.recordSince(convertStart);
+        }
+
+        if (config_.encoder.roiEncoding &&
+            !attachRegionsOfInterest(frame, regions, config_.encoder.roiBackgroundOffset,
+                                     videoConfig_.width, videoConfig_.height)) {
+            av_frame_free(&frame);
+            return false;
+        }
+
+        QueuedFrame queued{frame, timestamp, std::chrono::steady_clock::now(), pushed};
+        if (!config_.useFrameTimestamps || queued.timestamp == AV_NOPTS_VALUE) {
+            queued.timestamp = steadyMicros(queued.arrival);
+        } {
+            std::lock_guard<std::mutex> lock(frameMutex_);
+            frameQueue_.push_back(queued);
+
+            // Limitar tamanho da fila
+            while (frameQueue_.size() > static_cast<size_t>(config_.maxQueuedFrames)) {
+                AVFrame *oldFrame = frameQueue_.front().frame;
+                frameQueue_.pop_front();
+                av_frame_free(&oldFrame);
+
+                std::lock_guard<std::mutex> statsLock(statsMutex_);
+                stats_.droppedFrames++;
+            }
+        }
+
+        schedule();
+        return true;
+    }
+
+    bool ServerStream::attachRegionsOfInterest(AVFrame *frame,
+                                               const std::vector<RTSPServer::RegionOfInterest> &regions,
+                                               float backgroundOffset, int sourceWidth, int sourceHeight) {
+        if (regions.empty() || sourceWidth <= 0 || sourceHeight <= 0) {
+            return true;
+        }
+
+        auto toQOffset = [](float offset) {
+            return av_make_q(static_cast<int>(std::clamp(offset, -1.0f, 1.0f) * 1000.0f), 1000);
+        };
+
+        // Coordenadas da entrada escaladas para a resolução codificada;
+        // bottom e right são exclusivos
+        std::vector<AVRegionOfInterest> rois;
+        for (const auto &region: regions) {
+            AVRegionOfInterest roi{};
+            roi.self_size = sizeof(AVRegionOfInterest);
+            roi.left = std::clamp(region.x * frame->width / sourceWidth, 0, frame->width);
+            roi.right = std::clamp((region.x + region.width) * frame->width / sourceWidth, 0, frame->width);
+            roi.top = std::clamp(region.y * frame->height / sourceHeight, 0, frame->height);
+            roi.bottom = std::clamp((region.y + region.height) * frame->height / sourceHeight, 0, frame->height);
+            roi.qoffset = toQOffset(region.qualityOffset);
+            if (roi.right > roi.left && roi.bottom > roi.top) {
+                rois.push_back(roi);
+            }
+        }
+        if (rois.empty()) {
+            return true;
+        }
+
+        // Fundo: o frame inteiro por último, vale só onde nenhuma ROI cobre
+        if (backgroundOffset != 0.0f) {
+            AVRegionOfInterest background{};
+            background.self_size = sizeof(AVRegionOfInterest);
+            background.right = frame->width;
+            background.bottom = frame->height;
+            background.qoffset = toQOffset(backgroundOffset);
+            rois.push_back(background);
+        }
+
+        AVFrameSideData *sideData = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST,
+                                                           rois.size() * sizeof(AVRegionOfInterest));
+        if (!sideData) {
+            return false;
+        }
+        std::memcpy(sideData->data, rois.data(), rois.size() * sizeof(AVRegionOfInterest));
+        return true;
+    }
+
+    bool ServerStream::reconfigure(const RTSPServer::EncoderUpdate &update) {
+        if (!isOpen_ || update.bitrate < 0 || update.vbvSize < 0 || update.gopSize < 0 ||
+            update.fps < 0 || update.width < 0 || update.height < 0 ||
+            update.width % 2 != 0 || update.height % 2 != 0) {
+            return false;
+        }
+
+        // Novos frames já são convertidos na resolução de destino
+        if (update.width > 0 || update.height > 0) {
+            std::lock_guard<std::mutex> lock(convertMutex_);
+            if (update.width > 0) {
+                outputWidth_ = update.width;
+            }
+            if (update.height > 0) {
+                outputHeight_ = update.height;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(updateMutex_);
+        if (update.bitrate > 0) {
+            pendingUpdate_.bitrate = update.bitrate;
+        }
+        if (update.vbvSize > 0) {
+            pendingUpdate_.vbvSize = update.vbvSize;
+        }
+        if (update.gopSize > 0) {
+            pendingUpdate_.gopSize = update.gopSize;
+        }
+        if (update.fps > 0) {
+            pendingUpdate_.fps = update.fps;
+        }
+        if (update.width > 0) {
+            pendingUpdate_.width = update.width;
+        }
+        if (update.height > 0) {
+            pendingUpdate_.height = update.height;
+        }
+        updatePending_ = true;
+        return true;
+    }
+
+    bool ServerStream::applyPendingUpdate(const AVFrame *frame) {
+        RTSPServer::EncoderUpdate update;
+        bool pending; {
+            std::lock_guard<std::mutex> lock(updateMutex_);
+            // fps só muda a dizimação em computePts: vale já, sem reabrir o
+            // encoder nem forçar keyframe
+            if (pendingUpdate_.fps > 0) {
+                encodeFps_ = pendingUpdate_.fps;
+                pendingUpdate_.fps = 0;
+                updatePending_ = pendingUpdate_.bitrate > 0 || pendingUpdate_.vbvSize > 0 ||
+                                 pendingUpdate_.gopSize > 0 || pendingUpdate_.width > 0 ||
+                                 pendingUpdate_.height > 0;
+            }
+            pending = updatePending_;
+            update = pendingUpdate_;
+        }
+
+        if (pending) {
+            const int width = update.width > 0 ? update.width : encodeWidth_;
+            const int height = update.height > 0 ? update.height : encodeHeight_;
+            const bool resize = width != encodeWidth_ || height != encodeHeight_;
+            const bool atKeyframe = forceKeyframe_ || gopPosition_ >= gopSize_;
+
+            // Resolução nova só quando chegar o primeiro frame já convertido;
+            // bitrate, VBV e GOP esperam o próximo keyframe
+            const bool ready = resize ? (frame->width == width && frame->height == height)
+                                      : atKeyframe;
+            if (ready) {
+                {
+                    std::lock_guard<std::mutex> lock(updateMutex_);
+                    pendingUpdate_ = RTSPServer::EncoderUpdate{};
+                    updatePending_ = false;
+                }
+
+                const int64_t previousBitrate = bitrate_;
+                bitrate_ = update.bitrate > 0 ? update.bitrate : bitrate_;
+                vbvSize_ = update.vbvSize > 0 ? update.vbvSize : vbvSize_;
+                gopSize_ = update.gopSize > 0 ? update.gopSize : gopSize_;
+
+                if (resize || gopSize_ > openedGopSize_) {
+                    const int previousWidth = encodeWidth_;
+                    const int previousHeight = encodeHeight_;
+                    encodeWidth_ = width;
+                    encodeHeight_ = height;
+
+                    if (!reopenEncoder()) {
+                        // Mantém o stream vivo com os parâmetros anteriores
+                        std::cerr << "Falha ao reconfigurar o encoder do stream " << name_ << std::endl;
+                        encodeWidth_ = previousWidth;
+                        encodeHeight_ = previousHeight;
+                        bitrate_ = previousBitrate;
+                        gopSize_ = openedGopSize_;
+                        restoreOutputSize(width, height);
+                        if (!reopenEncoder()) {
+                            failStream();
+                        }
+                    }
+                } else {
+                    // Encoders com suporte a reconfiguração dinâmica (x264, NVENC)
+                    // leem os novos valores do contexto no próximo frame
+                    encoderContext_->bit_rate = bitrate_;
+                    encoderContext_->gop_size = gopSize_;
+                    if (vbvSize_ > 0) {
+                        encoderContext_->rc_buffer_size = vbvSize_;
+                        encoderContext_->rc_max_rate = bitrate_;
+                    }
+                    // Intra refresh não usa IDR: os valores valem a partir da próxima onda
+                    if (!config_.encoder.intraRefresh) {
+                        forceKeyframe_ = true;
+                    }
+                }
+            }
+        }
+
+        // Frames convertidos antes da troca de resolução são descartados
+        return encoderContext_ && frame->width == encodeWidth_ && frame->height == encodeHeight_;
+    }
+
+    void ServerStream::restoreOutputSize(int failedWidth, int failedHeight) {
+        // Um reconfigure() posterior já trocou o destino: fica com o mais novo
+        std::lock_guard<std::mutex> lock(convertMutex_);
+        if (outputWidth_ == failedWidth && outputHeight_ == failedHeight) {
+            outputWidth_ = encodeWidth_;
+            outputHeight_ = encodeHeight_;
+        }
+    }
+
+    void ServerStream::failStream() {
+        // Sem encoder nenhum frame seria transmitido: encerra o stream para
+        // que produtor (pushFrame) e clientes percebam
+        std::cerr << "ServerStream::failStream() - Encoder do stream " << name_
+                  << " não reabriu com os parâmetros anteriores; stream encerrado" << std::endl;
+        close();
+    }
+
+    bool ServerStream::reopenEncoder() {
+        // Entrega o que o encoder antigo ainda tiver antes de fechá-lo
+        if (encoderContext_ && avcodec_send_frame(encoderContext_, nullptr) >= 0) {
+            transmitPackets(LatencyHistogram::now());
+        }
+        avcodec_free_context(&encoderContext_);
+
+        if (!setupEncoder()) {
+            avcodec_free_context(&encoderContext_);
+            return false;
+        }
+
+        openedGopSize_ = gopSize_;
+        gopPosition_ = 0;
+        forceKeyframe_ = true;
+        return true;
+    }
+
+    bool ServerStream::setupMulticast() {
+        if (!config_.network.enableMulticast) {
+            return true;
+        }
+
+        if (!net::isMulticastAddress(config_.network.multicastAddress)) {
+            std::cerr << "Endereço multicast inválido: " << config_.network.multicastAddress << std::endl;
+            return false;
+        }
+
+        net::parseAddress(config_.network.multicastAddress, config_.network.multicastPort, multicastRtpAddress_);
+        net::parseAddress(config_.network.multicastAddress, config_.network.multicastPort + 1, multicastRtcpAddress_);
+
+        // Um único socket por stream; o envio independe do número de receptores
+        multicastSocket_ = net::createUdpSocket(config_.network.multicastInterface, 0);
+        if (multicastSocket_ == net::INVALID_SOCKET_HANDLE ||
+            !net::setMulticastOptions(multicastSocket_, config_.network.multicastTTL,
+                                      config_.network.multicastInterface)) {
+            std::cerr << "Falha ao configurar o socket multicast" << std::endl;
+            return false;
+        }
+
+        net::setSendBufferSize(multicastSocket_, config_.network.bufferSize);
+        if (config_.network.qos.enabled) {
+            net::setTypeOfService(multicastSocket_, config_.network.qos.dscp);
+        }
+        return true;
+    }
+
+    void ServerStream::onFeedback(const RateController::Feedback &feedback) {
+        if (rateController_) {
+            rateController_->onFeedback(feedback);
+        }
+    }
+
+    void ServerStream::adaptRate() {
+        RateController::Decision decision;
+        if (!rateController_ || !encoderContext_ ||
+            !rateController_->update(std::chrono::steady_clock::now(), decision)) {
+            return;
+        }
+
+        // Bitrate entra no próximo frame e fps na dizimação, ambos sem keyframe
+        if (decision.bitrate != bitrate_) {
+            bitrate_ = decision.bitrate;
+            encoderContext_->bit_rate = bitrate_;
+            if (vbvSize_ > 0) {
+                encoderContext_->rc_max_rate = bitrate_;
+            }
+        }
+        const int fps = std::min(decision.fps, governorFps_);
+        if (fps != encodeFps_) {
+            RTSPServer::EncoderUpdate update;
+            update.fps = fps;
+            reconfigure(update);
+        }
+
+        std::ostringstream message;
+        message.setf(std::ios::fixed);
+        message.precision(1);
+        message << "Stream " << name_ << ": " << decision.reason
+                << " perda=" << decision.worst.fractionLost * 100.0 << "%"
+                << " jitter=" << decision.worst.jitter << "ms"
+                << " rtt=" << decision.worst.rtt << "ms"
+                << " fila=" << decision.worst.queueDelay << "ms"
+                << " -> " << decision.bitrate / 1000 << " kbps, " << decision.fps << " fps";
+        utils::Logger::log(utils::LogLevel::Info, message.str());
+    }
+
+    void ServerStream::setupGovernor() {
+        if (!config_.encoder.overloadGovernor) {
+            return;
+        }
+
+        // Presets mais rápidos que o atual (sem preset explícito: o padrão do encoder)
+        const CodecBackend::Capabilities &capabilities = codecBackend_->capabilities();
+        const std::string current = !preset_.empty() ? preset_ : capabilities.defaultPreset;
+        auto it = std::find(capabilities.presets.begin(), capabilities.presets.end(), current);
+        basePreset_ = it != capabilities.presets.end() ? static_cast<int>(it - capabilities.presets.begin()) : 0;
+        presetSteps_ = basePreset_;
+
+        fpsSteps_ = 0;
+        while (scaledValue(videoConfig_.fps, fpsSteps_ + 1) >= config_.encoder.governorMinFps) {
+            fpsSteps_++;
+        }
+        scaleSteps_ = 0;
+        while (scaledValue(videoConfig_.height, scaleSteps_ + 1) >= config_.encoder.governorMinHeight) {
+            scaleSteps_++;
+        }
+
+        governor_ = std::make_unique<EncoderGovernor>(presetSteps_ + fpsSteps_ + scaleSteps_);
+    }
+
+    void ServerStream::governEncoder() {
+        if (!governor_ || !encoderContext_ || !governor_->update(std::chrono::steady_clock::now())) {
+            return;
+        }
+
+        // Nível -> degraus de preset, fps e resolução, nessa ordem
+        const int level = governor_->level();
+        const int presetStep = std::min(level, presetSteps_);
+        const int fpsStep = std::clamp(level - presetSteps_, 0, fpsSteps_);
+        const int scaleStep = std::clamp(level - presetSteps_ - fpsSteps_, 0, scaleSteps_);
+
+        if (presetSteps_ > 0) {
+            const std::string preset = codecBackend_->capabilities().presets[static_cast<size_t>(basePreset_ - presetStep)];
+            if (preset != preset_) {
+                // Preset não muda com o encoder aberto
+                const std::string previous = preset_;
+                preset_ = preset;
+                if (!reopenEncoder()) {
+                    std::cerr << "Falha ao trocar o preset do stream " << name_ << " para " << preset << std::endl;
+                    preset_ = previous;
+                    if (!reopenEncoder()) {
+                        failStream();
+                        return;
+                    }
+                }
+            }
+        }
+
+        // Só o degrau que mudou é aplicado, sem desfazer um reconfigure() manual;
+        // o fps vira dizimação em computePts, sem reabrir o encoder
+        RTSPServer::EncoderUpdate update;
+        const int previousFps = governorFps_;
+        governorFps_ = std::max(1, scaledValue(videoConfig_.fps, fpsStep));
+        const int fps = rateController_ ? std::min(rateController_->fps(), governorFps_) : governorFps_;
+        if (governorFps_ != previousFps && fps != encodeFps_) {
+            update.fps = fps;
+        }
+
+        // Resoluções pares, exigidas pelo YUV420P
+        const int width = std::max(2, scaledValue(videoConfig_.width, scaleStep) & ~1);
+        const int height = std::max(2, scaledValue(videoConfig_.height, scaleStep) & ~1);
+        if (scaleStep != governorScale_) {
+            governorScale_ = scaleStep;
+            update.width = width;
+            update.height = height;
+        }
+        if (update.fps > 0 || update.width > 0) {
+            reconfigure(update);
+        }
+
+        std::ostringstream message;
+        message.setf(std::ios::fixed);
+        message.precision(2);
+        message << "Stream " << name_ << ": carga do encoder " << governor_->load()
+                << " -> nível " << level << " (preset " << (preset_.empty() ? "padrão" : preset_)
+                << ", " << fps << " fps, " << width << "x" << height << ")";
+        utils::Logger::log(utils::LogLevel::Info, message.str());
+    }
+
+    void ServerStream::addSubscriber(const std::shared_ptr<RTSPSession> &session) {
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex_);
+            subscribers_.push_back(session);
+            if (session->transport() == RTSPSession::Transport::MULTICAST) {
+                multicastSubscribers_++;
+            }
+        }
+
+        // Novo cliente precisa de um keyframe para começar a decodificar
+        forceKeyframe_ = true;
+    }
+
+    void ServerStream::removeSubscriber(const RTSPSession *session) {
+        std::lock_guard<std::mutex> lock(subscribersMutex_);
+        auto it = std::find_if(subscribers_.begin(), subscribers_.end(),
+                               [session](const std::shared_ptr<RTSPSession> &s) {
+                                   return s.get() == session;
+                               });
+        if (it == subscribers_.end()) {
+            return;
+        }
+
+        if ((*it)->transport() == RTSPSession::Transport::MULTICAST) {
+            multicastSubscribers_--;
+        }
+        subscribers_.erase(it);
+    }
+
+    size_t ServerStream::subscriberCount() const {
+        std::lock_guard<std::mutex> lock(subscribersMutex_);
+        return subscribers_.size();
+    }
+
+    bool ServerStream::setupEncoder() {
+        // Backend escolhido uma vez; reaberturas mantêm o mesmo encoder
+        const bool hardwareAvailable = hwManager_ && hwManager_->isHardwareAvailable();
+        if (!codecBackend_) {
+            codecBackend_ = CodecBackend::create(config_.encoder.encoder, hardwareAvailable);
+            if (!codecBackend_) {
+                return false;
+            }
+            logEncoderSelection();
+        }
+        const AVCodec *codec = codecBackend_->codec();
+
+        // Configurar encoder
+        encoderContext_ = avcodec_alloc_context3(codec);
+        if (!encoderContext_) {
+            return false;
+        }
+
+        // Configurações básicas
+        encoderContext_->width = encodeWidth_;
+        encoderContext_->height = encodeHeight_;
+        encoderContext_->time_base = ENCODER_TIME_BASE;
+        encoderContext_->framerate = AVRational{encodeFps_, 1};
+        encoderContext_->bit_rate = bitrate_;
+        encoderContext_->gop_size = gopSize_;
+        if (vbvSize_ > 0) {
+            encoderContext_->rc_buffer_size = vbvSize_;
+            encoderContext_->rc_max_rate = bitrate_;
+        }
+        encoderContext_->pix_fmt = AV_PIX_FMT_YUV420P;
+
+        // Configurar hardware
+        if (hardwareAvailable && codecBackend_->capabilities().hardware) {
+            encoderContext_->hw_device_ctx = av_buffer_ref(hwManager_->getContext());
+        }
+
+        // Opções do backend: Advanced, perfil de baixa latência, intra
+        // refresh, ROIs e slices do tamanho de um pacote RTP
+        if (preset_.empty()) {
+            preset_ = codecBackend_->selectPreset(config_.encoder);
+        }
+        AVDictionary *opts = nullptr;
+        codecBackend_->configure(encoderContext_, &opts, config_.encoder, preset_, MAX_SLICE_SIZE);
+
+        int ret = avcodec_open2(encoderContext_, codec, &opts);
+        av_dict_free(&opts);
+
+        return ret >= 0;
+    }
+
+    void ServerStream::logEncoderSelection() const {
+        const CodecBackend::Capabilities &capabilities = codecBackend_->capabilities();
+        std::ostringstream message;
+        message << "Stream " << name_ << ": encoder " << capabilities.encoder;
+        if (capabilities.encoder != config_.encoder.encoder) {
+            message << " (fallback de " << config_.encoder.encoder << ")";
+        }
+        if (config_.encoder.intraRefresh && !capabilities.intraRefresh) {
+            message << ", sem intra refresh";
+        }
+        if (config_.encoder.roiEncoding && !capabilities.regionsOfInterest) {
+            message << ", sem ROIs";
+        }
+        utils::Logger::log(utils::LogLevel::Info, message.str());
+    }
+
+    bool ServerStream::setupPacketizer() {
+        // Muxer RTP sem destino de rede: os pacotes são capturados pelo
+        // callback de escrita e distribuídos para os assinantes. Com multicast
+        // a URL só define o grupo, a porta e o TTL anunciados no SDP.
+        std::string url = "rtp://0.0.0.0";
+        if (isMulticast()) {
+            url = "rtp://" + config_.network.multicastAddress + ":" +
+                  std::to_string(config_.network.multicastPort) +
+                  "?ttl=" + std::to_string(config_.network.multicastTTL);
+        }
+        avformat_alloc_output_context2(&rtpContext_, nullptr, "rtp", url.c_str());
+        if (!rtpContext_) {
+            return false;
+        }
+
+        av_dict_set(&rtpContext_->metadata, "title", name_.c_str(), 0);
+
+        videoStream_ = avformat_new_stream(rtpContext_, nullptr);
+        if (!videoStream_) {
+            return false;
+        }
+
+        if (avcodec_parameters_from_context(videoStream_->codecpar, encoderContext_) < 0) {
+            return false;
+        }
+        videoStream_->time_base = encoderContext_->time_base;
+
+        auto *ioBuffer = static_cast<unsigned char *>(av_malloc(RTP_PACKET_SIZE));
+        if (!ioBuffer) {
+            return false;
+        }
+
+        rtpContext_->pb = avio_alloc_context(ioBuffer, RTP_PACKET_SIZE, 1, this,
+                                             nullptr, &ServerStream::writeRtpPacket, nullptr);
+        if (!rtpContext_->pb) {
+            av_free(ioBuffer);
+            return false;
+        }
+        rtpContext_->pb->max_packet_size = RTP_PACKET_SIZE;
+        rtpContext_->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+        if (avformat_write_header(rtpContext_, nullptr) < 0) {
+            return false;
+        }
+        headerWritten_ = true;
+
+        char sdp[4096] = {0};
+        if (av_sdp_create(&rtpContext_, 1, sdp, sizeof(sdp)) < 0) {
+            return false;
+        }
+        sdp_ = sdp;
+
+        return true;
+    }
+
+    void ServerStream::schedule() {
+        if (scheduled_.exchange(true)) {
+            return; // Já existe uma tarefa pendente para este stream
+        }
+
+        auto self = shared_from_this();
+        if (!workerPool_.post([self] { self->processQueue(); })) {
+            scheduled_ = false;
+        }
+    }
+
+    void ServerStream::processQueue() {
+        for (int processed = 0; processed < FRAMES_PER_TASK && isOpen_; processed++) {
+            QueuedFrame queued{nullptr, 0, {}, {}};
+            int skipped = 0; {
+                std::lock_guard<std::mutex> lock(frameMutex_);
+                if (frameQueue_.empty()) {
+                    break;
+                }
+
+                // Fila acima da meta de latência: pula para o frame mais novo
+                const auto now = std::chrono::steady_clock::now();
+                if (config_.latencyTarget > 0 &&
+                    now - frameQueue_.front().arrival > std::chrono::milliseconds(config_.latencyTarget)) {
+                    while (frameQueue_.size() > 1) {
+                        av_frame_free(&frameQueue_.front().frame);
+                        frameQueue_.pop_front();
+                        skipped++;
+                    }
+                }
+
+                queued = frameQueue_.front();
+                frameQueue_.pop_front();
+            }
+
+            // Frames pulados por atraso indicam que o encoder não acompanha
+            if (governor_ && skipped > 0) {
+                governor_->addMissed(skipped);
+            }
+
+            AVFrame *frame = queued.frame;
+            int64_t pts = 0;
+            if (!applyPendingUpdate(frame) || !computePts(queued.timestamp, pts)) {
+                skipped++; // Resolução antiga ou adiantado em relação à cadência
+                av_frame_free(&frame);
+            } else if (isStatic(queued)) {
+                // O slot de pts é consumido: o próximo frame codificado mantém
+                // o timestamp RTP correto
+                av_frame_free(&frame);
+
+                std::lock_guard<std::mutex> statsLock(statsMutex_);
+                stats_.staticFrames++;
+            } else {
+                frame->pts = pts;
+                // Com intra refresh o GOP é uma onda de macroblocos intra, sem IDR
+                if (forceKeyframe_.exchange(false) ||
+                    (!config_.encoder.intraRefresh && gopPosition_ >= gopSize_)) {
+                    frame->pict_type = AV_PICTURE_TYPE_I;
+                }
+
+                const auto encodeStart = std::chrono::steady_clock::now();
+                if (tracing_) {
+                    RTSPServer::FrameTrace trace{name_, queued.timestamp, steadyMicros(queued.pushed),
+                                                 steadyMicros(queued.arrival), steadyMicros(encodeStart), 0, 0};
+                    pendingTraces_.push_back({pts, std::move(trace)});
+                    // Frames que o encoder descartou nunca recebem pacote
+                    while (pendingTraces_.size() > MAX_PENDING_TRACES) {
+                        pendingTraces_.pop_front();
+                    }
+                }
+                const bool encoded = encodeAndTransmit(frame);
+                if (governor_) {
+                    governor_->addSample(
+                        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - encodeStart).count(),
+                        1e6 / encodeFps_);
+                }
+
+                if (encoded) {
+                    const float latency = std::chrono::duration<float, std::milli>(
+                        std::chrono::steady_clock::now() - queued.arrival).count();
+
+                    std::lock_guard<std::mutex> statsLock(statsMutex_);
+                    stats_.framesTransferred++;
+                    stats_.avgLatency = stats_.framesTransferred == 1
+                                            ? latency
+                                            : stats_.avgLatency * 0.9f + latency * 0.1f;
+                }
+
+                av_frame_free(&frame);
+            }
+
+            if (skipped > 0) {
+                std::lock_guard<std::mutex> statsLock(statsMutex_);
+                stats_.droppedFrames += skipped;
+            }
+        }
+
+        adaptRate();
+        governEncoder();
+        updateStats();
+
+        // Liberar o agendamento e reagendar se chegaram novos frames
+        scheduled_ = false;
+        bool pending; {
+            std::lock_guard<std::mutex> lock(frameMutex_);
+            pending = !frameQueue_.empty();
+        }
+        if (pending && isOpen_) {
+            schedule();
+        }
+    }
+
+    bool ServerStream::computePts(int64_t timestamp, int64_t &pts) {
+        const int64_t frameDuration = av_rescale_q(1, AVRational{1, encodeFps_}, ENCODER_TIME_BASE);
+
+        // Primeiro frame ou descontinuidade (loop, seek, relógio do produtor)
+        if (anchorTimestamp_ == AV_NOPTS_VALUE ||
+            std::abs(timestamp - lastTimestamp_) > TIMESTAMP_DISCONTINUITY) {
+            anchorTimestamp_ = timestamp;
+            anchorPts_ = lastPts_ == AV_NOPTS_VALUE ? 0 : lastPts_ + frameDuration;
+        }
+        lastTimestamp_ = timestamp;
+
+        pts = anchorPts_ + av_rescale_q(timestamp - anchorTimestamp_, AV_TIME_BASE_Q, ENCODER_TIME_BASE);
+
+        // fps abaixo do nominal: cada slot de 1/fps aceita o primeiro frame
+        // que chega até meio intervalo do produtor antes dele; os demais são
+        // descartados e o pts de 90 kHz mantém o espaçamento real
+        if (encodeFps_ < videoConfig_.fps && nextSlotPts_ != AV_NOPTS_VALUE) {
+            const int64_t sourceDuration = av_rescale_q(1, AVRational{1, videoConfig_.fps}, ENCODER_TIME_BASE);
+            if (pts < nextSlotPts_ - sourceDuration / 2) {
+                return false;
+            }
+            // Pausa do produtor: a grade recomeça no frame aceito
+            nextSlotPts_ = pts - nextSlotPts_ >= frameDuration ? pts + frameDuration : nextSlotPts_ + frameDuration;
+        } else {
+            nextSlotPts_ = pts + frameDuration;
+        }
+
+        if (lastPts_ != AV_NOPTS_VALUE && config_.steadyCadence) {
+            // Desvio em relação ao próximo slot da grade de 1/fps
+            const int64_t error = pts - (lastPts_ + frameDuration);
+            int64_t slots = 1;
+
+            if (error >= 2 * frameDuration) {
+                // Pausa do produtor: pula os slots vazios
+                slots = 1 + (error + frameDuration / 2) / frameDuration;
+                cadenceError_ = 0;
+            } else if (error <= -2 * frameDuration) {
+                return false; // Rajada: frame adiantado demais
+            } else {
+                // Jitter é filtrado; só a deriva acumulada pula ou descarta um slot
+                cadenceError_ += (error - cadenceError_) / 8;
+                if (cadenceError_ > frameDuration / 2) {
+                    slots = 2;
+                    cadenceError_ -= frameDuration;
+                } else if (cadenceError_ < -frameDuration / 2) {
+                    cadenceError_ += frameDuration;
+                    return false;
+                }
+            }
+            pts = lastPts_ + slots * frameDuration;
+        } else if (lastPts_ != AV_NOPTS_VALUE && pts <= lastPts_) {
+            pts = lastPts_ + 1;
+        }
+
+        lastPts_ = pts;
+        return true;
+    }
+
+    bool ServerStream::isStatic(const QueuedFrame &queued) {
+        if (!config_.skipStaticFrames) {
+            return false;
+        }
+
+        // Keyframe pendente (novo cliente) e o piso de 1 frame a cada N
+        // segundos sempre codificam
+        const bool due = forceKeyframe_ ||
+                         queued.arrival - lastEncodedArrival_ >= std::chrono::seconds(config_.staticFrameInterval);
+        if (!due && !changeDetector_.hasChanged(queued.frame)) {
+            return true;
+        }
+
+        changeDetector_.setReference(queued.frame);
+        lastEncodedArrival_ = queued.arrival;
+        return false;
+    }
+
+    bool ServerStream::encodeAndTransmit(AVFrame *frame) {
+        if (!encoderContext_ || !frame) {
+            return false;
+        }
+
+        const int64_t encodeStart = LatencyHistogram::now();
+        if (avcodec_send_frame(encoderContext_, frame) < 0) {
+            return false;
+        }
+
+        return transmitPackets(encodeStart);
+    }
+
+    bool ServerStream::transmitPackets(int64_t encodeStart) {
+        AVPacket *packet = av_packet_alloc();
+        bool success = false;
+
+        // Encode: do envio do frame (ou do pacote anterior) até cada pacote
+        int64_t stageStart = encodeStart;
+        while (avcodec_receive_packet(encoderContext_, packet) >= 0) {
+            stageStart = encodeLatency_.recordSince(stageStart);
+            const int64_t encodedAt = tracing_ ? steadyMicros(std::chrono::steady_clock::now()) : 0;
+            const int64_t encoderPts = packet->pts;
+            packet->stream_index = videoStream_->index;
+
+            // Converter timestamps
+            av_packet_rescale_ts(packet,
+                                 encoderContext_->time_base,
+                                 videoStream_->time_base);
+
+            currentKeyframe_ = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+            frameStartPending_ = true;
+            gopPosition_ = currentKeyframe_ || (config_.encoder.intraRefresh && gopPosition_ >= gopSize_)
+                               ? 1
+                               : gopPosition_ + 1;
+
+            int size = packet->size;
+            if (av_write_frame(rtpContext_, packet) >= 0) {
+                std::lock_guard<std::mutex> lock(statsMutex_);
+                stats_.bytesTransferred += size;
+                success = true;
+            }
+
+            deliverPending();
+            av_packet_unref(packet);
+            stageStart = writeLatency_.recordSince(stageStart);
+
+            if (encodedAt != 0) {
+                traceEncoded(encoderPts, encodedAt, steadyMicros(std::chrono::steady_clock::now()));
+            }
+        }
+
+        av_packet_free(&packet);
+        return success;
+    }
+
+    void ServerStream::setFrameTraceCallback(RTSPServer::FrameTraceCallback callback) {
+        std::lock_guard<std::mutex> lock(traceMutex_);
+        traceCallback_ = std::move(callback);
+        tracing_ = static_cast<bool>(traceCallback_);
+    }
+
+    void ServerStream::traceEncoded(int64_t pts, int64_t encoded, int64_t written) {
+        // Pacotes saem na ordem de decodificação: procura o frame pelo pts
+        auto it = std::find_if(pendingTraces_.begin(), pendingTraces_.end(),
+                               [pts](const PendingTrace &pending) { return pending.pts == pts; });
+        if (it == pendingTraces_.end()) {
+            return;
+        }
+        RTSPServer::FrameTrace trace = std::move(it->trace);
+        pendingTraces_.erase(it);
+        trace.encoded = encoded;
+        trace.written = written;
+
+        std::lock_guard<std::mutex> lock(traceMutex_);
+        if (traceCallback_) {
+            traceCallback_(trace);
+        }
+    }
+
+    void ServerStream::deliverPending() {
+        if (pendingPackets_.empty()) {
+            return;
+        }
+
+        std::vector<std::shared_ptr<RTSPSession>> subscribers; {
+            std::lock_guard<std::mutex> lock(subscribersMutex_);
+            subscribers = subscribers_;
+        }
+
+        // Clientes UDP saem juntos em poucos sendmmsg; TCP usa writev por conexão
+        UdpEgress udp(egressOptions_, egressCounters_);
+        for (auto &session: subscribers) {
+            session->sendPackets(pendingPackets_, udp);
+        }
+
+        // Multicast: uma única cópia para o grupo, independente dos receptores
+        if (multicastSubscribers_ > 0) {
+            RtpPacketBatch rtp;
+            RtpPacketBatch rtcp;
+            for (const auto &packet: pendingPackets_) {
+                (packet->rtcp ? rtcp : rtp).push_back(packet);
+            }
+            udp.add(multicastSocket_, multicastRtpAddress_, rtp.data(), rtp.size());
+            udp.add(multicastSocket_, multicastRtcpAddress_, rtcp.data(), rtcp.size());
+        }
+        udp.flush();
+
+        pendingPackets_.clear();
+    }
+
+    int ServerStream::writeRtpPacket(void *opaque, const uint8_t *buf, int size) {
+        auto *stream = static_cast<ServerStream *>(opaque);
+        if (size < 2) {
+            return size;
+        }
+
+        auto packet = std::make_shared<RtpPacket>();
+        packet->data.assign(buf, buf + size);
+
+        // Tipos de payload 200-204 são RTCP (SR, RR, SDES, BYE, APP)
+        packet->rtcp = buf[1] >= 200 && buf[1] <= 204;
+        if (!packet->rtcp) {
+            packet->keyframe = stream->currentKeyframe_;
+            packet->frameStart = stream->frameStartPending_;
+            stream->frameStartPending_ = false;
+        }
+
+        const bool sliceEnd = !packet->rtcp && isNalEnd(buf, size, stream->encoderContext_->codec_id);
+        stream->pendingPackets_.push_back(std::move(packet));
+
+        // Modo slice: envia cada NAL completa sem esperar o fim do frame
+        if (sliceEnd && stream->config_.encoder.sliceOutput) {
+            stream->deliverPending();
+        }
+        return size;
+    }
+
+    void ServerStream::clearFrameQueue() {
+        std::lock_guard<std::mutex> lock(frameMutex_);
+        while (!frameQueue_.empty()) {
+            av_frame_free(&frameQueue_.front().frame);
+            frameQueue_.pop_front();
+        }
+    }
+
+    void ServerStream::updateStats() {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration<float>(now - lastStatsUpdate_).count();
+
+        // Atualizar estatísticas a cada segundo
+        if (elapsed < 1.0f) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.uptime = std::chrono::duration_cast<std::chrono::seconds>(
+            now - startTime_).count();
+        stats_.currentFps = (stats_.framesTransferred - lastFrames_) / elapsed;
+        stats_.currentBitrate = static_cast<int64_t>(
+            (stats_.bytesTransferred - lastBytes_) * 8 / elapsed);
+
+        stats_.targetBitrate = bitrate_;
+        stats_.targetFps = encodeFps_;
+        if (governor_) {
+            stats_.encoderLoad = governor_->load();
+            stats_.governorLevel = governor_->level();
+            stats_.governorTransitions = governor_->transitions();
+        }
+
+        lastFrames_ = stats_.framesTransferred;
+        lastBytes_ = stats_.bytesTransferred;
+        lastStatsUpdate_ = now;
+    }
+
+    void ServerStream::resetStats() {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_ = RTSPServer::ServerStats{};
+        stats_.targetBitrate = bitrate_;
+        stats_.targetFps = encodeFps_;
+        startTime_ = std::chrono::steady_clock::now();
+        lastStatsUpdate_ = startTime_;
+        lastFrames_ = 0;
+        lastBytes_ = 0;
+    }
+
+    RTSPServer::ServerStats ServerStream::getStats() const {
+        RTSPServer::ServerStats stats; {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            stats = stats_;
+        }
+        stats.connectedClients = static_cast<int>(subscriberCount());
+
+        LatencySnapshots latency;
+        collectLatency(latency);
+        stats.convertLatency = latency.convert.summary();
+        stats.encodeLatency = latency.encode.summary();
+        stats.writeLatency = latency.write.summary();
+        return stats;
+    }
+
+    void ServerStream::collectLatency(LatencySnapshots &snapshots) const {
+        convertLatency_.collect(snapshots.convert);
+        encodeLatency_.collect(snapshots.encode);
+        writeLatency_.collect(snapshots.write);
+    }
+
+    void ServerStream::resetLatency() {
+        convertLatency_.reset();
+        encodeLatency_.reset();
+        writeLatency_.reset();
+    }
+
+    AVFrame *ServerStream::createVideoFrame(int width, int height, AVPixelFormat pixFormat) {
+        AVFrame *frame = av_frame_alloc();
+        if (!frame) {
+            return nullptr;
+        }
+
+        frame->format = pixFormat;
+        frame->width = width;
+        frame->height = height;
+
+        // Alocar buffers para o frame
+        if (av_frame_get_buffer(frame, 32) < 0) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+
+        // Garantir que o frame seja gravável
+        if (av_frame_make_writable(frame) < 0) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+
+        return frame;
+    }
+
+    bool ServerStream::scaleFrame(const uint8_t *data, AVFrame *frame) {
+        scaler_ = sws_getCachedContext(scaler_,
+                                       videoConfig_.width, videoConfig_.height, AV_PIX_FMT_BGR24,
+                                       frame->width, frame->height, AV_PIX_FMT_YUV420P,
+                                       SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!scaler_) {
+            return false;
+        }
+
+        const uint8_t *srcData[1] = {data};
+        const int srcLinesize[1] = {videoConfig_.width * 3};
+        return sws_scale(scaler_, srcData, srcLinesize, 0, videoConfig_.height,
+                         frame->data, frame->linesize) > 0;
+    }
+
+    bool ServerStream::convertFrame(const uint8_t *data, int size, AVFrame *frame) {
+        if (!data || !frame || size <= 0) {
+            return false;
+        }
+
+        // Assumindo entrada BGR24 e saída YUV420P
+        const int in_linesize = frame->width * 3; // BGR24 = 3 bytes por pixel
+
+        // Conversão de cor usando tabelas de lookup (mais rápido que cálculos diretos)
+        static const int YR = 77; // 0.299 * 256
+        static const int YG = 150; // 0.587 * 256
+        static const int YB = 29; // 0.114 * 256
+        static const int UR = -43; // -0.169 * 256
+        static const int UG = -84; // -0.331 * 256
+        static const int UB = 127; // 0.500 * 256
+        static const int VR = 127; // 0.500 * 256
+        static const int VG = -106; // -0.419 * 256
+        static const int VB = -21; // -0.081 * 256
+
+        // Y plane
+        for (int y = 0; y < frame->height; y++) {
+            for (int x = 0; x < frame->width; x++) {
+                const uint8_t *pixel = data + y * in_linesize + x * 3;
+                uint8_t b = pixel[0];
+                uint8_t g = pixel[1];
+                uint8_t r = pixel[2];
+
+                frame->data[0][y * frame->linesize[0] + x] = static_cast<uint8_t>(
+                    (YR * r + YG * g + YB * b + 128) >> 8);
+            }
+        }
+
+        // U and V planes (chroma subsampling 4:2:0)
+        for (int y = 0; y < frame->height / 2; y++) {
+            for (int x = 0; x < frame->width / 2; x++) {
+                int sum_r = 0, sum_g = 0, sum_b = 0;
+
+                // Soma dos 4 pixels adjacentes
+                for (int dy = 0; dy < 2; dy++) {
+                    for (int dx = 0; dx < 2; dx++) {
+                        const uint8_t *pixel = data +
+                                               (y * 2 + dy) * in_linesize +
+                                               (x * 2 + dx) * 3;
+                        sum_b += pixel[0];
+                        sum_g += pixel[1];
+                        sum_r += pixel[2];
+                    }
+                }
+
+                // Média dos 4 pixels
+                int r = sum_r / 4;
+                int g = sum_g / 4;
+                int b = sum_b / 4;
+
+                // U plane (Cb)
+                frame->data[1][y * frame->linesize[1] + x] = static_cast<uint8_t>(
+                    ((UR * r + UG * g + UB * b + 128) >> 8) + 128);
+
+                // V plane (Cr)
+                frame->data[2][y * frame->linesize[2] + x] = static_cast<uint8_t>(
+                    ((VR * r + VG * g + VB * b + 128) >> 8) + 128);
+            }
+        }
+
+        return true;
+    }
+} // namespace turbovision
@@ -0,0 +1,174 @@
+#include "turbovision/server/socket_utils.hpp"
+
+#ifdef _WIN32
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace turbovision {
+namespace net {
+    SocketHandle createTcpListener(const std::string &address, int port, int backlog) {
+        SocketHandle sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sock == INVALID_SOCKET_HANDLE) {
+            return INVALID_SOCKET_HANDLE;
+        }
+
+        int reuse = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR,
+                   reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+        sockaddr_in addr{};
+        if (!parseAddress(address, port, addr) ||
+            bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+            listen(sock, backlog) < 0 ||
+            !setNonBlocking(sock)) {
+            closeSocket(sock);
+            return INVALID_SOCKET_HANDLE;
+        }
+
+        return sock;
+    }
+
+    SocketHandle createUdpSocket(const std::string &address, int port) {
+        SocketHandle sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock == INVALID_SOCKET_HANDLE) {
+            return INVALID_SOCKET_HANDLE;
+        }
+
+        sockaddr_in addr{};
+        if (!parseAddress(address, port, addr) ||
+            bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+            !setNonBlocking(sock)) {
+            closeSocket(sock);
+            return INVALID_SOCKET_HANDLE;
+        }
+
+        return sock;
+    }
+
+    bool setNonBlocking(SocketHandle socket) {
+#ifdef _WIN32
+        u_long mode = 1;
+        return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+        int flags = fcntl(socket, F_GETFL, 0);
+        return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    void closeSocket(SocketHandle socket) {
+        if (socket == INVALID_SOCKET_HANDLE) {
+            return;
+        }
+#ifdef _WIN32
+        closesocket(socket);
+#else
+        close(socket);
+#endif
+    }
+
+    void shutdownSocket(SocketHandle socket) {
+        if (socket == INVALID_SOCKET_HANDLE) {
+            return;
+        }
+#ifdef _WIN32
+        shutdown(socket, SD_BOTH);
+#else
+        shutdown(socket, SHUT_RDWR);
+#endif
+    }
+
+    bool setSendBufferSize(SocketHandle socket, int size) {
+        return setsockopt(socket, SOL_SOCKET, SO_SNDBUF,
+                          reinterpret_cast<const char *>(&size), sizeof(size)) == 0;
+    }
+
+    bool setTypeOfService(SocketHandle socket, int dscp) {
+        // DSCP ocupa os 6 bits mais significativos do campo TOS
+        int tos = (dscp & 0x3F) << 2;
+        return setsockopt(socket, IPPROTO_IP, IP_TOS,
+                          reinterpret_cast<const char *>(&tos), sizeof(tos)) == 0;
+    }
+
+    bool setNoDelay(SocketHandle socket) {
+        int flag = 1;
+        return setsockopt(socket, IPPROTO_TCP, TCP_NODELAY,
+                          reinterpret_cast<const char *>(&flag), sizeof(flag)) == 0;
+    }
+
+    bool setMulticastOptions(SocketHandle socket, int ttl, const std::string &interfaceAddress) {
+        int value = ttl;
+        if (setsockopt(socket, IPPROTO_IP, IP_MULTICAST_TTL,
+                       reinterpret_cast<const char *>(&value), sizeof(value)) < 0) {
+            return false;
+        }
+
+        // Mantém a entrega local (receptores na mesma máquina e testes em loopback)
+        value = 1;
+        setsockopt(socket, IPPROTO_IP, IP_MULTICAST_LOOP,
+                   reinterpret_cast<const char *>(&value), sizeof(value));
+
+        if (!interfaceAddress.empty()) {
+            in_addr address{};
+            if (inet_pton(AF_INET, interfaceAddress.c_str(), &address) != 1 ||
+                setsockopt(socket, IPPROTO_IP, IP_MULTICAST_IF,
+                           reinterpret_cast<const char *>(&address), sizeof(address)) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isMulticastAddress(const std::string &host) {
+        in_addr address{};
+        if (inet_pton(AF_INET, host.c_str(), &address) != 1) {
+            return false;
+        }
+        // 224.0.0.0/4
+        return (ntohl(address.s_addr) & 0xF0000000) == 0xE0000000;
+    }
+
+    int localPort(SocketHandle socket) {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        if (getsockname(socket, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+            return -1;
+        }
+        return ntohs(addr.sin_port);
+    }
+
+    std::string addressToString(const sockaddr_in &address) {
+        char buf[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &address.sin_addr, buf, sizeof(buf));
+        return std::string(buf) + ":" + std::to_string(ntohs(address.sin_port));
+    }
+
+    bool parseAddress(const std::string &host, int port, sockaddr_in &address) {
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+
+        if (host.empty() || host == "0.0.0.0") {
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+            return true;
+        }
+        return inet_pton(AF_INET, host.c_str(), &address.sin_addr) == 1;
+    }
+
+    bool lastErrorWouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+} // namespace net
+} // namespace turbovision
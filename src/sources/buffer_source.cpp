@@ -0,0 +1,394 @@
+#include "turbovision/sources/buffer_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace turbovision {
+    namespace {
+        const int IO_BUFFER_SIZE = 64 * 1024;
+        const int READ_WAIT_MS = 10;               // Espera máxima do leitor antes de checar stop()
+
+        size_t roundUpPowerOfTwo(size_t value) {
+            size_t result = 2;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        void freeVector(void *opaque, uint8_t *) {
+            delete static_cast<std::vector<uint8_t> *>(opaque);
+        }
+    }
+
+    // Fila SPSC de chunks: push() da aplicação, pop() da thread de captura
+    class BufferSource::ChunkQueue {
+    public:
+        explicit ChunkQueue(size_t capacity)
+            : slots_(roundUpPowerOfTwo(capacity), nullptr)
+              , mask_(slots_.size() - 1)
+              , head_(0)
+              , tail_(0) {
+        }
+
+        ~ChunkQueue() {
+            clear();
+        }
+
+        bool push(AVBufferRef *buffer) {
+            const uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) >= slots_.size()) {
+                return false;
+            }
+            slots_[tail & mask_] = buffer;
+            // seq_cst: par com readerWaiting_ (o leitor nunca dorme com dados na fila)
+            tail_.store(tail + 1, std::memory_order_seq_cst);
+            return true;
+        }
+
+        AVBufferRef *pop() {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_seq_cst)) {
+                return nullptr;
+            }
+            AVBufferRef *buffer = slots_[head & mask_];
+            head_.store(head + 1, std::memory_order_release);
+            return buffer;
+        }
+
+        bool empty() const {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_seq_cst);
+        }
+
+        // Só pelo consumidor (ou com a captura parada)
+        int64_t clear() {
+            int64_t bytes = 0;
+            while (AVBufferRef *buffer = pop()) {
+                bytes += static_cast<int64_t>(buffer->size);
+                av_buffer_unref(&buffer);
+            }
+            return bytes;
+        }
+
+    private:
+        std::vector<AVBufferRef *> slots_;
+        const size_t mask_;
+        alignas(64) std::atomic<uint64_t> head_;
+        alignas(64) std::atomic<uint64_t> tail_;
+    };
+
+    BufferSource::BufferSource(const VideoConfig &config, const BufferConfig &bufferConfig)
+        : VideoSource(config)
+          , bufferConfig_(bufferConfig)
+          , queue_(std::make_unique<ChunkQueue>(static_cast<size_t>(std::max(2, bufferConfig.queueChunks))))
+          , ioContext_(nullptr)
+          , current_(nullptr)
+          , currentOffset_(0)
+          , readerWaiting_(false)
+          , endOfStream_(false)
+          , streamOpen_(false)
+          , chunks_(0)
+          , bytes_(0)
+          , dropped_(0)
+          , queuedBytes_(0) {
+    }
+
+    BufferSource::~BufferSource() {
+        stop();
+        closeStream();
+    }
+
+    bool BufferSource::push(AVBufferRef *buffer) {
+        if (!buffer) {
+            return false;
+        }
+        const auto size = static_cast<int64_t>(buffer->size);
+        if (size == 0) {
+            av_buffer_unref(&buffer);
+            return true;
+        }
+
+        // Contabiliza antes de publicar: o leitor pode consumir o chunk na hora
+        if (queuedBytes_.fetch_add(size) + size > bufferConfig_.maxQueuedBytes || !queue_->push(buffer)) {
+            queuedBytes_ -= size;
+            dropped_++;
+            av_buffer_unref(&buffer);
+            return false;
+        }
+        chunks_++;
+        bytes_ += size;
+
+        if (readerWaiting_) {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            dataAvailable_.notify_one();
+        }
+        return true;
+    }
+
+    bool BufferSource::push(std::vector<uint8_t> &&chunk) {
+        if (chunk.empty()) {
+            return true;
+        }
+        // O vetor passa a ser dono dos dados do AVBufferRef
+        auto *owned = new std::vector<uint8_t>(std::move(chunk));
+        AVBufferRef *buffer = av_buffer_create(owned->data(), owned->size(), &freeVector, owned,
+                                               AV_BUFFER_FLAG_READONLY);
+        if (!buffer) {
+            delete owned;
+            dropped_++;
+            return false;
+        }
+        return push(buffer);
+    }
+
+    bool BufferSource::push(const uint8_t *data, size_t size) {
+        if (!data || size == 0) {
+            return size == 0;
+        }
+        AVBufferRef *buffer = av_buffer_alloc(size);
+        if (!buffer) {
+            dropped_++;
+            return false;
+        }
+        std::memcpy(buffer->data, data, size);
+        return push(buffer);
+    }
+
+    void BufferSource::endOfStream() {
+        endOfStream_ = true;
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        dataAvailable_.notify_one();
+    }
+
+    BufferSource::Stats BufferSource::getStats() const {
+        return Stats{chunks_, bytes_, dropped_, queuedBytes_, streamOpen_};
+    }
+
+    bool BufferSource::initializeSource() {
+        // O demuxer só abre na thread de captura: start() não espera os
+        // primeiros bytes chegarem
+        auto *buffer = static_cast<unsigned char *>(av_malloc(IO_BUFFER_SIZE));
+        ioContext_ = buffer ? avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, &BufferSource::readPacket,
+                                                 nullptr, nullptr)
+                            : nullptr;
+        if (!ioContext_) {
+            std::cerr << "BufferSource::initializeSource() - Falha ao alocar AVIOContext" << std::endl;
+            av_free(buffer);
+            return false;
+        }
+        return true;
+    }
+
+    void BufferSource::cleanupSource() {
+        closeStream();
+        av_buffer_unref(&current_);
+        currentOffset_ = 0;
+        queuedBytes_ -= queue_->clear();
+        endOfStream_ = false;
+    }
+
+    void BufferSource::captureLoop() {
+        std::cout << "BufferSource::captureLoop() - Aguardando stream..." << std::endl;
+        if (!openStream()) {
+            closeStream();
+            return;
+        }
+
+        AVPacket *packet = av_packet_alloc();
+        if (!packet) {
+            std::cerr << "BufferSource::captureLoop() - Falha ao alocar packet" << std::endl;
+            return;
+        }
+
+        try {
+            while (isRunning_) {
+                if (isPaused_) {
+                    // Sem ler a fila: com ela cheia, push() descarta
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+
+                const int64_t readStart = LatencyHistogram::now();
+                int ret = av_read_frame(formatContext_, packet);
+                if (ret < 0) {
+                    if (ret != AVERROR_EOF && ret != AVERROR_EXIT) {
+                        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                        av_strerror(ret, errbuf, sizeof(errbuf));
+                        std::cerr << "BufferSource::captureLoop() - Erro na leitura: " << errbuf << std::endl;
+                    }
+                    // Fim do stream: drena os frames que o decoder ainda segura
+                    if (ret == AVERROR_EOF) {
+                        processPacket(nullptr);
+                    }
+                    break;
+                }
+                stageHistograms_->packetRead.recordSince(readStart);
+                if (packet->stream_index == videoStreamIndex_ && !processPacket(packet)) {
+                    std::cerr << "BufferSource::captureLoop() - Falha ao processar packet" << std::endl;
+                }
+                av_packet_unref(packet);
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "BufferSource::captureLoop() - Exceção: " << e.what() << std::endl;
+        }
+
+        std::cout << "BufferSource::captureLoop() - Finalizando loop de captura" << std::endl;
+        av_packet_free(&packet);
+    }
+
+    bool BufferSource::openStream() {
+        const AVInputFormat *inputFormat = nullptr;
+        if (!bufferConfig_.format.empty()) {
+            inputFormat = av_find_input_format(bufferConfig_.format.c_str());
+            if (!inputFormat) {
+                std::cerr << "BufferSource::openStream() - Formato desconhecido: " << bufferConfig_.format
+                        << std::endl;
+                return false;
+            }
+        }
+
+        formatContext_ = avformat_alloc_context();
+        if (!formatContext_) {
+            std::cerr << "BufferSource::openStream() - Falha ao alocar formato de contexto" << std::endl;
+            return false;
+        }
+        formatContext_->pb = ioContext_;
+        formatContext_->flags |= AVFMT_FLAG_CUSTOM_IO;
+        formatContext_->probesize = bufferConfig_.probeSize;
+        if (bufferConfig_.lowLatency) {
+            formatContext_->flags |= AVFMT_FLAG_NOBUFFER;
+            formatContext_->max_analyze_duration = 0;
+        }
+
+        int ret = avformat_open_input(&formatContext_, "", inputFormat, nullptr);
+        if (ret < 0) {
+            if (ret != AVERROR_EXIT) {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                std::cerr << "BufferSource::openStream() - Falha ao abrir stream: " << errbuf << std::endl;
+            }
+            formatContext_ = nullptr;  // Liberado por avformat_open_input
+            return false;
+        }
+        if (avformat_find_stream_info(formatContext_, nullptr) < 0) {
+            std::cerr << "BufferSource::openStream() - Falha ao ler informações dos streams" << std::endl;
+            return false;
+        }
+
+        videoStreamIndex_ = av_find_best_stream(formatContext_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (videoStreamIndex_ < 0) {
+            std::cerr << "BufferSource::openStream() - Nenhum stream de vídeo encontrado" << std::endl;
+            return false;
+        }
+        for (unsigned int i = 0; i < formatContext_->nb_streams; i++) {
+            if (static_cast<int>(i) != videoStreamIndex_) {
+                formatContext_->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+
+        if (!initializeDecoder()) {
+            return false;
+        }
+        streamOpen_ = true;
+        std::cout << "BufferSource::openStream() - Stream aberto: " << formatContext_->iformat->name << std::endl;
+        return true;
+    }
+
+    void BufferSource::closeStream() {
+        streamOpen_ = false;
+        if (codecContext_) {
+            avcodec_free_context(&codecContext_);
+        }
+        if (formatContext_) {
+            avformat_close_input(&formatContext_);
+        }
+        // Com I/O próprio o AVIOContext não é liberado por avformat_close_input
+        if (ioContext_) {
+            av_freep(&ioContext_->buffer);
+            avio_context_free(&ioContext_);
+        }
+        videoStreamIndex_ = -1;
+    }
+
+    bool BufferSource::initializeDecoder() {
+        AVStream *stream = formatContext_->streams[videoStreamIndex_];
+        const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!decoder) {
+            std::cerr << "BufferSource::initializeDecoder() - Decoder não encontrado" << std::endl;
+            return false;
+        }
+
+        codecContext_ = avcodec_alloc_context3(decoder);
+        if (!codecContext_ || avcodec_parameters_to_context(codecContext_, stream->codecpar) < 0) {
+            std::cerr << "BufferSource::initializeDecoder() - Falha ao configurar o decoder" << std::endl;
+            avcodec_free_context(&codecContext_);
+            return false;
+        }
+        codecContext_->pkt_timebase = stream->time_base;
+        codecContext_->thread_count = config_.advanced.threadCount;
+        if (bufferConfig_.lowLatency) {
+            codecContext_->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        }
+
+        if (hwManager_->isHardwareAvailable()) {
+            codecContext_->hw_device_ctx = av_buffer_ref(hwManager_->getContext());
+        }
+
+        if (avcodec_open2(codecContext_, decoder, nullptr) < 0) {
+            std::cerr << "BufferSource::initializeDecoder() - Falha ao abrir codec" << std::endl;
+            avcodec_free_context(&codecContext_);
+            return false;
+        }
+        return true;
+    }
+
+    int BufferSource::readPacket(void *opaque, uint8_t *buffer, int size) {
+        return static_cast<BufferSource *>(opaque)->read(buffer, size);
+    }
+
+    int BufferSource::read(uint8_t *buffer, int size) {
+        while (true) {
+            if (current_) {
+                const size_t available = static_cast<size_t>(current_->size) - currentOffset_;
+                const size_t count = std::min(static_cast<size_t>(size), available);
+                std::memcpy(buffer, current_->data + currentOffset_, count);
+                currentOffset_ += count;
+                if (currentOffset_ == static_cast<size_t>(current_->size)) {
+                    av_buffer_unref(&current_);
+                    currentOffset_ = 0;
+                }
+                return static_cast<int>(count);
+            }
+
+            current_ = queue_->pop();
+            if (current_) {
+                queuedBytes_ -= static_cast<int64_t>(current_->size);
+                continue;
+            }
+            if (!isRunning_) {
+                return AVERROR_EXIT;
+            }
+            if (endOfStream_) {
+                // Chunks enviados antes de endOfStream() ainda são lidos
+                if (queue_->empty()) {
+                    return AVERROR_EOF;
+                }
+                continue;
+            }
+
+            // Fila vazia: dorme até push(); readerWaiting_ é publicado antes
+            // da nova checagem da fila, então um push concorrente sempre acorda
+            readerWaiting_ = true;
+            {
+                std::unique_lock<std::mutex> lock(waitMutex_);
+                dataAvailable_.wait_for(lock, std::chrono::milliseconds(READ_WAIT_MS), [this] {
+                    return !queue_->empty() || endOfStream_ || !isRunning_;
+                });
+            }
+            readerWaiting_ = false;
+        }
+    }
+
+} // namespace turbovision
@@ -51,8 +51,10 @@ namespace turbovision {
                 continue;
             }
 
+            const int64_t readStart = LatencyHistogram::now();
             int ret = av_read_frame(formatContext_, packet);
             if (ret >= 0) {
+                stageHistograms_->packetRead.recordSince(readStart);
                 if (packet->stream_index == videoStreamIndex_) {
                     processPacket(packet);
                 }
@@ -0,0 +1,1073 @@
+#include "turbovision/sources/file_source.hpp"
+#include "turbovision/core/worker_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace turbovision {
+    namespace {
+        const uint32_t INDEX_MAGIC = 0x31495654;   // "TVI1"
+        const uint32_t INDEX_VERSION = 1;
+        const int IO_BUFFER_SIZE = 256 * 1024;
+        const int64_t MAX_LATENESS_US = 1000000;   // Atraso acima disso reancora o relógio
+
+        // Cabeçalho do sidecar; o índice só vale para o mesmo arquivo
+        struct IndexHeader {
+            uint32_t magic;
+            uint32_t version;
+            int64_t fileSize;
+            int64_t fileTime;
+            int32_t streamIndex;
+            int32_t timeBaseNum;
+            int32_t timeBaseDen;
+            int32_t reserved;
+            int64_t count;
+        };
+
+        bool fileIdentity(const std::string &path, int64_t &size, int64_t &time) {
+            struct stat status{};
+            if (stat(path.c_str(), &status) != 0) {
+                return false;
+            }
+            size = static_cast<int64_t>(status.st_size);
+            time = static_cast<int64_t>(status.st_mtime);
+            return true;
+        }
+    }
+
+    // Arquivo inteiro mapeado; o AVIOContext lê por memcpy, sem syscalls
+    struct FileSource::MappedFile {
+        const uint8_t *data = nullptr;
+        int64_t size = 0;
+        int64_t position = 0;
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (data) {
+                munmap(const_cast<uint8_t *>(data), static_cast<size_t>(size));
+            }
+#endif
+        }
+
+        static int read(void *opaque, uint8_t *buffer, int size) {
+            auto *file = static_cast<MappedFile *>(opaque);
+            if (file->position >= file->size) {
+                return AVERROR_EOF;
+            }
+            const int count = static_cast<int>(std::min<int64_t>(size, file->size - file->position));
+            std::memcpy(buffer, file->data + file->position, static_cast<size_t>(count));
+            file->position += count;
+            return count;
+        }
+
+        static int64_t seek(void *opaque, int64_t offset, int whence) {
+            auto *file = static_cast<MappedFile *>(opaque);
+            if (whence == AVSEEK_SIZE) {
+                return file->size;
+            }
+            int64_t position;
+            switch (whence & ~AVSEEK_FORCE) {
+                case SEEK_SET:
+                    position = offset;
+                    break;
+                case SEEK_CUR:
+                    position = file->position + offset;
+                    break;
+                case SEEK_END:
+                    position = file->size + offset;
+                    break;
+                default:
+                    return AVERROR(EINVAL);
+            }
+            if (position < 0 || position > file->size) {
+                return AVERROR(EINVAL);
+            }
+            file->position = position;
+            return position;
+        }
+    };
+
+    // Worker da decodificação paralela: demuxer, I/O e decoder próprios
+    struct FileSource::GopWorker {
+        AVFormatContext *formatContext = nullptr;
+        AVCodecContext *codecContext = nullptr;
+        AVIOContext *ioContext = nullptr;
+        std::unique_ptr<MappedFile> mappedFile;
+        AVPacket *packet = nullptr;
+        AVFrame *frame = nullptr;
+
+        ~GopWorker() {
+            av_frame_free(&frame);
+            av_packet_free(&packet);
+            avcodec_free_context(&codecContext);
+            if (formatContext) {
+                avformat_close_input(&formatContext);
+            }
+            if (ioContext) {
+                av_freep(&ioContext->buffer);
+                avio_context_free(&ioContext);
+            }
+        }
+    };
+
+    // Estado compartilhado entre os workers e a thread de entrega
+    struct FileSource::ParallelRun {
+        struct Gop {
+            size_t keyframe;             // Entrada do índice
+            int64_t startPts;            // Frames com pts em [startPts, próximo GOP)
+            int64_t firstSequence;       // Primeiro frame do GOP na ordem de exibição
+            int64_t frames;
+        };
+
+        std::vector<Gop> gops;
+        int64_t totalFrames = 0;
+
+        std::mutex mutex;
+        std::condition_variable frameReady;
+        std::condition_variable spaceFree;
+        std::atomic<bool> abort{false};
+
+        size_t nextGop = 0;              // Próximo GOP a distribuir
+        size_t activeWorkers = 0;
+        int64_t startSequence = 0;       // Frames antes disso são descartados (seek)
+        int64_t startPts = 0;
+        int64_t nextSequence = 0;        // Em ordem: próximo frame a entregar
+        std::map<int64_t, FramePtr> ready;
+        std::vector<char> done;
+
+        size_t gopOf(int64_t sequence) const {
+            auto it = std::upper_bound(gops.begin(), gops.end(), sequence,
+                                       [](int64_t value, const Gop &gop) { return value < gop.firstSequence; });
+            return it == gops.begin() ? 0 : static_cast<size_t>(it - gops.begin() - 1);
+        }
+
+        // Há frame para entregar? Em ordem, pula frames que um GOP já
+        // terminado não produziu (erro de decodificação) em vez de travar
+        bool deliverable(bool ordered) {
+            if (!ordered) {
+                return !ready.empty();
+            }
+            while (true) {
+                if (!ready.empty() && ready.begin()->first <= nextSequence) {
+                    return true;
+                }
+                if (nextSequence >= totalFrames) {
+                    return false;
+                }
+                const size_t index = gopOf(nextSequence);
+                if (!done[index]) {
+                    return false;
+                }
+                const Gop &gop = gops[index];
+                const int64_t end = gop.firstSequence + gop.frames;
+                nextSequence = ready.empty() ? end : std::min(end, ready.begin()->first);
+            }
+        }
+
+        FramePtr take(bool ordered) {
+            if (!deliverable(ordered)) {
+                return nullptr;
+            }
+            auto it = ready.begin();
+            FramePtr frame = std::move(it->second);
+            nextSequence = std::max(nextSequence, it->first + 1);
+            ready.erase(it);
+            return frame;
+        }
+
+        bool finished() const {
+            return nextGop >= gops.size() && activeWorkers == 0 && ready.empty();
+        }
+    };
+
+    FileSource::FileSource(const VideoConfig &config, const FileConfig &fileConfig)
+        : VideoSource(config)
+          , fileConfig_(fileConfig)
+          , ioContext_(nullptr)
+          , indexInfo_{}
+          , skipUntil_(AV_NOPTS_VALUE)
+          , lastPts_(AV_NOPTS_VALUE)
+          , pendingSeek_(AV_NOPTS_VALUE)
+          , endOfFile_(false) {
+    }
+
+    FileSource::~FileSource() {
+        stop();
+        close();
+    }
+
+    bool FileSource::initializeSource() {
+        // frameAt() pode já ter aberto o arquivo
+        return formatContext_ || open();
+    }
+
+    void FileSource::cleanupSource() {
+        close();
+    }
+
+    bool FileSource::seek(int64_t timestamp) {
+        if (!formatContext_ && !open()) {
+            return false;
+        }
+        if (isRunning_) {
+            pendingSeek_ = timestamp;
+            return true;
+        }
+        AVStream *stream = formatContext_->streams[videoStreamIndex_];
+        return seekToPts(av_rescale_q(timestamp, AV_TIME_BASE_Q, stream->time_base));
+    }
+
+    FramePtr FileSource::frameAt(int64_t timestamp) {
+        if (isRunning_ || (!formatContext_ && !open())) {
+            return nullptr;
+        }
+        AVStream *stream = formatContext_->streams[videoStreamIndex_];
+        if (!seekToPts(av_rescale_q(timestamp, AV_TIME_BASE_Q, stream->time_base))) {
+            return nullptr;
+        }
+
+        AVPacket *packet = av_packet_alloc();
+        AVFrame *frame = av_frame_alloc();
+        AVFrame *swFrame = av_frame_alloc();
+        FramePtr result;
+
+        if (decodeNext(packet, frame) >= 0) {
+            const AVFrame *output = frame;
+            if (!frame->hw_frames_ctx || transferFrameFromGPU(frame, swFrame)) {
+                output = frame->hw_frames_ctx ? swFrame : frame;
+                const int64_t pts = framePts(frame);
+                try {
+                    result = createFrameData(output, pts == AV_NOPTS_VALUE
+                                                         ? AV_NOPTS_VALUE
+                                                         : av_rescale_q(pts, stream->time_base, AV_TIME_BASE_Q));
+                    result->setSequence(sequenceFor(pts));
+                } catch (const std::exception &e) {
+                    std::cerr << "FileSource::frameAt() - Exceção: " << e.what() << std::endl;
+                }
+            }
+        }
+
+        av_frame_free(&swFrame);
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        return result;
+    }
+
+    FileSource::IndexInfo FileSource::getIndexInfo() const {
+        return indexInfo_;
+    }
+
+    std::vector<int64_t> FileSource::getKeyframeTimestamps() const {
+        std::vector<int64_t> timestamps;
+        if (!formatContext_ || videoStreamIndex_ < 0) {
+            return timestamps;
+        }
+        const AVRational timeBase = formatContext_->streams[videoStreamIndex_]->time_base;
+        for (const IndexEntry &entry: index_) {
+            if (entry.flags & AV_PKT_FLAG_KEY) {
+                timestamps.push_back(av_rescale_q(entry.pts, timeBase, AV_TIME_BASE_Q));
+            }
+        }
+        std::sort(timestamps.begin(), timestamps.end());
+        return timestamps;
+    }
+
+    void FileSource::captureLoop() {
+        if (fileConfig_.decodeWorkers > 1 && !index_.empty() && parallelCaptureLoop()) {
+            return;
+        }
+
+        AVPacket *packet = av_packet_alloc();
+        AVFrame *frame = av_frame_alloc();
+        AVFrame *swFrame = av_frame_alloc();
+        const AVRational timeBase = formatContext_->streams[videoStreamIndex_]->time_base;
+
+        // Relógio de reprodução: pts âncora ligado a um instante
+        int64_t anchorPts = AV_NOPTS_VALUE;
+        auto anchorTime = std::chrono::steady_clock::now();
+
+        while (isRunning_) {
+            if (isPaused_) {
+                anchorPts = AV_NOPTS_VALUE;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+
+            const int64_t target = pendingSeek_.exchange(AV_NOPTS_VALUE);
+            if (target != AV_NOPTS_VALUE) {
+                seekToPts(av_rescale_q(target, AV_TIME_BASE_Q, timeBase));
+                anchorPts = AV_NOPTS_VALUE;
+            }
+
+            int ret = decodeNext(packet, frame);
+            if (ret == AVERROR_EOF) {
+                if (fileConfig_.loop) {
+                    lastPts_ = AV_NOPTS_VALUE;
+                    seekToPts(presentation_.empty() ? 0 : presentation_.front());
+                    anchorPts = AV_NOPTS_VALUE;
+                } else {
+                    // Fim do arquivo: aguarda um seek ou stop()
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                continue;
+            }
+            if (ret < 0) {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                std::cerr << "FileSource::captureLoop() - Erro na decodificação: " << errbuf << std::endl;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+
+            const int64_t pts = framePts(frame);
+            if (fileConfig_.realtime && pts != AV_NOPTS_VALUE) {
+                const auto now = std::chrono::steady_clock::now();
+                if (anchorPts == AV_NOPTS_VALUE) {
+                    anchorPts = pts;
+                    anchorTime = now;
+                } else {
+                    const auto due = anchorTime + std::chrono::microseconds(
+                                         av_rescale_q(pts - anchorPts, timeBase, AV_TIME_BASE_Q));
+                    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(due - now).count();
+                    if (delta > MAX_LATENESS_US || delta < -MAX_LATENESS_US) {
+                        anchorPts = pts;
+                        anchorTime = now;
+                    } else if (delta > 0) {
+                        std::this_thread::sleep_until(due);
+                    }
+                }
+            }
+
+            if (frame->hw_frames_ctx) {
+                if (transferFrameFromGPU(frame, swFrame)) {
+                    swFrame->best_effort_timestamp = frame->best_effort_timestamp;
+                    processFrame(swFrame);
+                }
+            } else {
+                processFrame(frame);
+            }
+            av_frame_unref(frame);
+            av_frame_unref(swFrame);
+        }
+
+        av_frame_free(&swFrame);
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+    }
+
+    bool FileSource::open() {
+        const auto start = std::chrono::steady_clock::now();
+
+        formatContext_ = avformat_alloc_context();
+        if (!formatContext_) {
+            std::cerr << "FileSource::open() - Falha ao alocar formato de contexto" << std::endl;
+            return false;
+        }
+        if (fileConfig_.useMmap && openMappedInput(ioContext_, mappedFile_)) {
+            formatContext_->pb = ioContext_;
+            formatContext_->flags |= AVFMT_FLAG_CUSTOM_IO;
+        }
+
+        int ret = avformat_open_input(&formatContext_, fileConfig_.path.c_str(), nullptr, nullptr);
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            std::cerr << "FileSource::open() - Falha ao abrir " << fileConfig_.path << ": " << errbuf << std::endl;
+            formatContext_ = nullptr;  // Liberado por avformat_open_input
+            close();
+            return false;
+        }
+        if (avformat_find_stream_info(formatContext_, nullptr) < 0) {
+            std::cerr << "FileSource::open() - Falha ao ler informações dos streams" << std::endl;
+            close();
+            return false;
+        }
+
+        videoStreamIndex_ = av_find_best_stream(formatContext_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (videoStreamIndex_ < 0) {
+            std::cerr << "FileSource::open() - Nenhum stream de vídeo encontrado" << std::endl;
+            close();
+            return false;
+        }
+        // Demux só do vídeo: os demais streams nem são lidos para o índice
+        for (unsigned int i = 0; i < formatContext_->nb_streams; i++) {
+            if (static_cast<int>(i) != videoStreamIndex_) {
+                formatContext_->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+
+        if (!initializeDecoder()) {
+            close();
+            return false;
+        }
+
+        if (fileConfig_.useIndex && index_.empty()) {
+            if (!(fileConfig_.persistIndex && loadIndex()) && buildIndex() && fileConfig_.persistIndex) {
+                saveIndex();
+            }
+            indexInfo_.buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "FileSource::open() - Índice: " << indexInfo_.frames << " frames, "
+                    << indexInfo_.keyframes << " keyframes (" << indexInfo_.buildTime << " s"
+                    << (indexInfo_.fromSidecar ? ", sidecar" : "") << ")" << std::endl;
+        }
+
+        skipUntil_ = AV_NOPTS_VALUE;
+        lastPts_ = AV_NOPTS_VALUE;
+        endOfFile_ = false;
+        return true;
+    }
+
+    void FileSource::close() {
+        if (codecContext_) {
+            avcodec_free_context(&codecContext_);
+        }
+        if (formatContext_) {
+            avformat_close_input(&formatContext_);
+        }
+        // Com I/O próprio o AVIOContext não é liberado por avformat_close_input
+        if (ioContext_) {
+            av_freep(&ioContext_->buffer);
+            avio_context_free(&ioContext_);
+        }
+        mappedFile_.reset();
+        videoStreamIndex_ = -1;
+    }
+
+    bool FileSource::initializeDecoder() {
+        AVStream *stream = formatContext_->streams[videoStreamIndex_];
+        const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!decoder) {
+            std::cerr << "FileSource::initializeDecoder() - Decoder não encontrado" << std::endl;
+            return false;
+        }
+
+        codecContext_ = avcodec_alloc_context3(decoder);
+        if (!codecContext_ || avcodec_parameters_to_context(codecContext_, stream->codecpar) < 0) {
+            std::cerr << "FileSource::initializeDecoder() - Falha ao configurar o decoder" << std::endl;
+            avcodec_free_context(&codecContext_);
+            return false;
+        }
+        codecContext_->pkt_timebase = stream->time_base;
+        codecContext_->thread_count = config_.advanced.threadCount;
+
+        if (hwManager_->isHardwareAvailable()) {
+            codecContext_->hw_device_ctx = av_buffer_ref(hwManager_->getContext());
+        }
+
+        if (avcodec_open2(codecContext_, decoder, nullptr) < 0) {
+            std::cerr << "FileSource::initializeDecoder() - Falha ao abrir codec" << std::endl;
+            avcodec_free_context(&codecContext_);
+            return false;
+        }
+        return true;
+    }
+
+    bool FileSource::openMappedInput(AVIOContext *&ioContext, std::unique_ptr<MappedFile> &mappedFile) const {
+#ifdef _WIN32
+        return false;
+#else
+        const int fd = ::open(fileConfig_.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat status{};
+        if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void *data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+
+        auto file = std::make_unique<MappedFile>();
+        file->data = static_cast<const uint8_t *>(data);
+        file->size = static_cast<int64_t>(status.st_size);
+
+        auto *buffer = static_cast<unsigned char *>(av_malloc(IO_BUFFER_SIZE));
+        ioContext = buffer ? avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, file.get(),
+                                                &MappedFile::read, nullptr, &MappedFile::seek)
+                           : nullptr;
+        if (!ioContext) {
+            av_free(buffer);
+            return false;
+        }
+        mappedFile = std::move(file);
+        return true;
+#endif
+    }
+
+    std::string FileSource::indexPath() const {
+        return fileConfig_.path + ".tvidx";
+    }
+
+    bool FileSource::loadIndex() {
+        int64_t size = 0;
+        int64_t time = 0;
+        if (!fileIdentity(fileConfig_.path, size, time)) {
+            return false;
+        }
+        FILE *file = std::fopen(indexPath().c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+
+        const AVRational timeBase = formatContext_->streams[videoStreamIndex_]->time_base;
+        IndexHeader header{};
+        bool valid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                     header.magic == INDEX_MAGIC && header.version == INDEX_VERSION &&
+                     header.fileSize == size && header.fileTime == time &&
+                     header.streamIndex == videoStreamIndex_ &&
+                     header.timeBaseNum == timeBase.num && header.timeBaseDen == timeBase.den &&
+                     header.count > 0 && header.count < (INT64_C(1) << 32);
+        if (valid) {
+            index_.resize(static_cast<size_t>(header.count));
+            valid = std::fread(index_.data(), sizeof(IndexEntry), index_.size(), file) == index_.size();
+        }
+        std::fclose(file);
+
+        if (!valid) {
+            index_.clear();
+            return false;
+        }
+
+        finishIndex();
+        indexInfo_.fromSidecar = true;
+        return true;
+    }
+
+    bool FileSource::buildIndex() {
+        // Só demux (sem decodificar): pts, dts, posição e flags de cada pacote
+        AVPacket *packet = av_packet_alloc();
+        index_.clear();
+        bool missingTimestamps = false;
+        while (av_read_frame(formatContext_, packet) >= 0) {
+            if (packet->stream_index == videoStreamIndex_) {
+                const int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+                missingTimestamps |= pts == AV_NOPTS_VALUE;
+                index_.push_back({pts, packet->dts != AV_NOPTS_VALUE ? packet->dts : pts, packet->pos,
+                                  packet->flags});
+            }
+            av_packet_unref(packet);
+        }
+        av_packet_free(&packet);
+
+        const bool rewound = av_seek_frame(formatContext_, videoStreamIndex_,
+                                           index_.empty() ? 0 : index_.front().dts, AVSEEK_FLAG_BACKWARD) >= 0 ||
+                             (avio_seek(formatContext_->pb, 0, SEEK_SET) >= 0 && avformat_flush(formatContext_) >= 0);
+        if (!rewound) {
+            std::cerr << "FileSource::buildIndex() - Falha ao voltar ao início do arquivo" << std::endl;
+        }
+
+        // Sem timestamps (ex.: H.264 cru) o índice não serve para seek exato
+        if (missingTimestamps || index_.empty()) {
+            std::cerr << "FileSource::buildIndex() - Pacotes sem timestamp; seek sem índice" << std::endl;
+            index_.clear();
+            presentation_.clear();
+            keyframes_.clear();
+            indexInfo_ = IndexInfo{};
+            return false;
+        }
+
+        finishIndex();
+        return true;
+    }
+
+    void FileSource::finishIndex() {
+        presentation_.clear();
+        presentation_.reserve(index_.size());
+        keyframes_.clear();
+        indexInfo_ = IndexInfo{};
+        for (size_t i = 0; i < index_.size(); i++) {
+            presentation_.push_back(index_[i].pts);
+            if (index_[i].flags & AV_PKT_FLAG_KEY) {
+                keyframes_.push_back(i);
+            }
+        }
+        std::sort(presentation_.begin(), presentation_.end());
+        indexInfo_.keyframes = static_cast<int64_t>(keyframes_.size());
+        indexInfo_.frames = static_cast<int64_t>(index_.size());
+
+        // Keyframes por pts; com pts repetido vale o primeiro em ordem de decodificação
+        const auto byPts = [this](size_t a, size_t b) { return index_[a].pts < index_[b].pts; };
+        std::stable_sort(keyframes_.begin(), keyframes_.end(), byPts);
+        keyframes_.erase(std::unique(keyframes_.begin(), keyframes_.end(),
+                                     [this](size_t a, size_t b) { return index_[a].pts == index_[b].pts; }),
+                         keyframes_.end());
+    }
+
+    void FileSource::saveIndex() const {
+        int64_t size = 0;
+        int64_t time = 0;
+        if (!fileIdentity(fileConfig_.path, size, time)) {
+            return;
+        }
+
+        const AVRational timeBase = formatContext_->streams[videoStreamIndex_]->time_base;
+        IndexHeader header{};
+        header.magic = INDEX_MAGIC;
+        header.version = INDEX_VERSION;
+        header.fileSize = size;
+        header.fileTime = time;
+        header.streamIndex = videoStreamIndex_;
+        header.timeBaseNum = timeBase.num;
+        header.timeBaseDen = timeBase.den;
+        header.count = static_cast<int64_t>(index_.size());
+
+        // Escreve em um temporário e renomeia: um sidecar nunca fica pela metade
+        const std::string temporary = indexPath() + ".tmp";
+        FILE *file = std::fopen(temporary.c_str(), "wb");
+        if (!file) {
+            return;  // Diretório sem escrita: o índice fica só em memória
+        }
+        const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                             std::fwrite(index_.data(), sizeof(IndexEntry), index_.size(), file) == index_.size();
+        std::fclose(file);
+        if (!written || std::rename(temporary.c_str(), indexPath().c_str()) != 0) {
+            std::remove(temporary.c_str());
+        }
+    }
+
+    int FileSource::keyframeFor(int64_t pts) const {
+        // Último keyframe com pts <= pts
+        const auto next = std::upper_bound(keyframes_.begin(), keyframes_.end(), pts,
+                                           [this](int64_t value, size_t i) { return value < index_[i].pts; });
+        return next == keyframes_.begin() ? -1 : static_cast<int>(*(next - 1));
+    }
+
+    bool FileSource::seekToPts(int64_t target) {
+        if (!formatContext_ || !codecContext_) {
+            return false;
+        }
+
+        // Sem índice: seek do contêiner e descarte até o alvo
+        if (index_.empty()) {
+            if (av_seek_frame(formatContext_, videoStreamIndex_, target, AVSEEK_FLAG_BACKWARD) < 0) {
+                return false;
+            }
+            avcodec_flush_buffers(codecContext_);
+            skipUntil_ = target;
+            lastPts_ = AV_NOPTS_VALUE;
+            endOfFile_ = false;
+            return true;
+        }
+
+        // Frame em exibição no instante pedido
+        auto next = std::upper_bound(presentation_.begin(), presentation_.end(), target);
+        const int64_t framePts = next == presentation_.begin() ? presentation_.front() : *(next - 1);
+        const int keyframe = keyframeFor(framePts);
+
+        // Mesmo GOP e à frente do último frame entregue: só decodifica adiante
+        if (!endOfFile_ && lastPts_ != AV_NOPTS_VALUE && framePts > lastPts_ &&
+            keyframe >= 0 && keyframeFor(lastPts_) == keyframe) {
+            skipUntil_ = framePts;
+            return true;
+        }
+
+        int ret = -1;
+        if (keyframe >= 0) {
+            const IndexEntry &entry = index_[static_cast<size_t>(keyframe)];
+            const bool seekByPts = (formatContext_->iformat->flags & AVFMT_SEEK_TO_PTS) != 0;
+            ret = av_seek_frame(formatContext_, videoStreamIndex_, seekByPts ? entry.pts : entry.dts,
+                                AVSEEK_FLAG_BACKWARD);
+            if (ret < 0 && entry.position >= 0 && !(formatContext_->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+                ret = av_seek_frame(formatContext_, videoStreamIndex_, entry.position, AVSEEK_FLAG_BYTE);
+            }
+        }
+        if (ret < 0) {
+            ret = av_seek_frame(formatContext_, videoStreamIndex_, framePts, AVSEEK_FLAG_BACKWARD);
+        }
+        if (ret < 0) {
+            std::cerr << "FileSource::seekToPts() - Falha no seek para " << framePts << std::endl;
+            return false;
+        }
+
+        avcodec_flush_buffers(codecContext_);
+        skipUntil_ = framePts;
+        lastPts_ = AV_NOPTS_VALUE;
+        endOfFile_ = false;
+        return true;
+    }
+
+    int FileSource::decodeNext(AVPacket *packet, AVFrame *frame) {
+        while (true) {
+            int ret = avcodec_receive_frame(codecContext_, frame);
+            if (ret == 0) {
+                const int64_t pts = framePts(frame);
+                if (skipUntil_ != AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE && pts < skipUntil_) {
+                    av_frame_unref(frame);  // Antes do alvo: descartado sem copiar
+                    continue;
+                }
+                skipUntil_ = AV_NOPTS_VALUE;
+                lastPts_ = pts;
+                return 0;
+            }
+            if (ret != AVERROR(EAGAIN)) {
+                return ret;
+            }
+
+            const int64_t readStart = LatencyHistogram::now();
+            ret = av_read_frame(formatContext_, packet);
+            if (ret < 0) {
+                if (endOfFile_) {
+                    return AVERROR_EOF;
+                }
+                // Fim do arquivo: drena os frames que o decoder ainda segura
+                endOfFile_ = true;
+                avcodec_send_packet(codecContext_, nullptr);
+                continue;
+            }
+            stageHistograms_->packetRead.recordSince(readStart);
+            if (packet->stream_index != videoStreamIndex_) {
+                av_packet_unref(packet);
+                continue;
+            }
+
+            // Antes do alvo, frames que ninguém referencia nem são decodificados
+            const bool beforeTarget = skipUntil_ != AV_NOPTS_VALUE && packet->pts != AV_NOPTS_VALUE &&
+                                      packet->pts < skipUntil_;
+            codecContext_->skip_frame = beforeTarget ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+            ret = avcodec_send_packet(codecContext_, packet);
+            av_packet_unref(packet);
+            if (ret < 0 && ret != AVERROR(EAGAIN)) {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                std::cerr << "FileSource::decodeNext() - Pacote inválido: " << errbuf << std::endl;
+            }
+        }
+    }
+
+    int64_t FileSource::framePts(const AVFrame *frame) const {
+        return frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+    }
+
+    int64_t FileSource::sequenceFor(int64_t pts) const {
+        if (pts == AV_NOPTS_VALUE || presentation_.empty()) {
+            return -1;
+        }
+        return std::lower_bound(presentation_.begin(), presentation_.end(), pts) - presentation_.begin();
+    }
+
+    bool FileSource::parallelCaptureLoop() {
+        std::vector<std::unique_ptr<GopWorker>> workers;
+        for (int i = 0; i < fileConfig_.decodeWorkers; i++) {
+            auto worker = std::make_unique<GopWorker>();
+            if (!openWorker(*worker)) {
+                break;
+            }
+            workers.push_back(std::move(worker));
+        }
+        if (workers.size() < 2) {
+            std::cerr << "FileSource::parallelCaptureLoop() - Falha ao abrir workers; decodificação sequencial"
+                    << std::endl;
+            return false;
+        }
+
+        // GOPs na ordem de exibição dos keyframes
+        ParallelRun run;
+        std::vector<size_t> keyframes;
+        for (size_t i = 0; i < index_.size(); i++) {
+            if (index_[i].flags & AV_PKT_FLAG_KEY) {
+                keyframes.push_back(i);
+            }
+        }
+        std::sort(keyframes.begin(), keyframes.end(),
+                  [this](size_t a, size_t b) { return index_[a].pts < index_[b].pts; });
+        for (size_t keyframe: keyframes) {
+            const int64_t pts = run.gops.empty() ? presentation_.front() : index_[keyframe].pts;
+            run.gops.push_back({keyframe, pts, run.gops.empty() ? 0 : sequenceFor(pts), 0});
+        }
+        if (run.gops.empty()) {
+            return false;
+        }
+        run.totalFrames = static_cast<int64_t>(presentation_.size());
+        for (size_t i = 0; i < run.gops.size(); i++) {
+            const int64_t end = i + 1 < run.gops.size() ? run.gops[i + 1].firstSequence : run.totalFrames;
+            run.gops[i].frames = end - run.gops[i].firstSequence;
+        }
+
+        std::cout << "FileSource::parallelCaptureLoop() - " << workers.size() << " workers, "
+                << run.gops.size() << " GOPs" << std::endl;
+
+        // Um worker por thread do pool; cada tarefa roda até acabarem os GOPs
+        WorkerPool pool(workers.size());
+        const AVRational timeBase = formatContext_->streams[videoStreamIndex_]->time_base;
+        const bool ordered = fileConfig_.ordered;
+        int64_t startSequence = 0;
+        bool atEnd = false;
+
+        while (isRunning_) {
+            const int64_t target = pendingSeek_.exchange(AV_NOPTS_VALUE);
+            if (target != AV_NOPTS_VALUE) {
+                // Frame em exibição no instante pedido
+                const int64_t pts = av_rescale_q(target, AV_TIME_BASE_Q, timeBase);
+                const auto next = std::upper_bound(presentation_.begin(), presentation_.end(), pts);
+                startSequence = next == presentation_.begin() ? 0 : (next - presentation_.begin()) - 1;
+            } else if (atEnd) {
+                if (!fileConfig_.loop) {
+                    // Fim do arquivo: aguarda um seek ou stop()
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+                startSequence = 0;
+            }
+            atEnd = false;
+
+            run.nextGop = run.gopOf(startSequence);
+            run.activeWorkers = workers.size();
+            run.startSequence = startSequence;
+            run.startPts = presentation_[static_cast<size_t>(startSequence)];
+            run.nextSequence = startSequence;
+            run.ready.clear();
+            run.done.assign(run.gops.size(), 0);
+            run.abort = false;
+
+            for (auto &worker: workers) {
+                GopWorker *gopWorker = worker.get();
+                pool.post([this, gopWorker, &run] { workerLoop(*gopWorker, run); });
+            }
+
+            // Entrega: uma única thread chama o callback, como na sequencial
+            while (isRunning_ && pendingSeek_ == AV_NOPTS_VALUE) {
+                if (isPaused_) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+
+                FramePtr frame;
+                {
+                    std::unique_lock<std::mutex> lock(run.mutex);
+                    run.frameReady.wait_for(lock, std::chrono::milliseconds(10), [&run, ordered] {
+                        return run.deliverable(ordered) || run.finished();
+                    });
+                    frame = run.take(ordered);
+                    atEnd = !frame && run.finished();
+                }
+                if (atEnd) {
+                    break;
+                }
+                if (!frame) {
+                    continue;
+                }
+                run.spaceFree.notify_all();
+
+                std::lock_guard<std::mutex> lock(frameMutex_);
+                if (frameBus_) {
+                    frameBus_->publish(*frame);
+                }
+                if (frameCallback_) {
+                    const int64_t callbackStart = LatencyHistogram::now();
+                    frameCallback_(frame);
+                    stageHistograms_->callback.recordSince(callbackStart);
+                }
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(run.mutex);
+                run.abort = true;
+                run.spaceFree.notify_all();
+                run.frameReady.wait(lock, [&run] { return run.activeWorkers == 0; });
+            }
+        }
+        return true;
+    }
+
+    bool FileSource::openWorker(GopWorker &worker) const {
+        worker.formatContext = avformat_alloc_context();
+        if (!worker.formatContext) {
+            return false;
+        }
+        if (fileConfig_.useMmap && openMappedInput(worker.ioContext, worker.mappedFile)) {
+            worker.formatContext->pb = worker.ioContext;
+            worker.formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        }
+        if (avformat_open_input(&worker.formatContext, fileConfig_.path.c_str(), nullptr, nullptr) < 0) {
+            worker.formatContext = nullptr;  // Liberado por avformat_open_input
+            return false;
+        }
+        if (avformat_find_stream_info(worker.formatContext, nullptr) < 0 ||
+            videoStreamIndex_ >= static_cast<int>(worker.formatContext->nb_streams)) {
+            return false;
+        }
+        for (unsigned int i = 0; i < worker.formatContext->nb_streams; i++) {
+            if (static_cast<int>(i) != videoStreamIndex_) {
+                worker.formatContext->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+
+        // Paralelismo vem dos GOPs: uma thread por decoder, sempre em software
+        AVStream *stream = worker.formatContext->streams[videoStreamIndex_];
+        const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        worker.codecContext = decoder ? avcodec_alloc_context3(decoder) : nullptr;
+        if (!worker.codecContext || avcodec_parameters_to_context(worker.codecContext, stream->codecpar) < 0) {
+            return false;
+        }
+        worker.codecContext->pkt_timebase = stream->time_base;
+        worker.codecContext->thread_count = 1;
+        if (avcodec_open2(worker.codecContext, decoder, nullptr) < 0) {
+            return false;
+        }
+
+        worker.packet = av_packet_alloc();
+        worker.frame = av_frame_alloc();
+        return worker.packet && worker.frame;
+    }
+
+    void FileSource::workerLoop(GopWorker &worker, ParallelRun &run) {
+        const size_t maxBuffered = static_cast<size_t>(std::max(1, fileConfig_.maxBufferedFrames));
+        while (true) {
+            size_t gop;
+            {
+                // Só pega um GOP novo com espaço no buffer; um GOP já iniciado
+                // vai até o fim, então o próximo frame esperado sempre chega
+                std::unique_lock<std::mutex> lock(run.mutex);
+                run.spaceFree.wait(lock, [&run, maxBuffered] {
+                    return run.abort || run.ready.size() < maxBuffered;
+                });
+                if (run.abort || run.nextGop >= run.gops.size()) {
+                    break;
+                }
+                gop = run.nextGop++;
+            }
+
+            decodeGop(worker, run, gop);
+
+            {
+                std::lock_guard<std::mutex> lock(run.mutex);
+                run.done[gop] = 1;
+            }
+            run.frameReady.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(run.mutex);
+            run.activeWorkers--;
+        }
+        run.frameReady.notify_all();
+    }
+
+    void FileSource::decodeGop(GopWorker &worker, ParallelRun &run, size_t gop) {
+        const ParallelRun::Gop &range = run.gops[gop];
+        const int64_t noLimit = std::numeric_limits<int64_t>::max();
+        const int64_t endPts = gop + 1 < run.gops.size() ? run.gops[gop + 1].startPts : noLimit;
+        const int64_t limitPts = gop + 2 < run.gops.size() ? run.gops[gop + 2].startPts : noLimit;
+        const int64_t firstPts = std::max(range.startPts, run.startPts);
+        AVCodecContext *codec = worker.codecContext;
+        const AVRational timeBase = worker.formatContext->streams[videoStreamIndex_]->time_base;
+
+        const IndexEntry &keyframe = index_[range.keyframe];
+        const bool seekByPts = (worker.formatContext->iformat->flags & AVFMT_SEEK_TO_PTS) != 0;
+        int ret = av_seek_frame(worker.formatContext, videoStreamIndex_, seekByPts ? keyframe.pts : keyframe.dts,
+                                AVSEEK_FLAG_BACKWARD);
+        if (ret < 0 && keyframe.position >= 0 && !(worker.formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+            ret = av_seek_frame(worker.formatContext, videoStreamIndex_, keyframe.position, AVSEEK_FLAG_BYTE);
+        }
+        if (ret < 0) {
+            std::cerr << "FileSource::decodeGop() - Falha no seek para o GOP " << gop << std::endl;
+            return;
+        }
+        avcodec_flush_buffers(codec);
+
+        int64_t produced = 0;
+        bool draining = false;
+        bool resend = false;
+        while (produced < range.frames && !run.abort) {
+            ret = avcodec_receive_frame(codec, worker.frame);
+            if (ret == 0) {
+                decodeCounters_.decoded.fetch_add(1, std::memory_order_relaxed);
+                if ((worker.frame->flags & AV_FRAME_FLAG_CORRUPT) || worker.frame->decode_error_flags) {
+                    decodeCounters_.corrupt.fetch_add(1, std::memory_order_relaxed);
+                }
+                const int64_t pts = framePts(worker.frame);
+                if (pts == AV_NOPTS_VALUE || pts < range.startPts || pts >= endPts) {
+                    // B iniciais de GOP aberto ou frames do GOP seguinte
+                    av_frame_unref(worker.frame);
+                    if (pts != AV_NOPTS_VALUE && pts >= limitPts) {
+                        break;
+                    }
+                    continue;
+                }
+                produced++;
+
+                const int64_t sequence = sequenceFor(pts);
+                if (sequence >= run.startSequence) {
+                    try {
+                        const int64_t copyStart = LatencyHistogram::now();
+                        FramePtr frame = createFrameData(worker.frame, av_rescale_q(pts, timeBase, AV_TIME_BASE_Q));
+                        stageHistograms_->planeCopy.recordSince(copyStart);
+                        frame->setSequence(sequence);
+                        {
+                            std::lock_guard<std::mutex> lock(run.mutex);
+                            run.ready.emplace(sequence, std::move(frame));
+                        }
+                        run.frameReady.notify_one();
+                    } catch (const std::exception &e) {
+                        std::cerr << "FileSource::decodeGop() - Exceção: " << e.what() << std::endl;
+                        decodeCounters_.frameErrors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                av_frame_unref(worker.frame);
+                continue;
+            }
+            if (ret != AVERROR(EAGAIN) || draining) {
+                break;  // Fim do stream ou erro: frames faltantes são pulados na entrega
+            }
+
+            // Pacote recusado com EAGAIN é reenviado depois de esvaziar a saída
+            if (!resend) {
+                const int64_t readStart = LatencyHistogram::now();
+                ret = av_read_frame(worker.formatContext, worker.packet);
+                if (ret < 0) {
+                    draining = true;
+                    avcodec_send_packet(codec, nullptr);
+                    continue;
+                }
+                stageHistograms_->packetRead.recordSince(readStart);
+                if (worker.packet->stream_index != videoStreamIndex_) {
+                    av_packet_unref(worker.packet);
+                    continue;
+                }
+
+                // Fora do intervalo, frames que ninguém referencia nem são decodificados
+                const int64_t pts = worker.packet->pts;
+                const bool outside = pts != AV_NOPTS_VALUE && (pts < firstPts || pts >= endPts);
+                codec->skip_frame = outside ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+            }
+            ret = avcodec_send_packet(codec, worker.packet);
+            resend = ret == AVERROR(EAGAIN);
+            if (resend) {
+                continue;
+            }
+            av_packet_unref(worker.packet);
+            if (ret < 0) {
+                // GOP encerrado: o decoder entrega o que já tem e os frames
+                // faltantes são pulados na entrega
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                std::cerr << "FileSource::decodeGop() - Pacote inválido no GOP " << gop << ": " << errbuf << std::endl;
+                decodeCounters_.decodeErrors.fetch_add(1, std::memory_order_relaxed);
+                draining = true;
+                avcodec_send_packet(codec, nullptr);
+            }
+        }
+        if (resend) {
+            av_packet_unref(worker.packet);
+        }
+    }
+
+} // namespace turbovision
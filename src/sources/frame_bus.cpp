@@ -0,0 +1,709 @@
+#include "turbovision/sources/frame_bus.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <climits>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <linux/memfd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace turbovision {
+    namespace {
+        const uint32_t BUS_MAGIC = 0x31425654;    // "TVB1"
+        const uint32_t BUS_VERSION = 2;
+        const uint32_t LOCKED = 0x80000000u;      // Slot sendo escrito pelo produtor
+        const int PLANE_ALIGN = 64;
+        const int PAGE_SIZE = 4096;
+        const uint64_t RECLAIM_INTERVAL = 64;     // Frames entre buscas por leitores mortos
+
+        // Layout da memória compartilhada: cabeçalho, metadados dos slots,
+        // tabela de leitores e os slots (alinhados a página)
+        struct BusHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t slots;
+            uint32_t slotSize;
+            uint64_t metaOffset;
+            uint64_t readersOffset;
+            uint64_t dataOffset;
+            uint64_t totalSize;
+            std::atomic<uint32_t> closed;
+            alignas(64) std::atomic<uint64_t> latest;   // (sequência << 8) | slot; 0 = nenhum
+            std::atomic<uint32_t> futex;                // Incrementado a cada frame
+            std::atomic<uint32_t> waiters;              // Leitores em FUTEX_WAIT
+        };
+
+        struct alignas(64) SlotMeta {
+            std::atomic<uint32_t> refs;   // Referências de leitores ou LOCKED
+            int32_t format;
+            int32_t width;
+            int32_t height;
+            uint64_t sequence;
+            int64_t timestamp;
+            int32_t linesize[4];
+            uint32_t offset[4];           // Relativo ao início do slot
+        };
+
+        // Referências por leitor, para devolver as de um processo que morreu.
+        // pid é só informativo (pode ser de outro namespace de PID); a
+        // liveness é o lock OFD do leitor no byte do índice da entrada
+        struct alignas(64) ReaderEntry {
+            std::atomic<int32_t> pid;
+            std::atomic<uint32_t> held[FrameBus::MAX_SLOTS];
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "atomics compartilhados exigem lock-free");
+
+        uint64_t alignUp(uint64_t value, uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        // Visão da região mapeada (igual para produtor e leitores)
+        struct View {
+            uint8_t *base = nullptr;
+            size_t size = 0;
+
+            BusHeader *header() const { return reinterpret_cast<BusHeader *>(base); }
+
+            SlotMeta *meta(int slot) const {
+                return reinterpret_cast<SlotMeta *>(base + header()->metaOffset) + slot;
+            }
+
+            ReaderEntry *reader(int index) const {
+                return reinterpret_cast<ReaderEntry *>(base + header()->readersOffset) + index;
+            }
+
+            uint8_t *slotData(int slot) const {
+                return base + header()->dataOffset + static_cast<uint64_t>(slot) * header()->slotSize;
+            }
+        };
+
+#ifdef __linux__
+        void futexWake(std::atomic<uint32_t> *word) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        void futexWait(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs) {
+            timespec timeout{timeoutMs / 1000, static_cast<long>(timeoutMs % 1000) * 1000000L};
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+        }
+
+        int createMemory(size_t size) {
+            int fd = static_cast<int>(syscall(SYS_memfd_create, "turbovision-frame-bus", MFD_CLOEXEC));
+            if (fd < 0) {
+                // Kernels sem memfd: objeto shm anônimo (removido logo após abrir)
+                const std::string name = "/turbovision-" + std::to_string(getpid()) + "-" +
+                                         std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+                fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+                if (fd >= 0) {
+                    shm_unlink(name.c_str());
+                }
+            }
+            if (fd >= 0 && ftruncate(fd, static_cast<off_t>(size)) < 0) {
+                close(fd);
+                fd = -1;
+            }
+            return fd;
+        }
+
+        bool mapMemory(int fd, size_t size, View &view) {
+            void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) {
+                return false;
+            }
+            view.base = static_cast<uint8_t *>(base);
+            view.size = size;
+            return true;
+        }
+
+        void unmapMemory(View &view) {
+            if (view.base) {
+                munmap(view.base, view.size);
+                view.base = nullptr;
+            }
+        }
+
+        // Lock OFD (open file description) no byte da entrada do leitor. O
+        // kernel solta o lock quando o último fd da descrição fecha, ou seja,
+        // quando o processo morre, sem depender de PIDs nem de namespaces.
+        // O fd recebido por SCM_RIGHTS compartilha a descrição do produtor
+        // (locks da mesma descrição não conflitam), por isso o leitor reabre
+        // a memória por /proc/self/fd.
+        bool lockReaderEntry(int fd, int index) {
+            struct flock lock{};
+            lock.l_type = F_WRLCK;
+            lock.l_whence = SEEK_SET;
+            lock.l_start = index;
+            lock.l_len = 1;
+            return fcntl(fd, F_OFD_SETLK, &lock) == 0;
+        }
+
+        void unlockReaderEntry(int fd, int index) {
+            struct flock lock{};
+            lock.l_type = F_UNLCK;
+            lock.l_whence = SEEK_SET;
+            lock.l_start = index;
+            lock.l_len = 1;
+            fcntl(fd, F_OFD_SETLK, &lock);
+        }
+
+        // Conferido pelo produtor na própria descrição: algum leitor vivo segura o byte
+        bool readerEntryLocked(int fd, int index) {
+            struct flock lock{};
+            lock.l_type = F_WRLCK;
+            lock.l_whence = SEEK_SET;
+            lock.l_start = index;
+            lock.l_len = 1;
+            if (fcntl(fd, F_OFD_GETLK, &lock) < 0) {
+                return true; // Na dúvida o leitor é mantido
+            }
+            return lock.l_type != F_UNLCK;
+        }
+
+        bool sendFd(int sock, int fd, uint64_t size) {
+            iovec io{&size, sizeof(size)};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+            msghdr message{};
+            message.msg_iov = &io;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            cmsghdr *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+            return sendmsg(sock, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(size));
+        }
+
+        int receiveFd(int sock) {
+            uint64_t size = 0;
+            iovec io{&size, sizeof(size)};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+            msghdr message{};
+            message.msg_iov = &io;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            if (recvmsg(sock, &message, MSG_CMSG_CLOEXEC) <= 0) {
+                return -1;
+            }
+            cmsghdr *header = CMSG_FIRSTHDR(&message);
+            if (!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+                return -1;
+            }
+            int fd = -1;
+            std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+            return fd;
+        }
+#endif
+    }
+
+    struct FrameBus::Region {
+        View view;
+    };
+
+    struct FrameBusReader::Mapping {
+        View view;
+        int fd = -1;
+        int lockFd = -1;          // Descrição própria que segura o lock da entrada
+        int readerIndex = -1;
+
+        ~Mapping() {
+#ifdef __linux__
+            if (view.base && readerIndex >= 0) {
+                view.reader(readerIndex)->pid.store(0);
+            }
+            unmapMemory(view);
+            if (lockFd >= 0) {
+                close(lockFd);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+#endif
+        }
+    };
+
+    FrameBus::FrameBus(const Settings &settings)
+        : settings_(settings)
+          , fd_(-1)
+          , sequence_(0)
+          , nextSlot_(0)
+          , listenSocket_(-1)
+          , running_(false)
+          , published_(0)
+          , dropped_(0)
+          , reclaimed_(0) {
+        settings_.slots = std::min(std::max(settings_.slots, 2), MAX_SLOTS);
+        settings_.slotSize = static_cast<int>(alignUp(static_cast<uint64_t>(std::max(settings_.slotSize, PAGE_SIZE)),
+                                                      PAGE_SIZE));
+    }
+
+    FrameBus::~FrameBus() {
+        stop();
+    }
+
+    bool FrameBus::start() {
+#ifndef __linux__
+        std::cerr << "FrameBus::start() - Suportado apenas no Linux" << std::endl;
+        return false;
+#else
+        if (running_) {
+            return false;
+        }
+
+        const uint64_t metaOffset = alignUp(sizeof(BusHeader), 64);
+        const uint64_t readersOffset = metaOffset + sizeof(SlotMeta) * static_cast<uint64_t>(settings_.slots);
+        const uint64_t dataOffset = alignUp(readersOffset + sizeof(ReaderEntry) * MAX_READERS, PAGE_SIZE);
+        const uint64_t totalSize = dataOffset + static_cast<uint64_t>(settings_.slotSize) * settings_.slots;
+
+        fd_ = createMemory(totalSize);
+        auto region = std::make_unique<Region>();
+        if (fd_ < 0 || !mapMemory(fd_, totalSize, region->view)) {
+            std::cerr << "FrameBus::start() - Falha ao criar memória compartilhada: " << std::strerror(errno) << std::endl;
+            if (fd_ >= 0) {
+                close(fd_);
+                fd_ = -1;
+            }
+            return false;
+        }
+
+        // A memória nova vem zerada: slots livres, nenhum leitor
+        BusHeader *header = region->view.header();
+        header->version = BUS_VERSION;
+        header->slots = static_cast<uint32_t>(settings_.slots);
+        header->slotSize = static_cast<uint32_t>(settings_.slotSize);
+        header->metaOffset = metaOffset;
+        header->readersOffset = readersOffset;
+        header->dataOffset = dataOffset;
+        header->totalSize = totalSize;
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = BUS_MAGIC;
+        region_ = std::move(region);
+        sequence_ = 0;
+
+        if (!settings_.socketPath.empty()) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (settings_.socketPath.size() >= sizeof(address.sun_path)) {
+                std::cerr << "FrameBus::start() - Caminho do socket muito longo" << std::endl;
+                stop();
+                return false;
+            }
+            std::strncpy(address.sun_path, settings_.socketPath.c_str(), sizeof(address.sun_path) - 1);
+            unlink(settings_.socketPath.c_str());
+
+            listenSocket_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (listenSocket_ < 0 ||
+                bind(listenSocket_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+                listen(listenSocket_, MAX_READERS) < 0) {
+                std::cerr << "FrameBus::start() - Falha no socket " << settings_.socketPath
+                        << ": " << std::strerror(errno) << std::endl;
+                stop();
+                return false;
+            }
+        }
+
+        running_ = true;
+        if (listenSocket_ >= 0) {
+            acceptThread_ = std::thread(&FrameBus::acceptLoop, this);
+        }
+        return true;
+#endif
+    }
+
+    void FrameBus::stop() {
+#ifdef __linux__
+        running_ = false;
+        if (acceptThread_.joinable()) {
+            acceptThread_.join();
+        }
+        if (listenSocket_ >= 0) {
+            close(listenSocket_);
+            listenSocket_ = -1;
+            unlink(settings_.socketPath.c_str());
+        }
+
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        if (region_) {
+            // Leitores mantêm o próprio mapeamento; só avisa quem está esperando
+            BusHeader *header = region_->view.header();
+            header->closed.store(1);
+            header->futex.fetch_add(1);
+            futexWake(&header->futex);
+            unmapMemory(region_->view);
+            region_.reset();
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+#endif
+    }
+
+    bool FrameBus::publish(const AVFrame *frame, int64_t timestamp) {
+        if (!frame || frame->hw_frames_ctx) {
+            return false;
+        }
+        const uint8_t *planes[4] = {frame->data[0], frame->data[1], frame->data[2], frame->data[3]};
+        return publishSlot(frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                           timestamp, planes, frame->linesize);
+    }
+
+    bool FrameBus::publish(const FrameData &frame) {
+        uint8_t *planes[4] = {};
+        int linesize[4] = {};
+        if (av_image_fill_arrays(planes, linesize, frame.data(), frame.format(),
+                                 frame.width(), frame.height(), 1) < 0) {
+            return false;
+        }
+        const uint8_t *source[4] = {planes[0], planes[1], planes[2], planes[3]};
+        return publishSlot(frame.width(), frame.height(), frame.format(), frame.timestamp(), source, linesize);
+    }
+
+    FrameBus::Stats FrameBus::getStats() const {
+        Stats stats{};
+        stats.published = published_;
+        stats.dropped = dropped_;
+        stats.reclaimed = reclaimed_;
+
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        if (region_) {
+            const View &view = region_->view;
+            for (int i = 0; i < MAX_READERS; i++) {
+                stats.readers += view.reader(i)->pid.load() != 0 ? 1 : 0;
+            }
+            for (int slot = 0; slot < settings_.slots; slot++) {
+                stats.slotsInUse += view.meta(slot)->refs.load() != 0 ? 1 : 0;
+            }
+        }
+        return stats;
+    }
+
+    void FrameBus::acceptLoop() {
+#ifdef __linux__
+        while (running_) {
+            pollfd descriptor{listenSocket_, POLLIN, 0};
+            if (poll(&descriptor, 1, 200) <= 0) {
+                continue;
+            }
+            const int client = accept4(listenSocket_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                continue;
+            }
+            if (!sendFd(client, fd_, region_->view.size)) {
+                std::cerr << "FrameBus - Falha ao enviar fd: " << std::strerror(errno) << std::endl;
+            }
+            close(client);
+        }
+#endif
+    }
+
+    int FrameBus::claimSlot() {
+        const View &view = region_->view;
+        const uint64_t latest = view.header()->latest.load(std::memory_order_relaxed);
+        const int latestSlot = latest != 0 ? static_cast<int>(latest & 0xff) : -1;
+
+        // Preserva o último frame publicado para quem ainda vai buscá-lo;
+        // o slot dele só é reutilizado se não houver outro livre
+        for (int i = 0; i <= settings_.slots; i++) {
+            const int slot = i < settings_.slots ? (nextSlot_ + i) % settings_.slots : latestSlot;
+            if (slot < 0 || (slot == latestSlot && i < settings_.slots)) {
+                continue;
+            }
+            uint32_t expected = 0;
+            if (view.meta(slot)->refs.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire)) {
+                nextSlot_ = (slot + 1) % settings_.slots;
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    void FrameBus::reclaimDeadReaders() {
+#ifdef __linux__
+        const View &view = region_->view;
+        for (int i = 0; i < MAX_READERS; i++) {
+            ReaderEntry *reader = view.reader(i);
+            // O leitor trava o byte antes de ocupar a entrada: ocupada e sem
+            // lock significa que o processo morreu
+            if (reader->pid.load() == 0 || readerEntryLocked(fd_, i)) {
+                continue;
+            }
+            for (int slot = 0; slot < settings_.slots; slot++) {
+                const uint32_t held = reader->held[slot].exchange(0);
+                if (held > 0) {
+                    view.meta(slot)->refs.fetch_sub(held, std::memory_order_release);
+                    reclaimed_ += held;
+                }
+            }
+            reader->pid.store(0);
+        }
+#endif
+    }
+
+    bool FrameBus::publishSlot(int width, int height, AVPixelFormat format, int64_t timestamp,
+                               const uint8_t *const source[4], const int sourceLinesize[4]) {
+#ifndef __linux__
+        return false;
+#else
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        if (!region_) {
+            return false;
+        }
+
+        const int required = av_image_get_buffer_size(format, width, height, PLANE_ALIGN);
+        if (required < 0 || required > settings_.slotSize) {
+            dropped_++;
+            return false;
+        }
+
+        if (sequence_ % RECLAIM_INTERVAL == 0) {
+            reclaimDeadReaders();
+        }
+        int slot = claimSlot();
+        if (slot < 0) {
+            reclaimDeadReaders();
+            slot = claimSlot();
+        }
+        if (slot < 0) {
+            dropped_++;
+            return false;
+        }
+
+        const View &view = region_->view;
+        SlotMeta *meta = view.meta(slot);
+        uint8_t *base = view.slotData(slot);
+
+        uint8_t *planes[4] = {};
+        int linesize[4] = {};
+        av_image_fill_arrays(planes, linesize, base, format, width, height, PLANE_ALIGN);
+        const uint8_t *sourcePlanes[4] = {source[0], source[1], source[2], source[3]};
+        av_image_copy(planes, linesize, sourcePlanes, sourceLinesize, format, width, height);
+
+        meta->format = format;
+        meta->width = width;
+        meta->height = height;
+        meta->timestamp = timestamp;
+        meta->sequence = ++sequence_;
+        for (int i = 0; i < 4; i++) {
+            meta->linesize[i] = planes[i] ? linesize[i] : 0;
+            meta->offset[i] = planes[i] ? static_cast<uint32_t>(planes[i] - base) : 0;
+        }
+        meta->refs.store(0, std::memory_order_release);
+
+        // Publica e acorda leitores em waitFrame() (syscall só se houver algum)
+        BusHeader *header = view.header();
+        header->latest.store(sequence_ << 8 | static_cast<uint64_t>(slot));
+        header->futex.fetch_add(1);
+        if (header->waiters.load() > 0) {
+            futexWake(&header->futex);
+        }
+        published_++;
+        return true;
+#endif
+    }
+
+    FrameBusReader::FrameBusReader()
+        : lastSequence_(0) {
+    }
+
+    FrameBusReader::~FrameBusReader() {
+        disconnect();
+    }
+
+    bool FrameBusReader::connect(const std::string &socketPath) {
+#ifndef __linux__
+        return false;
+#else
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        const int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (sock < 0) {
+            return false;
+        }
+        int fd = -1;
+        if (::connect(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+            fd = receiveFd(sock);
+        }
+        close(sock);
+
+        if (fd < 0) {
+            std::cerr << "FrameBusReader::connect() - Falha ao receber fd de " << socketPath << std::endl;
+            return false;
+        }
+        return attach(fd);
+#endif
+    }
+
+    bool FrameBusReader::attach(int fd) {
+#ifndef __linux__
+        return false;
+#else
+        disconnect();
+
+        auto mapping = std::make_shared<Mapping>();
+        mapping->fd = fd;
+
+        struct stat status{};
+        if (fstat(fd, &status) < 0 || status.st_size < static_cast<off_t>(sizeof(BusHeader)) ||
+            !mapMemory(fd, static_cast<size_t>(status.st_size), mapping->view)) {
+            std::cerr << "FrameBusReader::attach() - Falha ao mapear a memória" << std::endl;
+            return false;
+        }
+
+        const BusHeader *header = mapping->view.header();
+        if (header->magic != BUS_MAGIC || header->version != BUS_VERSION ||
+            header->totalSize > mapping->view.size) {
+            std::cerr << "FrameBusReader::attach() - Memória não é um FrameBus compatível" << std::endl;
+            return false;
+        }
+
+        const std::string path = "/proc/self/fd/" + std::to_string(fd);
+        mapping->lockFd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (mapping->lockFd < 0) {
+            std::cerr << "FrameBusReader::attach() - Falha ao reabrir a memória: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        // Lock antes de ocupar a entrada, para o produtor nunca ver uma
+        // entrada ocupada sem lock de um leitor vivo
+        for (int i = 0; i < FrameBus::MAX_READERS && mapping->readerIndex < 0; i++) {
+            if (!lockReaderEntry(mapping->lockFd, i)) {
+                continue;
+            }
+            int32_t expected = 0;
+            if (mapping->view.reader(i)->pid.compare_exchange_strong(expected, static_cast<int32_t>(getpid()))) {
+                mapping->readerIndex = i;
+            } else {
+                unlockReaderEntry(mapping->lockFd, i);
+            }
+        }
+        if (mapping->readerIndex < 0) {
+            std::cerr << "FrameBusReader::attach() - Limite de leitores atingido" << std::endl;
+            return false;
+        }
+
+        mapping_ = std::move(mapping);
+        lastSequence_ = 0;
+        return true;
+#endif
+    }
+
+    void FrameBusReader::disconnect() {
+        mapping_.reset();
+    }
+
+    FrameBusReader::SharedFramePtr FrameBusReader::acquireLatest() {
+        if (!mapping_) {
+            return nullptr;
+        }
+        const View &view = mapping_->view;
+        BusHeader *header = view.header();
+
+        // Poucas tentativas: só falha se o produtor reciclar o slot entre a
+        // leitura de latest e a referência
+        for (int attempt = 0; attempt < 4; attempt++) {
+            const uint64_t latest = header->latest.load();
+            const uint64_t sequence = latest >> 8;
+            const int slot = static_cast<int>(latest & 0xff);
+            if (latest == 0 || sequence <= lastSequence_ || slot >= static_cast<int>(header->slots)) {
+                return nullptr;
+            }
+
+            SlotMeta *meta = view.meta(slot);
+            uint32_t refs = meta->refs.load(std::memory_order_relaxed);
+            bool acquired = false;
+            while (!(refs & LOCKED)) {
+                if (meta->refs.compare_exchange_weak(refs, refs + 1, std::memory_order_acquire)) {
+                    acquired = true;
+                    break;
+                }
+            }
+            if (!acquired) {
+                continue;
+            }
+            if (meta->sequence != sequence) {
+                meta->refs.fetch_sub(1, std::memory_order_release);
+                continue;
+            }
+            view.reader(mapping_->readerIndex)->held[slot].fetch_add(1);
+
+            auto *frame = new Frame{};
+            frame->width = meta->width;
+            frame->height = meta->height;
+            frame->format = static_cast<AVPixelFormat>(meta->format);
+            frame->timestamp = meta->timestamp;
+            frame->sequence = sequence;
+            const uint8_t *base = view.slotData(slot);
+            for (int i = 0; i < 4; i++) {
+                frame->data[i] = meta->linesize[i] > 0 ? base + meta->offset[i] : nullptr;
+                frame->linesize[i] = meta->linesize[i];
+            }
+            lastSequence_ = sequence;
+
+            // O frame segura o mapeamento; liberar devolve o slot ao produtor
+            std::shared_ptr<Mapping> mapping = mapping_;
+            return SharedFramePtr(frame, [mapping, slot](const Frame *released) {
+                const View &mapped = mapping->view;
+                mapped.reader(mapping->readerIndex)->held[slot].fetch_sub(1);
+                mapped.meta(slot)->refs.fetch_sub(1, std::memory_order_release);
+                delete released;
+            });
+        }
+        return nullptr;
+    }
+
+    FrameBusReader::SharedFramePtr FrameBusReader::waitFrame(int timeoutMs) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (mapping_) {
+            if (SharedFramePtr frame = acquireLatest()) {
+                return frame;
+            }
+            BusHeader *header = mapping_->view.header();
+            const int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (header->closed.load() || remaining <= 0) {
+                return nullptr;
+            }
+
+#ifdef __linux__
+            // Registra a espera antes de conferir latest de novo: um publish
+            // entre as duas leituras muda futex e o FUTEX_WAIT retorna na hora
+            const uint32_t value = header->futex.load();
+            header->waiters.fetch_add(1);
+            if ((header->latest.load() >> 8) <= lastSequence_) {
+                futexWait(&header->futex, value, remaining);
+            }
+            header->waiters.fetch_sub(1);
+#endif
+        }
+        return nullptr;
+    }
+
+    bool FrameBusReader::isClosed() const {
+        return !mapping_ || mapping_->view.header()->closed.load() != 0;
+    }
+
+} // namespace turbovision
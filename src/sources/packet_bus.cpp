@@ -0,0 +1,568 @@
+#include "turbovision/sources/packet_bus.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <climits>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace turbovision {
+    namespace {
+        const uint32_t BUS_MAGIC = 0x31505654;    // "TVP1"
+        const uint32_t BUS_VERSION = 2;
+        const int EXTRADATA_MAX = 16384;
+        const int RECORD_ALIGN = 32;
+        const uint16_t RECORD_PADDING = 0x8000;   // Fim do ring: pular para o início
+        const int PAGE_SIZE = 4096;
+
+        // Parâmetros do stream (seqlock em BusHeader::streamSequence)
+        struct StreamBlock {
+            uint32_t generation;
+            int32_t codecType;
+            int32_t codecId;
+            uint32_t codecTag;
+            int32_t width;
+            int32_t height;
+            int32_t format;
+            int32_t profile;
+            int32_t level;
+            int64_t bitRate;
+            int32_t timeBaseNum;
+            int32_t timeBaseDen;
+            int32_t extradataSize;
+            uint8_t extradata[EXTRADATA_MAX];
+        };
+
+        struct BusHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t capacity;
+            uint64_t dataOffset;
+            std::atomic<uint32_t> closed;
+            std::atomic<uint32_t> streamSequence;         // Ímpar durante setStream()
+            StreamBlock stream;
+            alignas(64) std::atomic<uint64_t> writePosition;
+            std::atomic<uint64_t> reclaimPosition;    // Abaixo disso o ring pode ter sido sobrescrito
+            std::atomic<uint64_t> keyframePosition;   // Último keyframe + 1 (0 = nenhum)
+            alignas(64) std::atomic<uint32_t> futex;  // Incrementado a cada pacote
+            std::atomic<uint32_t> waiters;
+        };
+
+        // Registro no ring; posições são absolutas (bytes desde o início)
+        struct RecordHeader {
+            uint32_t size;
+            uint16_t flags;           // AV_PKT_FLAG_* ou RECORD_PADDING
+            uint16_t generation;
+            int64_t pts;
+            int64_t dts;
+            int64_t duration;
+        };
+        static_assert(sizeof(RecordHeader) == RECORD_ALIGN, "cabeçalho de registro com padding");
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "atomics compartilhados exigem lock-free");
+
+        uint64_t alignUp(uint64_t value, uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        std::string sharedMemoryName(const std::string &name) {
+            std::string sanitized = name;
+            std::replace(sanitized.begin(), sanitized.end(), '/', '_');
+            return "/turbovision-packets-" + sanitized;
+        }
+
+#ifdef __linux__
+        void futexWake(std::atomic<uint32_t> *word) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        void futexWait(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs) {
+            timespec timeout{timeoutMs / 1000, static_cast<long>(timeoutMs % 1000) * 1000000L};
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+        }
+
+        // Liveness do escritor: lock OFD no primeiro byte da memória, solto
+        // pelo kernel quando o fd fecha (stop ou morte do processo). Não
+        // depende de PIDs, então vale entre namespaces e com PID reciclado.
+        bool lockWriter(int fd) {
+            struct flock lock{};
+            lock.l_type = F_WRLCK;
+            lock.l_whence = SEEK_SET;
+            lock.l_start = 0;
+            lock.l_len = 1;
+            return fcntl(fd, F_OFD_SETLK, &lock) == 0;
+        }
+
+        // Conferido pelo leitor na própria descrição (shm_open separado)
+        bool writerLocked(int fd) {
+            struct flock lock{};
+            lock.l_type = F_RDLCK;
+            lock.l_whence = SEEK_SET;
+            lock.l_start = 0;
+            lock.l_len = 1;
+            if (fcntl(fd, F_OFD_GETLK, &lock) < 0) {
+                return true; // Na dúvida o escritor é mantido
+            }
+            return lock.l_type != F_UNLCK;
+        }
+#endif
+    }
+
+    struct PacketBus::Region {
+        uint8_t *base = nullptr;
+        size_t size = 0;
+        int fd = -1;              // Mantido aberto: segura o lock de liveness
+
+        BusHeader *header() const { return reinterpret_cast<BusHeader *>(base); }
+        uint8_t *data() const { return base + header()->dataOffset; }
+    };
+
+    struct PacketBusReader::Mapping {
+        uint8_t *base = nullptr;
+        size_t size = 0;
+        int fd = -1;              // Descrição própria para sondar o lock do escritor
+
+        BusHeader *header() const { return reinterpret_cast<BusHeader *>(base); }
+        const uint8_t *data() const { return base + header()->dataOffset; }
+
+        ~Mapping() {
+#ifdef __linux__
+            if (base) {
+                munmap(base, size);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+#endif
+        }
+    };
+
+    PacketBus::PacketBus(const Settings &settings)
+        : settings_(settings)
+          , packets_(0)
+          , bytes_(0)
+          , dropped_(0) {
+        settings_.capacity = static_cast<int>(alignUp(static_cast<uint64_t>(std::max(settings_.capacity, 64 * 1024)),
+                                                      PAGE_SIZE));
+    }
+
+    PacketBus::~PacketBus() {
+        stop();
+    }
+
+    bool PacketBus::start() {
+#ifndef __linux__
+        std::cerr << "PacketBus::start() - Suportado apenas no Linux" << std::endl;
+        return false;
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (region_) {
+            return false;
+        }
+        if (settings_.name.empty()) {
+            std::cerr << "PacketBus::start() - Nome do stream vazio" << std::endl;
+            return false;
+        }
+
+        // Um objeto antigo (escritor que morreu) é substituído; leitores
+        // ainda mapeados nele o veem como fechado
+        shmName_ = sharedMemoryName(settings_.name);
+        shm_unlink(shmName_.c_str());
+
+        const uint64_t dataOffset = alignUp(sizeof(BusHeader), PAGE_SIZE);
+        const uint64_t totalSize = dataOffset + static_cast<uint64_t>(settings_.capacity);
+        const int fd = shm_open(shmName_.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0660);
+        if (fd < 0 || ftruncate(fd, static_cast<off_t>(totalSize)) < 0 || !lockWriter(fd)) {
+            std::cerr << "PacketBus::start() - Falha ao criar " << shmName_ << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) {
+                close(fd);
+                shm_unlink(shmName_.c_str());
+            }
+            return false;
+        }
+        void *base = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            shm_unlink(shmName_.c_str());
+            return false;
+        }
+
+        auto region = std::make_unique<Region>();
+        region->base = static_cast<uint8_t *>(base);
+        region->size = totalSize;
+        region->fd = fd;
+
+        BusHeader *header = region->header();
+        header->version = BUS_VERSION;
+        header->capacity = static_cast<uint64_t>(settings_.capacity);
+        header->dataOffset = dataOffset;
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = BUS_MAGIC;
+
+        region_ = std::move(region);
+        packets_ = 0;
+        bytes_ = 0;
+        dropped_ = 0;
+        return true;
+#endif
+    }
+
+    void PacketBus::stop() {
+#ifdef __linux__
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!region_) {
+            return;
+        }
+        BusHeader *header = region_->header();
+        header->closed.store(1);
+        header->futex.fetch_add(1);
+        futexWake(&header->futex);
+
+        munmap(region_->base, region_->size);
+        close(region_->fd);
+        region_.reset();
+        shm_unlink(shmName_.c_str());
+#endif
+    }
+
+    bool PacketBus::setStream(const AVCodecParameters *parameters, AVRational timeBase) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!region_ || !parameters) {
+            return false;
+        }
+        if (parameters->extradata_size > EXTRADATA_MAX) {
+            std::cerr << "PacketBus::setStream() - Extradata maior que " << EXTRADATA_MAX << " bytes" << std::endl;
+            return false;
+        }
+
+        BusHeader *header = region_->header();
+        StreamBlock &stream = header->stream;
+        const uint32_t sequence = header->streamSequence.load(std::memory_order_relaxed);
+        header->streamSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        stream.generation++;
+        stream.codecType = parameters->codec_type;
+        stream.codecId = parameters->codec_id;
+        stream.codecTag = parameters->codec_tag;
+        stream.width = parameters->width;
+        stream.height = parameters->height;
+        stream.format = parameters->format;
+        stream.profile = parameters->profile;
+        stream.level = parameters->level;
+        stream.bitRate = parameters->bit_rate;
+        stream.timeBaseNum = timeBase.num;
+        stream.timeBaseDen = timeBase.den;
+        stream.extradataSize = parameters->extradata ? parameters->extradata_size : 0;
+        if (stream.extradataSize > 0) {
+            std::memcpy(stream.extradata, parameters->extradata, static_cast<size_t>(stream.extradataSize));
+        }
+
+        header->streamSequence.store(sequence + 2, std::memory_order_release);
+
+        // Leitores novos não devem começar no keyframe da geração anterior
+        header->keyframePosition.store(0, std::memory_order_release);
+        return true;
+    }
+
+    bool PacketBus::publish(const AVPacket *packet) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!region_ || !packet || packet->size < 0) {
+            return false;
+        }
+
+        BusHeader *header = region_->header();
+        const uint64_t capacity = header->capacity;
+        const uint64_t length = RECORD_ALIGN + alignUp(static_cast<uint64_t>(packet->size), RECORD_ALIGN);
+        if (length > capacity / 2) {
+            dropped_++;
+            return false;
+        }
+
+        // Registro não cabe até o fim do ring: preenche e recomeça no início
+        const uint64_t position = header->writePosition.load(std::memory_order_relaxed);
+        const uint64_t offset = position % capacity;
+        const uint64_t padding = offset + length > capacity ? capacity - offset : 0;
+        const uint64_t end = position + padding + length;
+
+        // Anuncia o trecho que será sobrescrito antes de escrever
+        if (end > capacity) {
+            header->reclaimPosition.store(end - capacity, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        uint8_t *data = region_->data();
+        const uint16_t generation = static_cast<uint16_t>(header->stream.generation);
+        if (padding > 0) {
+            const RecordHeader record{static_cast<uint32_t>(padding - RECORD_ALIGN), RECORD_PADDING, generation, 0, 0, 0};
+            std::memcpy(data + offset, &record, sizeof(record));
+        }
+
+        const uint64_t recordPosition = position + padding;
+        uint8_t *target = data + recordPosition % capacity;
+        const RecordHeader record{static_cast<uint32_t>(packet->size),
+                                  static_cast<uint16_t>(packet->flags & 0x7fff), generation,
+                                  packet->pts, packet->dts, packet->duration};
+        std::memcpy(target, &record, sizeof(record));
+        if (packet->size > 0) {
+            std::memcpy(target + RECORD_ALIGN, packet->data, static_cast<size_t>(packet->size));
+        }
+
+        header->writePosition.store(end, std::memory_order_release);
+        if (packet->flags & AV_PKT_FLAG_KEY) {
+            header->keyframePosition.store(recordPosition + 1, std::memory_order_release);
+        }
+
+#ifdef __linux__
+        header->futex.fetch_add(1);
+        if (header->waiters.load() > 0) {
+            futexWake(&header->futex);
+        }
+#endif
+        packets_++;
+        bytes_ += packet->size;
+        return true;
+    }
+
+    PacketBus::Stats PacketBus::getStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats{};
+        stats.packets = packets_;
+        stats.bytes = bytes_;
+        stats.dropped = dropped_;
+        stats.generation = region_ ? region_->header()->stream.generation : 0;
+        return stats;
+    }
+
+    PacketBusReader::PacketBusReader()
+        : cursor_(0)
+          , generation_(0)
+          , overruns_(0) {
+    }
+
+    PacketBusReader::~PacketBusReader() {
+        detach();
+    }
+
+    bool PacketBusReader::attach(const std::string &name) {
+#ifndef __linux__
+        return false;
+#else
+        detach();
+
+        const std::string shmName = sharedMemoryName(name);
+        const int fd = shm_open(shmName.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) {
+            std::cerr << "PacketBusReader::attach() - Stream " << name << " não encontrado" << std::endl;
+            return false;
+        }
+
+        struct stat status{};
+        auto mapping = std::make_unique<Mapping>();
+        if (fstat(fd, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(BusHeader))) {
+            void *base = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base != MAP_FAILED) {
+                mapping->base = static_cast<uint8_t *>(base);
+                mapping->size = static_cast<size_t>(status.st_size);
+            }
+        }
+        mapping->fd = fd;
+
+        if (!mapping->base || mapping->header()->magic != BUS_MAGIC || mapping->header()->version != BUS_VERSION ||
+            mapping->header()->dataOffset + mapping->header()->capacity > mapping->size) {
+            std::cerr << "PacketBusReader::attach() - " << shmName << " não é um PacketBus compatível" << std::endl;
+            return false;
+        }
+
+        mapping_ = std::move(mapping);
+        overruns_ = 0;
+        generation_ = static_cast<uint16_t>(mapping_->header()->stream.generation);
+        resync();
+        return true;
+#endif
+    }
+
+    void PacketBusReader::detach() {
+        mapping_.reset();
+    }
+
+    bool PacketBusReader::getStream(AVCodecParameters *parameters, AVRational *timeBase) {
+        if (!mapping_ || !parameters) {
+            return false;
+        }
+
+        // Cópia consistente: repete se o escritor mudou o bloco no meio
+        BusHeader *header = mapping_->header();
+        auto stream = std::make_unique<StreamBlock>();
+        bool consistent = false;
+        for (int attempt = 0; attempt < 100 && !consistent; attempt++) {
+            const uint32_t before = header->streamSequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(stream.get(), &header->stream, sizeof(StreamBlock));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            consistent = header->streamSequence.load(std::memory_order_relaxed) == before;
+        }
+        if (!consistent || stream->generation == 0 ||
+            stream->extradataSize < 0 || stream->extradataSize > EXTRADATA_MAX) {
+            return false;
+        }
+
+        parameters->codec_type = static_cast<AVMediaType>(stream->codecType);
+        parameters->codec_id = static_cast<AVCodecID>(stream->codecId);
+        parameters->codec_tag = stream->codecTag;
+        parameters->width = stream->width;
+        parameters->height = stream->height;
+        parameters->format = stream->format;
+        parameters->profile = stream->profile;
+        parameters->level = stream->level;
+        parameters->bit_rate = stream->bitRate;
+        av_freep(&parameters->extradata);
+        parameters->extradata_size = 0;
+        if (stream->extradataSize > 0) {
+            parameters->extradata = static_cast<uint8_t *>(
+                av_mallocz(static_cast<size_t>(stream->extradataSize) + AV_INPUT_BUFFER_PADDING_SIZE));
+            if (!parameters->extradata) {
+                return false;
+            }
+            std::memcpy(parameters->extradata, stream->extradata, static_cast<size_t>(stream->extradataSize));
+            parameters->extradata_size = stream->extradataSize;
+        }
+        if (timeBase) {
+            *timeBase = AVRational{stream->timeBaseNum, stream->timeBaseDen};
+        }
+        generation_ = static_cast<uint16_t>(stream->generation);
+        return true;
+    }
+
+    PacketBusReader::Result PacketBusReader::read(AVPacket *packet, int timeoutMs) {
+        if (!mapping_ || !packet) {
+            return Result::CLOSED;
+        }
+        BusHeader *header = mapping_->header();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+        while (true) {
+            const Result result = readOne(packet);
+            if (result != Result::NONE) {
+                return result;
+            }
+            if (header->closed.load()) {
+                return Result::CLOSED;
+            }
+            const int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (remaining <= 0) {
+                return writerAlive() ? Result::NONE : Result::CLOSED;
+            }
+
+#ifdef __linux__
+            // Registra a espera antes de conferir o cursor de novo: um publish
+            // entre as duas leituras muda futex e o FUTEX_WAIT retorna na hora
+            const uint32_t value = header->futex.load();
+            header->waiters.fetch_add(1);
+            if (header->writePosition.load() == cursor_) {
+                futexWait(&header->futex, value, remaining);
+            }
+            header->waiters.fetch_sub(1);
+#endif
+        }
+    }
+
+    PacketBusReader::Result PacketBusReader::readOne(AVPacket *packet) {
+        BusHeader *header = mapping_->header();
+        const uint64_t capacity = header->capacity;
+        const uint8_t *data = mapping_->data();
+
+        while (true) {
+            const uint64_t writePosition = header->writePosition.load(std::memory_order_acquire);
+            if (cursor_ >= writePosition) {
+                return Result::NONE;
+            }
+            if (cursor_ < header->reclaimPosition.load(std::memory_order_acquire)) {
+                break;
+            }
+
+            // Cópia otimista; vale só se o trecho não foi reivindicado durante a leitura
+            const uint64_t offset = cursor_ % capacity;
+            RecordHeader record{};
+            std::memcpy(&record, data + offset, sizeof(record));
+            const uint64_t length = RECORD_ALIGN + alignUp(record.size, RECORD_ALIGN);
+            const bool valid = offset + length <= capacity && length <= capacity / 2 + RECORD_ALIGN;
+
+            bool copied = false;
+            if (valid && !(record.flags & RECORD_PADDING) && record.generation == static_cast<uint16_t>(generation_)) {
+                av_packet_unref(packet);
+                if (av_new_packet(packet, static_cast<int>(record.size)) < 0) {
+                    return Result::NONE;
+                }
+                std::memcpy(packet->data, data + offset + RECORD_ALIGN, record.size);
+                copied = true;
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!valid || cursor_ < header->reclaimPosition.load(std::memory_order_relaxed)) {
+                if (copied) {
+                    av_packet_unref(packet);
+                }
+                break;
+            }
+
+            if (record.flags & RECORD_PADDING) {
+                cursor_ += length;
+                continue;
+            }
+            if (!copied) {
+                // Geração anterior à do getStream() (várias trocas em
+                // sequência): pula o registro em vez de reportar de novo
+                if (static_cast<int16_t>(record.generation - static_cast<uint16_t>(generation_)) < 0) {
+                    cursor_ += length;
+                    continue;
+                }
+                return Result::STREAM_CHANGED;
+            }
+
+            packet->pts = record.pts;
+            packet->dts = record.dts;
+            packet->duration = record.duration;
+            packet->flags = record.flags;
+            cursor_ += length;
+            return Result::PACKET;
+        }
+
+        // Sobrescrito pelo escritor: retoma no último keyframe
+        overruns_++;
+        resync();
+        return Result::OVERRUN;
+    }
+
+    void PacketBusReader::resync() {
+        BusHeader *header = mapping_->header();
+        const uint64_t keyframe = header->keyframePosition.load(std::memory_order_acquire);
+        const uint64_t reclaim = header->reclaimPosition.load(std::memory_order_acquire);
+        cursor_ = keyframe > 0 && keyframe - 1 >= reclaim
+                      ? keyframe - 1
+                      : header->writePosition.load(std::memory_order_acquire);
+    }
+
+    bool PacketBusReader::writerAlive() const {
+#ifdef __linux__
+        return writerLocked(mapping_->fd);
+#else
+        return false;
+#endif
+    }
+
+} // namespace turbovision
@@ -0,0 +1,366 @@
+#include "turbovision/sources/packet_ring.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace turbovision {
+    namespace {
+        // Fragmento a cada keyframe, sem moov no fim: o arquivo é legível
+        // durante a gravação e sobrevive a uma interrupção
+        const char *FRAGMENTED_FLAGS = "frag_keyframe+empty_moov+default_base_moof";
+
+        bool isKeyframe(const AVPacket *packet) {
+            return (packet->flags & AV_PKT_FLAG_KEY) != 0;
+        }
+    }
+
+    // Muxer de uma gravação (remux dos pacotes, sem recodificar). A fila e
+    // o contador pertencem a mutex_; o muxer só à thread de escrita.
+    struct PacketRing::Recording {
+        std::string path;
+        AVFormatContext *context = nullptr;
+        AVStream *stream = nullptr;
+        AVRational timeBase{1, 90000};      // Base de tempo dos pacotes do ring
+        int64_t offset = AV_NOPTS_VALUE;    // dts do primeiro pacote (arquivo começa em 0)
+        int64_t lastDts = AV_NOPTS_VALUE;
+        std::deque<AVPacket *> pending;     // Aguardando a thread de escrita
+        int64_t written = 0;
+
+        bool open(const std::string &outputPath, Format format,
+                  const AVCodecParameters *parameters, AVRational sourceTimeBase) {
+            path = outputPath;
+            timeBase = sourceTimeBase;
+
+            avformat_alloc_output_context2(&context, nullptr, "mp4", path.c_str());
+            if (!context) {
+                return false;
+            }
+
+            stream = avformat_new_stream(context, nullptr);
+            if (!stream || avcodec_parameters_copy(stream->codecpar, parameters) < 0) {
+                return false;
+            }
+            stream->codecpar->codec_tag = 0;
+            stream->time_base = timeBase;
+
+            if (!(context->oformat->flags & AVFMT_NOFILE) &&
+                avio_open(&context->pb, path.c_str(), AVIO_FLAG_WRITE) < 0) {
+                return false;
+            }
+
+            AVDictionary *options = nullptr;
+            if (format == Format::FRAGMENTED_MP4) {
+                av_dict_set(&options, "movflags", FRAGMENTED_FLAGS, 0);
+            }
+            const int ret = avformat_write_header(context, &options);
+            av_dict_free(&options);
+            if (ret < 0) {
+                avio_closep(&context->pb);
+                return false;
+            }
+            return true;
+        }
+
+        bool write(AVPacket *packet) {
+            if (packet->dts == AV_NOPTS_VALUE) {
+                packet->dts = packet->pts;
+            }
+            if (packet->pts == AV_NOPTS_VALUE) {
+                packet->pts = packet->dts;
+            }
+            if (packet->dts != AV_NOPTS_VALUE) {
+                if (offset == AV_NOPTS_VALUE) {
+                    offset = packet->dts;
+                }
+                packet->dts -= offset;
+                packet->pts -= offset;
+            }
+            av_packet_rescale_ts(packet, timeBase, stream->time_base);
+
+            // O MP4 exige dts crescente; pacotes sem timestamp seguem o anterior
+            if (packet->dts == AV_NOPTS_VALUE || (lastDts != AV_NOPTS_VALUE && packet->dts <= lastDts)) {
+                packet->dts = lastDts == AV_NOPTS_VALUE ? 0 : lastDts + 1;
+            }
+            if (packet->pts == AV_NOPTS_VALUE || packet->pts < packet->dts) {
+                packet->pts = packet->dts;
+            }
+            lastDts = packet->dts;
+
+            packet->stream_index = stream->index;
+            packet->pos = -1;
+            return av_write_frame(context, packet) >= 0;
+        }
+
+        ~Recording() {
+            for (AVPacket *packet: pending) {
+                av_packet_free(&packet);
+            }
+            if (!context) {
+                return;
+            }
+            if (context->pb) {
+                av_write_trailer(context);
+                avio_closep(&context->pb);
+            }
+            avformat_free_context(context);
+        }
+    };
+
+    PacketRing::PacketRing(const Settings &settings)
+        : settings_(settings)
+          , bytes_(0)
+          , parameters_(nullptr)
+          , timeBase_{1, 90000}
+          , generation_(0)
+          , starting_(false)
+          , recordedPackets_(0)
+          , stopping_(false) {
+    }
+
+    PacketRing::~PacketRing() {
+        // A thread de escrita esvazia as filas e fecha os arquivos antes de sair
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closeRecording();
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+        clear();
+        avcodec_parameters_free(&parameters_);
+    }
+
+    void PacketRing::setStream(const AVCodecParameters *parameters, AVRational timeBase) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closeRecording();
+        generation_++;
+
+        clear();
+        if (!parameters_) {
+            parameters_ = avcodec_parameters_alloc();
+        }
+        if (!parameters_ || avcodec_parameters_copy(parameters_, parameters) < 0) {
+            avcodec_parameters_free(&parameters_);
+            return;
+        }
+        timeBase_ = timeBase;
+    }
+
+    void PacketRing::push(const AVPacket *packet) {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        // O ring sempre começa em um keyframe
+        if (!parameters_ || (entries_.empty() && !isKeyframe(packet))) {
+            return;
+        }
+
+        AVPacket *copy = av_packet_clone(packet);
+        if (!copy) {
+            return;
+        }
+        entries_.push_back({copy, now});
+        bytes_ += copy->size;
+        evict();
+
+        // Só referência na fila; o prazo é conferido pela thread de escrita
+        if (recording_) {
+            AVPacket *live = av_packet_clone(copy);
+            if (live) {
+                recording_->pending.push_back(live);
+                wake_.notify_one();
+            }
+        }
+    }
+
+    bool PacketRing::trigger(const std::string &path, Format format, int postRoll) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(postRoll);
+        AVCodecParameters *parameters = nullptr;
+        AVRational timeBase;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (recording_ || starting_) {
+                deadline_ = std::max(deadline_, deadline);
+                wake_.notify_all();
+                return true;
+            }
+            if (!parameters_) {
+                std::cerr << "PacketRing::trigger() - Stream sem parâmetros" << std::endl;
+                return false;
+            }
+            parameters = avcodec_parameters_alloc();
+            if (!parameters || avcodec_parameters_copy(parameters, parameters_) < 0) {
+                avcodec_parameters_free(&parameters);
+                return false;
+            }
+            timeBase = timeBase_;
+            generation = generation_;
+            starting_ = true;
+            deadline_ = deadline;
+        }
+
+        // Abertura do arquivo e cabeçalho sem lock: o push da captura segue
+        auto recording = std::make_unique<Recording>();
+        const bool opened = recording->open(path, format, parameters, timeBase);
+        avcodec_parameters_free(&parameters);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        starting_ = false;
+        if (!opened) {
+            std::cerr << "PacketRing::trigger() - Falha ao abrir " << path << std::endl;
+            return false;
+        }
+        if (generation != generation_) {
+            std::cerr << "PacketRing::trigger() - Stream trocado durante a abertura de " << path << std::endl;
+            return false;
+        }
+
+        // Pré-roll enfileirado (por referência) junto com a virada para ao
+        // vivo, então nenhum pacote fica de fora nem é gravado duas vezes
+        for (const Entry &entry: entries_) {
+            AVPacket *packet = av_packet_clone(entry.packet);
+            if (packet) {
+                recording->pending.push_back(packet);
+            }
+        }
+        recording_ = std::move(recording);
+        recordedPackets_ = 0;
+
+        if (!writer_.joinable()) {
+            writer_ = std::thread(&PacketRing::writeRecordings, this);
+        }
+        wake_.notify_all();
+        return true;
+    }
+
+    void PacketRing::writeRecordings() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            // O prazo também vence sem pacotes novos (câmera que parou de enviar)
+            if (recording_ && std::chrono::steady_clock::now() >= deadline_) {
+                closeRecording();
+            }
+
+            // Encerradas primeiro: seus pacotes são anteriores aos da atual
+            Recording *target = !closing_.empty() ? closing_.front().get() : recording_.get();
+            if (target && !target->pending.empty()) {
+                std::deque<AVPacket *> batch;
+                batch.swap(target->pending);
+
+                lock.unlock();
+                int64_t written = 0;
+                for (AVPacket *packet: batch) {
+                    if (target->write(packet)) {
+                        written++;
+                    }
+                    av_packet_free(&packet);
+                }
+                lock.lock();
+
+                target->written += written;
+                recordedPackets_ = target->written;
+                continue;
+            }
+
+            if (!closing_.empty()) {
+                // Trailer e fechamento do arquivo também fora do lock
+                std::unique_ptr<Recording> done = std::move(closing_.front());
+                closing_.pop_front();
+                lock.unlock();
+
+                std::cout << "PacketRing - Gravação encerrada: " << done->path
+                        << " (" << done->written << " pacotes)" << std::endl;
+                done.reset();
+                lock.lock();
+                continue;
+            }
+
+            if (stopping_) {
+                return;
+            }
+            if (recording_) {
+                // Triggers só adiam o prazo: acordar cedo apenas reavalia
+                wake_.wait_until(lock, deadline_);
+            } else {
+                wake_.wait(lock);
+            }
+        }
+    }
+
+    void PacketRing::stopRecording() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closeRecording();
+        wake_.notify_all();
+    }
+
+    bool PacketRing::isRecording() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return recording_ != nullptr || starting_;
+    }
+
+    PacketRing::Stats PacketRing::getStats() const {
+        Stats stats{};
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.recording = recording_ != nullptr || starting_;
+        stats.recordedPackets = recordedPackets_;
+        stats.packets = static_cast<int64_t>(entries_.size());
+        stats.bytes = bytes_;
+        if (!entries_.empty()) {
+            stats.duration = std::chrono::duration<double>(entries_.back().arrival - entries_.front().arrival).count();
+        }
+        return stats;
+    }
+
+    void PacketRing::evict() {
+        // Descarta o GOP mais antigo enquanto o restante ainda cobre o
+        // pré-roll (ou o ring passa do limite de bytes)
+        const auto duration = std::chrono::seconds(settings_.duration);
+        while (entries_.size() > 1) {
+            const bool overBytes = bytes_ > settings_.maxBytes;
+            if (!overBytes && entries_.back().arrival - entries_.front().arrival < duration) {
+                return;
+            }
+
+            size_t nextKeyframe = 1;
+            while (nextKeyframe < entries_.size() && !isKeyframe(entries_[nextKeyframe].packet)) {
+                nextKeyframe++;
+            }
+            if (nextKeyframe == entries_.size()) {
+                // Acima do limite sem outro keyframe (GOP gigante ou intra
+                // refresh com um único IDR): esvazia e recomeça no próximo
+                if (overBytes) {
+                    clear();
+                }
+                return;
+            }
+            if (!overBytes && entries_.back().arrival - entries_[nextKeyframe].arrival < duration) {
+                return;
+            }
+
+            for (size_t i = 0; i < nextKeyframe; i++) {
+                bytes_ -= entries_.front().packet->size;
+                av_packet_free(&entries_.front().packet);
+                entries_.pop_front();
+            }
+        }
+    }
+
+    void PacketRing::clear() {
+        for (Entry &entry: entries_) {
+            av_packet_free(&entry.packet);
+        }
+        entries_.clear();
+        bytes_ = 0;
+    }
+
+    void PacketRing::closeRecording() {
+        // Sem novos pacotes; a thread de escrita esvazia a fila e fecha o arquivo
+        if (recording_) {
+            closing_.push_back(std::move(recording_));
+            wake_.notify_all();
+        }
+    }
+
+} // namespace turbovision
@@ -0,0 +1,737 @@
+#include "turbovision/sources/recording_sink.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace turbovision {
+    namespace {
+        // Alinhamento das escritas (exigido pelo O_DIRECT)
+        const int ALIGNMENT = 4096;
+
+        const uint32_t RECORD_MAGIC = 0x31525654;   // "TVR1"
+        const uint16_t RECORD_PACKET = 1;
+        const uint16_t RECORD_STREAM = 2;
+        const int RECORD_HEADER_SIZE = 32;
+        const int STREAM_HEADER_SIZE = 28;
+
+        // Cabeçalho de registro (little endian)
+        struct RecordHeader {
+            uint32_t magic;
+            uint16_t type;
+            uint16_t flags;
+            uint32_t source;
+            uint32_t size;
+            int64_t pts;
+            int64_t dts;
+        };
+        static_assert(sizeof(RecordHeader) == RECORD_HEADER_SIZE, "cabeçalho de registro com padding");
+
+        int64_t alignUp(int64_t value, int64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        uint8_t *allocateAligned(size_t size) {
+            return static_cast<uint8_t *>(::operator new(size, std::align_val_t(ALIGNMENT)));
+        }
+
+        void freeAligned(uint8_t *data) {
+            ::operator delete(data, std::align_val_t(ALIGNMENT));
+        }
+
+        // Registro de stream: parâmetros fixos, extradata e nome
+        std::vector<uint8_t> encodeStream(AVCodecID codecId, int width, int height, AVRational timeBase,
+                                          const std::vector<uint8_t> &extradata, const std::string &name) {
+            const int32_t fields[7] = {
+                static_cast<int32_t>(codecId), width, height, timeBase.num, timeBase.den,
+                static_cast<int32_t>(extradata.size()), static_cast<int32_t>(name.size())
+            };
+            std::vector<uint8_t> encoded(STREAM_HEADER_SIZE);
+            std::memcpy(encoded.data(), fields, sizeof(fields));
+            encoded.insert(encoded.end(), extradata.begin(), extradata.end());
+            encoded.insert(encoded.end(), name.begin(), name.end());
+            return encoded;
+        }
+
+        int writeRecord(uint8_t *destination, uint16_t type, int source, int flags, int64_t pts, int64_t dts,
+                        const std::vector<uint8_t> &prefix, const uint8_t *data, int size) {
+            const int payload = static_cast<int>(prefix.size()) + size;
+            const int total = static_cast<int>(alignUp(RECORD_HEADER_SIZE + payload, 8));
+
+            RecordHeader header{
+                RECORD_MAGIC, type, static_cast<uint16_t>(flags), static_cast<uint32_t>(source),
+                static_cast<uint32_t>(payload), pts, dts
+            };
+            std::memcpy(destination, &header, RECORD_HEADER_SIZE);
+            uint8_t *cursor = destination + RECORD_HEADER_SIZE;
+            if (!prefix.empty()) {
+                std::memcpy(cursor, prefix.data(), prefix.size());
+                cursor += prefix.size();
+            }
+            if (size > 0) {
+                std::memcpy(cursor, data, static_cast<size_t>(size));
+                cursor += size;
+            }
+            std::memset(cursor, 0, static_cast<size_t>(destination + total - cursor));
+            return total;
+        }
+
+        int64_t writeAt(int fd, const uint8_t *data, int length, int64_t offset) {
+#ifdef _WIN32
+            return -1;
+#else
+            int64_t written = 0;
+            while (written < length) {
+                const ssize_t ret = pwrite(fd, data + written, static_cast<size_t>(length - written), offset + written);
+                if (ret < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return -errno;
+                }
+                written += ret;
+            }
+            return written;
+#endif
+        }
+    }
+
+#ifdef __linux__
+    // io_uring direto pelas syscalls (sem liburing): uma escrita por SQE
+    class RecordingSink::IoRing {
+    public:
+        static std::unique_ptr<IoRing> create(unsigned entries) {
+            auto ring = std::unique_ptr<IoRing>(new IoRing());
+            io_uring_params params{};
+            ring->fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (ring->fd_ < 0) {
+                return nullptr;
+            }
+
+            ring->sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            ring->cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                ring->sqRingSize_ = ring->cqRingSize_ = std::max(ring->sqRingSize_, ring->cqRingSize_);
+            }
+
+            ring->sqRing_ = mmap(nullptr, ring->sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                 ring->fd_, IORING_OFF_SQ_RING);
+            if (ring->sqRing_ == MAP_FAILED) {
+                ring->sqRing_ = nullptr;
+                return nullptr;
+            }
+            if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                ring->cqRing_ = ring->sqRing_;
+            } else {
+                ring->cqRing_ = mmap(nullptr, ring->cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                     ring->fd_, IORING_OFF_CQ_RING);
+                if (ring->cqRing_ == MAP_FAILED) {
+                    ring->cqRing_ = nullptr;
+                    return nullptr;
+                }
+            }
+            ring->sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+            void *sqes = mmap(nullptr, ring->sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ring->fd_, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED) {
+                return nullptr;
+            }
+            ring->sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+            auto *sq = static_cast<uint8_t *>(ring->sqRing_);
+            ring->sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+            ring->sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            ring->sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            ring->sqArray_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+            ring->sqEntries_ = params.sq_entries;
+
+            auto *cq = static_cast<uint8_t *>(ring->cqRing_);
+            ring->cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            ring->cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            ring->cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            ring->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            return ring;
+        }
+
+        ~IoRing() {
+            if (sqes_) {
+                munmap(sqes_, sqesSize_);
+            }
+            if (cqRing_ && cqRing_ != sqRing_) {
+                munmap(cqRing_, cqRingSize_);
+            }
+            if (sqRing_) {
+                munmap(sqRing_, sqRingSize_);
+            }
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+        }
+
+        // false com a fila de submissão cheia
+        bool write(int fd, const uint8_t *data, int length, int64_t offset, void *userData) {
+            const unsigned tail = *sqTail_;
+            if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) {
+                return false;
+            }
+
+            const unsigned index = tail & sqMask_;
+            io_uring_sqe *sqe = &sqes_[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->fd = fd;
+            sqe->addr = reinterpret_cast<uint64_t>(data);
+            sqe->len = static_cast<uint32_t>(length);
+            sqe->off = static_cast<uint64_t>(offset);
+            sqe->user_data = reinterpret_cast<uint64_t>(userData);
+            sqArray_[index] = index;
+            __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+            // SQE já está na fila: se a submissão falhar agora, vai na próxima chamada
+            enter(0);
+            return true;
+        }
+
+        // Próxima conclusão; com wait bloqueia até haver uma
+        bool complete(void *&userData, int &result, bool wait) {
+            unsigned head = *cqHead_;
+            if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                if (!wait) {
+                    return false;
+                }
+                enter(IORING_ENTER_GETEVENTS);
+                if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                    return false;
+                }
+            }
+
+            const io_uring_cqe &cqe = cqes_[head & cqMask_];
+            userData = reinterpret_cast<void *>(cqe.user_data);
+            result = cqe.res;
+            __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+    private:
+        IoRing() = default;
+
+        // Submete o que o kernel ainda não consumiu da fila
+        void enter(unsigned flags) {
+            const unsigned pending = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+            while (syscall(__NR_io_uring_enter, fd_, pending, flags ? 1 : 0, flags, nullptr, 0) < 0 &&
+                   errno == EINTR) {
+            }
+        }
+
+        int fd_ = -1;
+        void *sqRing_ = nullptr;
+        void *cqRing_ = nullptr;
+        size_t sqRingSize_ = 0;
+        size_t cqRingSize_ = 0;
+        io_uring_sqe *sqes_ = nullptr;
+        size_t sqesSize_ = 0;
+
+        unsigned *sqHead_ = nullptr;
+        unsigned *sqTail_ = nullptr;
+        unsigned sqMask_ = 0;
+        unsigned *sqArray_ = nullptr;
+        unsigned sqEntries_ = 0;
+
+        unsigned *cqHead_ = nullptr;
+        unsigned *cqTail_ = nullptr;
+        unsigned cqMask_ = 0;
+        io_uring_cqe *cqes_ = nullptr;
+    };
+#else
+    // Sem io_uring: o sink usa pwrite na própria thread
+    class RecordingSink::IoRing {
+    public:
+        static std::unique_ptr<IoRing> create(unsigned) { return nullptr; }
+        bool write(int, const uint8_t *, int, int64_t, void *) { return false; }
+        bool complete(void *&, int &, bool) { return false; }
+    };
+#endif
+
+    RecordingSink::RecordingSink(const Settings &settings)
+        : settings_(settings)
+          , current_(nullptr)
+          , running_(false)
+          , ioUring_(false)
+          , fd_(-1)
+          , offset_(0)
+          , segmentIndex_(0)
+          , inflight_(0)
+          , packets_(0)
+          , bytes_(0)
+          , dropped_(0)
+          , writes_(0)
+          , bytesWritten_(0)
+          , segments_(0)
+          , latencySum_(0)
+          , latencyMax_(0) {
+        settings_.bufferSize = static_cast<int>(alignUp(std::max(settings_.bufferSize, ALIGNMENT), ALIGNMENT));
+        settings_.buffers = std::max(settings_.buffers, 2);
+    }
+
+    RecordingSink::~RecordingSink() {
+        stop();
+    }
+
+    bool RecordingSink::start() {
+#ifdef _WIN32
+        std::cerr << "RecordingSink::start() - Não suportado no Windows" << std::endl;
+        return false;
+#else
+        if (running_) {
+            return false;
+        }
+
+        for (int i = 0; i < settings_.buffers; i++) {
+            auto *buffer = new Buffer{allocateAligned(static_cast<size_t>(settings_.bufferSize)),
+                                      settings_.bufferSize, 0, 0, 0, true, {}};
+            allBuffers_.push_back(buffer);
+            free_.push_back(buffer);
+        }
+
+        if (settings_.useIoUring) {
+            ioRing_ = IoRing::create(static_cast<unsigned>(settings_.buffers));
+            if (!ioRing_) {
+                std::cerr << "RecordingSink::start() - io_uring indisponível, usando pwrite" << std::endl;
+            }
+        }
+        ioUring_ = ioRing_ != nullptr;
+
+        startTime_ = std::chrono::steady_clock::now();
+        if (!openSegment()) {
+            ioRing_.reset();
+            for (Buffer *buffer: allBuffers_) {
+                freeAligned(buffer->data);
+                delete buffer;
+            }
+            allBuffers_.clear();
+            free_.clear();
+            return false;
+        }
+
+        running_ = true;
+        writerThread_ = std::thread(&RecordingSink::writerLoop, this);
+        return true;
+#endif
+    }
+
+    void RecordingSink::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+            running_ = false;
+        }
+        readyCondition_.notify_one();
+        if (writerThread_.joinable()) {
+            writerThread_.join();
+        }
+
+        ioRing_.reset();
+        for (Buffer *buffer: allBuffers_) {
+            freeAligned(buffer->data);
+            delete buffer;
+        }
+        allBuffers_.clear();
+        free_.clear();
+    }
+
+    int RecordingSink::addSource(const std::string &name, const AVCodecParameters *parameters, AVRational timeBase) {
+        if (!parameters) {
+            return -1;
+        }
+
+        SourceInfo info{name, parameters->codec_id, parameters->width, parameters->height, timeBase, {}};
+        if (parameters->extradata && parameters->extradata_size > 0) {
+            info.extradata.assign(parameters->extradata, parameters->extradata + parameters->extradata_size);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int source = static_cast<int>(sources_.size());
+        sources_.push_back(info);
+
+        // Com o sink rodando o registro entra no segmento atual; os próximos
+        // segmentos repetem todas as fontes no início
+        if (running_) {
+            appendRecord(RECORD_STREAM, source, 0, 0, 0,
+                         encodeStream(info.codecId, info.width, info.height, info.timeBase, info.extradata, info.name),
+                         nullptr, 0);
+        }
+        return source;
+    }
+
+    bool RecordingSink::write(int source, const AVPacket *packet) {
+        return write(source, packet->data, packet->size, packet->pts, packet->dts, packet->flags);
+    }
+
+    bool RecordingSink::write(int source, const uint8_t *data, int size, int64_t pts, int64_t dts, int flags) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || source < 0 || source >= static_cast<int>(sources_.size())) {
+            return false;
+        }
+
+        packets_++;
+        bytes_ += size;
+        if (!appendRecord(RECORD_PACKET, source, flags, pts, dts, {}, data, size)) {
+            dropped_++;
+            return false;
+        }
+        return true;
+    }
+
+    bool RecordingSink::appendRecord(int type, int source, int flags, int64_t pts, int64_t dts,
+                                     const std::vector<uint8_t> &prefix, const uint8_t *data, int size) {
+        const int total = static_cast<int>(alignUp(RECORD_HEADER_SIZE + static_cast<int64_t>(prefix.size()) + size, 8));
+
+        if (!current_ || current_->used + total > current_->capacity) {
+            if (current_ && current_->used > 0) {
+                ready_.push_back(current_);
+                current_ = nullptr;
+                readyCondition_.notify_one();
+            }
+            if (!current_) {
+                current_ = takeBuffer(total);
+                if (!current_) {
+                    return false;
+                }
+                currentSince_ = std::chrono::steady_clock::now();
+            }
+        }
+
+        current_->used += writeRecord(current_->data + current_->used, static_cast<uint16_t>(type), source,
+                                      flags, pts, dts, prefix, data, size);
+        return true;
+    }
+
+    RecordingSink::Buffer *RecordingSink::takeBuffer(int size) {
+        // Pacote maior que um buffer (keyframe muito grande): buffer avulso
+        if (size > settings_.bufferSize) {
+            const int capacity = static_cast<int>(alignUp(size, ALIGNMENT));
+            return new Buffer{allocateAligned(static_cast<size_t>(capacity)), capacity, 0, 0, 0, false, {}};
+        }
+        if (free_.empty()) {
+            return nullptr;
+        }
+        Buffer *buffer = free_.back();
+        free_.pop_back();
+        return buffer;
+    }
+
+    void RecordingSink::recycle(Buffer *buffer) {
+        if (!buffer->pooled) {
+            freeAligned(buffer->data);
+            delete buffer;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer->used = 0;
+        free_.push_back(buffer);
+    }
+
+    void RecordingSink::writerLoop() {
+        const auto flushInterval = std::chrono::milliseconds(settings_.flushInterval);
+        while (true) {
+            Buffer *buffer = nullptr;
+            bool stopping = false;
+            {
+                // Com escritas em voo a espera é curta para devolver logo os buffers
+                std::unique_lock<std::mutex> lock(mutex_);
+                const auto timeout = inflight_ > 0 ? std::chrono::milliseconds(1) : flushInterval / 2;
+                readyCondition_.wait_for(lock, timeout, [this] {
+                    return !ready_.empty() || !running_;
+                });
+                stopping = !running_;
+
+                if (!ready_.empty()) {
+                    buffer = ready_.front();
+                    ready_.pop_front();
+                } else if (current_ && current_->used > 0 &&
+                           (stopping || std::chrono::steady_clock::now() - currentSince_ >= flushInterval)) {
+                    // Fontes de baixa taxa: o buffer parcial não espera encher
+                    buffer = current_;
+                    current_ = nullptr;
+                }
+            }
+
+            if (buffer) {
+                const int64_t length = alignUp(buffer->used, ALIGNMENT);
+                const auto now = std::chrono::steady_clock::now();
+                const bool full = offset_ + length > settings_.segmentBytes;
+                const bool expired = settings_.segmentDuration > 0 &&
+                                     now - segmentStart_ >= std::chrono::seconds(settings_.segmentDuration);
+                if (fd_ < 0 || full || expired) {
+                    closeSegment();
+                    openSegment();
+                }
+                if (fd_ >= 0) {
+                    submit(buffer);
+                } else {
+                    recycle(buffer);
+                }
+            } else if (stopping) {
+                break;
+            }
+            reap(false);
+        }
+        closeSegment();
+    }
+
+    bool RecordingSink::openSegment() {
+#ifdef _WIN32
+        return false;
+#else
+        char name[64];
+        std::snprintf(name, sizeof(name), "-%lld-%06lld.tvr", static_cast<long long>(std::time(nullptr)),
+                      static_cast<long long>(segmentIndex_++));
+        const std::string path = settings_.directory + "/" + settings_.prefix + name;
+
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+        if (settings_.directIO) {
+            flags |= O_DIRECT;
+        }
+#endif
+        fd_ = open(path.c_str(), flags, 0644);
+#ifdef O_DIRECT
+        if (fd_ < 0 && settings_.directIO && errno == EINVAL) {
+            // Sistema de arquivos sem O_DIRECT (tmpfs, por exemplo)
+            std::cerr << "RecordingSink::openSegment() - O_DIRECT não suportado, usando page cache" << std::endl;
+            settings_.directIO = false;
+            fd_ = open(path.c_str(), flags & ~O_DIRECT, 0644);
+        }
+#endif
+        if (fd_ < 0) {
+            std::cerr << "RecordingSink::openSegment() - Falha ao criar " << path << ": "
+                    << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        // Blocos reservados de uma vez: escritas sequenciais sem alocação
+        // no caminho e sem fragmentar entre centenas de arquivos
+#ifdef __linux__
+        if (settings_.segmentBytes > 0) {
+            fallocate(fd_, 0, 0, settings_.segmentBytes);
+        }
+#endif
+
+        offset_ = 0;
+        segmentStart_ = std::chrono::steady_clock::now();
+        segments_++;
+
+        Buffer *header = streamRecords();
+        if (header) {
+            submit(header);
+        }
+        return true;
+#endif
+    }
+
+    void RecordingSink::closeSegment() {
+#ifndef _WIN32
+        if (fd_ < 0) {
+            return;
+        }
+        while (inflight_ > 0) {
+            reap(true);
+        }
+
+        // Devolve a pré-alocação que não foi usada
+        if (ftruncate(fd_, offset_) < 0) {
+            std::cerr << "RecordingSink::closeSegment() - ftruncate: " << std::strerror(errno) << std::endl;
+        }
+        fdatasync(fd_);
+        close(fd_);
+        fd_ = -1;
+#endif
+    }
+
+    RecordingSink::Buffer *RecordingSink::streamRecords() {
+        std::vector<std::vector<uint8_t>> records;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const SourceInfo &info: sources_) {
+                records.push_back(encodeStream(info.codecId, info.width, info.height, info.timeBase,
+                                               info.extradata, info.name));
+            }
+        }
+        if (records.empty()) {
+            return nullptr;
+        }
+
+        int64_t size = 0;
+        for (const auto &record: records) {
+            size += alignUp(RECORD_HEADER_SIZE + static_cast<int64_t>(record.size()), 8);
+        }
+        const int capacity = static_cast<int>(alignUp(size, ALIGNMENT));
+        auto *buffer = new Buffer{allocateAligned(static_cast<size_t>(capacity)), capacity, 0, 0, 0, false, {}};
+        for (size_t source = 0; source < records.size(); source++) {
+            buffer->used += writeRecord(buffer->data + buffer->used, RECORD_STREAM, static_cast<int>(source),
+                                        0, 0, 0, records[source], nullptr, 0);
+        }
+        return buffer;
+    }
+
+    bool RecordingSink::submit(Buffer *buffer) {
+        buffer->length = static_cast<int>(alignUp(buffer->used, ALIGNMENT));
+        std::memset(buffer->data + buffer->used, 0, static_cast<size_t>(buffer->length - buffer->used));
+        buffer->offset = offset_;
+        buffer->submitted = std::chrono::steady_clock::now();
+        offset_ += buffer->length;
+
+        if (!ioRing_) {
+            completed(buffer, static_cast<int>(writeAt(fd_, buffer->data, buffer->length, buffer->offset)));
+            return true;
+        }
+
+        // Fila cheia: espera uma escrita terminar
+        while (!ioRing_->write(fd_, buffer->data, buffer->length, buffer->offset, buffer)) {
+            if (inflight_ == 0) {
+                completed(buffer, static_cast<int>(writeAt(fd_, buffer->data, buffer->length, buffer->offset)));
+                return true;
+            }
+            reap(true);
+        }
+        inflight_++;
+        return true;
+    }
+
+    void RecordingSink::reap(bool wait) {
+        if (!ioRing_) {
+            return;
+        }
+        void *userData = nullptr;
+        int result = 0;
+        while (ioRing_->complete(userData, result, wait)) {
+            inflight_--;
+            completed(static_cast<Buffer *>(userData), result);
+            wait = false;
+        }
+    }
+
+    void RecordingSink::completed(Buffer *buffer, int result) {
+        // Escrita assíncrona recusada ou curta: repete com pwrite
+        if (result != buffer->length && ioRing_) {
+            result = static_cast<int>(writeAt(fd_, buffer->data, buffer->length, buffer->offset));
+        }
+        if (result != buffer->length) {
+            std::cerr << "RecordingSink - Falha na escrita de " << buffer->length << " bytes: "
+                    << (result < 0 ? std::strerror(-result) : "escrita curta") << std::endl;
+        } else {
+            const int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - buffer->submitted).count();
+            writes_++;
+            bytesWritten_ += buffer->length;
+            latencySum_ += latency;
+            if (latency > latencyMax_) {
+                latencyMax_ = latency;
+            }
+        }
+        recycle(buffer);
+    }
+
+    RecordingSink::Stats RecordingSink::getStats() const {
+        Stats stats{};
+        stats.packets = packets_;
+        stats.bytes = bytes_;
+        stats.droppedPackets = dropped_;
+        stats.writes = writes_;
+        stats.bytesWritten = bytesWritten_;
+        stats.segments = segments_;
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+        stats.throughput = elapsed > 0.0 ? static_cast<double>(stats.bytesWritten) / elapsed / 1e6 : 0.0;
+        stats.writeLatency = stats.writes > 0 ? static_cast<double>(latencySum_) / stats.writes : 0.0;
+        stats.maxWriteLatency = static_cast<double>(latencyMax_);
+        stats.ioUring = ioUring_;
+        return stats;
+    }
+
+    bool RecordingSink::readSegment(const std::string &path, const RecordCallback &callback) {
+        FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+
+        bool valid = true;
+        int64_t position = 0;
+        std::vector<uint8_t> payload;
+        RecordHeader header{};
+        while (std::fread(&header, RECORD_HEADER_SIZE, 1, file) == 1) {
+            // Zeros: fim de buffer (ou pré-alocação), o próximo começa em 4 KiB
+            if (header.magic == 0) {
+                position = alignUp(position + 1, ALIGNMENT);
+                if (std::fseek(file, static_cast<long>(position), SEEK_SET) != 0) {
+                    break;
+                }
+                continue;
+            }
+            if (header.magic != RECORD_MAGIC) {
+                valid = false;
+                break;
+            }
+
+            const int64_t total = alignUp(RECORD_HEADER_SIZE + static_cast<int64_t>(header.size), 8);
+            payload.resize(static_cast<size_t>(total - RECORD_HEADER_SIZE));
+            if (!payload.empty() && std::fread(payload.data(), payload.size(), 1, file) != 1) {
+                valid = false;
+                break;
+            }
+            position += total;
+
+            Record record{};
+            record.source = static_cast<int>(header.source);
+            record.flags = header.flags;
+            record.pts = header.pts;
+            record.dts = header.dts;
+            record.data = payload.data();
+            record.size = static_cast<int>(header.size);
+            if (header.type == RECORD_STREAM && header.size >= static_cast<uint32_t>(STREAM_HEADER_SIZE)) {
+                int32_t fields[7];
+                std::memcpy(fields, payload.data(), sizeof(fields));
+
+                // Payload e nome precisam caber no registro (arquivo truncado ou corrompido)
+                const int64_t available = static_cast<int64_t>(header.size) - STREAM_HEADER_SIZE;
+                if (fields[5] < 0 || fields[6] < 0 ||
+                    static_cast<int64_t>(fields[5]) + fields[6] > available) {
+                    std::cerr << "RecordingSink::readSegment() - Registro de stream inválido em " << path
+                            << " (posição " << position - total << ")" << std::endl;
+                    valid = false;
+                    break;
+                }
+                record.stream = true;
+                record.codecId = static_cast<AVCodecID>(fields[0]);
+                record.width = fields[1];
+                record.height = fields[2];
+                record.timeBase = AVRational{fields[3], fields[4]};
+                record.data = payload.data() + STREAM_HEADER_SIZE;
+                record.size = fields[5];
+                record.name.assign(reinterpret_cast<const char *>(payload.data()) + STREAM_HEADER_SIZE + fields[5],
+                                   static_cast<size_t>(fields[6]));
+            }
+            callback(record);
+        }
+
+        std::fclose(file);
+        return valid;
+    }
+
+} // namespace turbovision
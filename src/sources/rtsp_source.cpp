@@ -1,17 +1,53 @@
 #include "turbovision/sources/rtsp_source.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 
 namespace turbovision {
+    namespace {
+        // Contexto do demuxer -> fonte, para atribuir os avisos do log do FFmpeg
+        std::mutex &demuxersMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::unordered_map<const void *, RTSPSource *> &demuxers() {
+            static std::unordered_map<const void *, RTSPSource *> map;
+            return map;
+        }
+
+        // Ganho do filtro de jitter da RFC 3550 (seção 6.4.1)
+        const double JITTER_GAIN = 1.0 / 16.0;
+    }
+
     RTSPSource::RTSPSource(const VideoConfig &config, const RTSPConfig &rtspConfig)
         : VideoSource(config)
           , rtspConfig_(rtspConfig)
-          , reconnectAttempts_(0) {
-        status_.connected = false;
-        status_.reconnectAttempts = 0;
-        status_.averageLatency = 0;
-        status_.packetLoss = 0;
-        status_.bytesReceived = 0;
+          , reconnectAttempts_(0)
+          , stats_()
+          , rtpLost_(0)
+          , rtpLate_(0)
+          , lastArrival_(-1.0)
+          , lastRtpTime_(0.0)
+          , lastPts_(AV_NOPTS_VALUE) {
+        if (rtspConfig_.preEventDuration > 0) {
+            PacketRing::Settings settings;
+            settings.duration = rtspConfig_.preEventDuration;
+            settings.maxBytes = rtspConfig_.preEventMaxBytes;
+            packetRing_ = std::make_unique<PacketRing>(settings);
+        }
+        if (!rtspConfig_.packetBusName.empty()) {
+            PacketBus::Settings settings;
+            settings.name = rtspConfig_.packetBusName;
+            settings.capacity = rtspConfig_.packetBusSize;
+            packetBus_ = std::make_unique<PacketBus>(settings);
+        }
+
+        publishedStats_.store(stats_);
     }
 
     RTSPSource::~RTSPSource() {
@@ -20,6 +56,10 @@ namespace turbovision {
     }
 
     bool RTSPSource::initializeSource() {
+        // O barramento sobrevive a reconexões; leitores só veem nova geração
+        if (packetBus_ && !packetBus_->isRunning() && !packetBus_->start()) {
+            std::cerr << "RTSPSource::initializeSource() - Falha ao criar o barramento de pacotes" << std::endl;
+        }
         return connect();
     }
 
@@ -32,8 +72,6 @@ namespace turbovision {
             return;
         }
 
-        auto lastStatusUpdate = std::chrono::steady_clock::now();
-
         try {
             while (isRunning_) {
                 if (isPaused_) {
@@ -41,26 +79,28 @@ namespace turbovision {
                     continue;
                 }
 
+                const int64_t readStart = LatencyHistogram::now();
                 int ret = av_read_frame(formatContext_, packet);
                 if (ret >= 0) {
+                    stageHistograms_->packetRead.recordSince(readStart);
                     if (packet->stream_index == videoStreamIndex_) {
                         reconnectAttempts_ = 0; // Reset contador em caso de sucesso
-                        status_.bytesReceived += packet->size;
-                        status_.framesReceived++;
+                        trackPacket(packet);
 
-                        if (!processPacket(packet)) {
-                            std::cerr << "RTSPSource::captureLoop() - Falha ao processar packet" << std::endl;
+                        // O ring guarda o pacote codificado, antes de qualquer decodificação
+                        if (packetRing_) {
+                            packetRing_->push(packet);
+                        }
+                        if (packetBus_) {
+                            packetBus_->publish(packet);
                         }
-                    }
-                    av_packet_unref(packet);
 
-                    // Atualizar estatísticas a cada segundo
-                    auto now = std::chrono::steady_clock::now();
-                    if (std::chrono::duration_cast<std::chrono::seconds>(
-                            now - lastStatusUpdate).count() >= 1) {
+                        if (rtspConfig_.decodeFrames && !processPacket(packet)) {
+                            std::cerr << "RTSPSource::captureLoop() - Falha ao processar packet" << std::endl;
+                        }
                         updateStatus();
-                        lastStatusUpdate = now;
                     }
+                    av_packet_unref(packet);
                 } else {
                     char errbuf[AV_ERROR_MAX_STRING_SIZE];
                     av_strerror(ret, errbuf, sizeof(errbuf));
@@ -77,6 +117,8 @@ namespace turbovision {
 
                         if (reconnect()) {
                             reconnectAttempts_++;
+                            stats_.reconnects++;
+                            updateStatus();
                             continue;
                         }
                     }
@@ -147,10 +189,12 @@ namespace turbovision {
             std::cerr << "RTSPSource::connect() - Falha ao alocar formato de contexto" << std::endl;
             return false;
         }
+        registerDemuxer();
 
         std::cout << "RTSPSource::connect() - Configurando rede..." << std::endl;
         if (!setupNetworking()) {
             std::cerr << "RTSPSource::connect() - Falha na configuração de rede" << std::endl;
+            unregisterDemuxer();
             avformat_free_context(formatContext_);
             formatContext_ = nullptr;
             return false;
@@ -172,14 +216,28 @@ namespace turbovision {
             return false;
         }
 
+        // Novo stream (ou reconexão): o ring recomeça no próximo keyframe
+        if (packetRing_) {
+            AVStream *stream = formatContext_->streams[videoStreamIndex_];
+            packetRing_->setStream(stream->codecpar, stream->time_base);
+        }
+        if (packetBus_) {
+            AVStream *stream = formatContext_->streams[videoStreamIndex_];
+            packetBus_->setStream(stream->codecpar, stream->time_base);
+        }
+
         std::cout << "RTSPSource::connect() - Inicializando decodificador..." << std::endl;
-        if (!initializeDecoder()) {
+        if (rtspConfig_.decodeFrames && !initializeDecoder()) {
             std::cerr << "RTSPSource::connect() - Falha ao inicializar decodificador" << std::endl;
             disconnect();
             return false;
         }
 
-        status_.connected = true;
+        // Jitter e ordem recomeçam no novo stream
+        lastArrival_ = -1.0;
+        lastPts_ = AV_NOPTS_VALUE;
+        stats_.connected = true;
+        updateStatus();
         std::cout << "RTSPSource::connect() - Conexão estabelecida com sucesso" << std::endl;
         return true;
     }
@@ -190,13 +248,17 @@ namespace turbovision {
             codecContext_ = nullptr;
         }
 
+        unregisterDemuxer();
         if (formatContext_) {
             avformat_close_input(&formatContext_);
             formatContext_ = nullptr;
         }
 
         videoStreamIndex_ = -1;
-        status_.connected = false;
+        if (stats_.connected) {
+            stats_.connected = false;
+            updateStatus();
+        }
     }
 
     bool RTSPSource::reconnect() {
@@ -317,35 +379,151 @@ namespace turbovision {
         return true;
     }
 
-    void RTSPSource::updateStatus() {
-        if (!formatContext_ || videoStreamIndex_ < 0) return;
+    void RTSPSource::registerDemuxer() {
+        std::lock_guard<std::mutex> lock(demuxersMutex());
+        demuxers()[formatContext_] = this;
+    }
 
-        AVStream *stream = formatContext_->streams[videoStreamIndex_];
+    void RTSPSource::unregisterDemuxer() {
+        std::lock_guard<std::mutex> lock(demuxersMutex());
+        for (auto it = demuxers().begin(); it != demuxers().end();) {
+            it = it->second == this ? demuxers().erase(it) : std::next(it);
+        }
+    }
 
-        // Calcular latência média com base na taxa de quadros (frame rate)
-        if (stream->avg_frame_rate.num > 0 && stream->avg_frame_rate.den > 0) {
-            float frameTime = static_cast<float>(stream->avg_frame_rate.den) /
-                              static_cast<float>(stream->avg_frame_rate.num);
-            status_.averageLatency = frameTime * 1000.0f; // Convertido para milissegundos
+    void RTSPSource::handleDemuxerLog(void *context, int level, const char *fmt, va_list args) {
+        // Filtro barato antes do lock: só avisos do depacketizador RTP
+        if (!context || !fmt || level > AV_LOG_WARNING || std::strncmp(fmt, "RTP: ", 5) != 0) {
+            return;
         }
 
-        // Calcular perda de pacotes - Implementação manual
-        if (stream->nb_frames > 0) {
-            int64_t totalFrames = stream->nb_frames;
+        std::lock_guard<std::mutex> lock(demuxersMutex());
+        auto it = demuxers().find(context);
+        if (it == demuxers().end()) {
+            return;
+        }
 
-            // Verifique se o rastreamento manual está implementado
-            int64_t droppedFrames = totalFrames - status_.framesReceived; // Exemplificando uma lógica
-            if (droppedFrames > 0) {
-                status_.packetLoss = static_cast<float>(droppedFrames) / totalFrames;
-            } else {
-                status_.packetLoss = 0.0f; // Sem perda detectada
+        // rtpdec.c: "RTP: missed %d packets" ao pular uma lacuna de sequência
+        // e "RTP: dropping old packet received too late" fora da janela
+        if (std::strstr(fmt, "missed %d packets")) {
+            va_list copy;
+            va_copy(copy, args);
+            const int missed = va_arg(copy, int);
+            va_end(copy);
+            if (missed > 0) {
+                it->second->rtpLost_.fetch_add(missed, std::memory_order_relaxed);
             }
-        } else {
-            status_.packetLoss = 0.0f; // Nenhum frame registrado ainda
+        } else if (std::strstr(fmt, "too late")) {
+            it->second->rtpLate_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void RTSPSource::trackPacket(const AVPacket *packet) {
+        stats_.packetsReceived++;
+        stats_.bytesReceived += packet->size;
+        if (packet->flags & AV_PKT_FLAG_CORRUPT) {
+            stats_.corruptPackets++;
+        }
+        if (packet->pts == AV_NOPTS_VALUE) {
+            return;
+        }
+
+        const AVStream *stream = formatContext_->streams[videoStreamIndex_];
+        if (lastPts_ != AV_NOPTS_VALUE && packet->pts < lastPts_ && stream->codecpar->video_delay == 0) {
+            stats_.reordered++;
+        }
+        lastPts_ = packet->pts;
+
+        // Filtro do RFC 3550 (D = (Rj - Ri) - (Sj - Si), J += (|D| - J) / 16)
+        // sobre o intervalo entre frames: o pts do demuxer é o timestamp RTP
+        // na base do stream e a chegada é a saída de av_read_frame. Como o
+        // loop decodifica entre uma leitura e outra, o valor inclui o tempo
+        // de decodificação e não é o jitter de rede por datagrama
+        const double arrival = LatencyHistogram::now() / 1e9;
+        const double rtpTime = packet->pts * av_q2d(stream->time_base);
+        if (lastArrival_ >= 0.0) {
+            const double transit = (arrival - lastArrival_) - (rtpTime - lastRtpTime_);
+            const double jitter = stats_.frameIntervalJitter / 1000.0;
+            stats_.frameIntervalJitter = (jitter + (std::fabs(transit) - jitter) * JITTER_GAIN) * 1000.0;
+            stats_.maxFrameIntervalJitter = std::max(stats_.maxFrameIntervalJitter, stats_.frameIntervalJitter);
         }
+        lastArrival_ = arrival;
+        lastRtpTime_ = rtpTime;
+    }
+
+    void RTSPSource::updateStatus() {
+        stats_.reconnectAttempts = reconnectAttempts_;
+        // Sobre TCP o rtpdec não reordena nem avisa: zero não seria medição
+        stats_.rtpStatsAvailable = !rtspConfig_.useTCP;
+        if (stats_.rtpStatsAvailable) {
+            stats_.rtpLost = rtpLost_.load(std::memory_order_relaxed);
+            stats_.rtpLate = rtpLate_.load(std::memory_order_relaxed);
+        }
+        stats_.framesDecoded = decodeCounters_.decoded.load(std::memory_order_relaxed);
+        stats_.corruptFrames = decodeCounters_.corrupt.load(std::memory_order_relaxed);
+        stats_.dropped.decodeError = decodeCounters_.decodeErrors.load(std::memory_order_relaxed);
+        stats_.dropped.gpuTransfer = decodeCounters_.transferErrors.load(std::memory_order_relaxed);
+        stats_.dropped.processing = decodeCounters_.frameErrors.load(std::memory_order_relaxed);
+        stats_.updated = LatencyHistogram::now() / 1000;
+        publishedStats_.store(stats_);
+    }
+
+    RTSPSource::NetworkStats RTSPSource::getNetworkStats() const {
+        return publishedStats_.load();
     }
 
     RTSPSource::RTSPStatus RTSPSource::getStatus() const {
-        return status_;
+        RTSPStatus status;
+        status.network = getNetworkStats();
+        status.latency = getStageLatency();
+        status.connected = status.network.connected;
+        status.reconnectAttempts = status.network.reconnectAttempts;
+        status.bytesReceived = status.network.bytesReceived;
+        status.framesReceived = status.network.packetsReceived;
+
+        const double latency = status.latency.decode.mean + status.latency.planeCopy.mean +
+                               status.latency.callback.mean;
+        status.averageLatency = static_cast<float>(latency / 1000.0);
+
+        // Sem decodificar, só os pacotes marcados pelo demuxer revelam perda.
+        // Datagramas RTP perdidos (UDP) entram como unidades que nunca
+        // chegaram, então qualquer perda observada aparece na fração
+        const NetworkStats::Dropped &dropped = status.network.dropped;
+        const int64_t damaged = rtspConfig_.decodeFrames
+                                    ? status.network.corruptFrames + dropped.decodeError +
+                                      dropped.gpuTransfer + dropped.processing
+                                    : status.network.corruptPackets;
+        const int64_t lost = status.network.rtpStatsAvailable ? status.network.rtpLost : 0;
+        const int64_t total = status.network.packetsReceived + lost;
+        status.packetLoss = total > 0
+                                ? std::min(1.0f, static_cast<float>(damaged + lost) / total)
+                                : 0.0f;
+        return status;
+    }
+
+    bool RTSPSource::triggerRecording(const std::string &path, PacketRing::Format format, int postRoll) {
+        if (!packetRing_) {
+            std::cerr << "RTSPSource::triggerRecording() - Ring pré-evento desligado (preEventDuration = 0)" << std::endl;
+            return false;
+        }
+        return packetRing_->trigger(path, format, postRoll);
+    }
+
+    void RTSPSource::stopRecording() {
+        if (packetRing_) {
+            packetRing_->stopRecording();
+        }
+    }
+
+    bool RTSPSource::isRecording() const {
+        return packetRing_ && packetRing_->isRecording();
+    }
+
+    PacketRing::Stats RTSPSource::getPreEventStats() const {
+        return packetRing_ ? packetRing_->getStats() : PacketRing::Stats{};
+    }
+
+    PacketBus::Stats RTSPSource::getPacketBusStats() const {
+        return packetBus_ ? packetBus_->getStats() : PacketBus::Stats{};
     }
 } // namespace turbovision
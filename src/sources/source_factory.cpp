@@ -13,6 +13,17 @@ namespace turbovision {
             case SourceType::RTSP:
                 return createRTSPSource(config, createDefaultRTSPConfig(path));
 
+            case SourceType::FILE:
+                return createFileSource(config, createDefaultFileConfig(path));
+
+            // "synthetic[:padrão]" ou o formato dos bytes enviados por push()
+            // ("h264", "hevc", "mpegts")
+            case SourceType::CUSTOM:
+                if (isSyntheticPath(path)) {
+                    return createSyntheticSource(config, createDefaultSyntheticConfig(path));
+                }
+                return createBufferSource(config, createDefaultBufferConfig(path));
+
             default:
                 throw Exception("Tipo de fonte não suportado");
         }
@@ -40,6 +51,39 @@ namespace turbovision {
         }
     }
 
+    std::shared_ptr<FileSource> SourceFactory::createFileSource(
+        const VideoConfig &config,
+        const FileSource::FileConfig &fileConfig) {
+        try {
+            auto source = std::make_shared<FileSource>(config, fileConfig);
+            return source;
+        } catch (const Exception &e) {
+            throw Exception("Falha ao criar fonte de arquivo: " + std::string(e.what()));
+        }
+    }
+
+    std::shared_ptr<BufferSource> SourceFactory::createBufferSource(
+        const VideoConfig &config,
+        const BufferSource::BufferConfig &bufferConfig) {
+        try {
+            auto source = std::make_shared<BufferSource>(config, bufferConfig);
+            return source;
+        } catch (const Exception &e) {
+            throw Exception("Falha ao criar fonte de buffer: " + std::string(e.what()));
+        }
+    }
+
+    std::shared_ptr<SyntheticSource> SourceFactory::createSyntheticSource(
+        const VideoConfig &config,
+        const SyntheticSource::SyntheticConfig &syntheticConfig) {
+        try {
+            auto source = std::make_shared<SyntheticSource>(config, syntheticConfig);
+            return source;
+        } catch (const Exception &e) {
+            throw Exception("Falha ao criar fonte sintética: " + std::string(e.what()));
+        }
+    }
+
     std::vector<CameraSource::CameraInfo> SourceFactory::listAvailableCameras() {
         return CameraSource::getAvailableCameras();
     }
@@ -60,6 +104,10 @@ namespace turbovision {
         return path.find("rtsp://") == 0;
     }
 
+    bool SourceFactory::isSyntheticPath(const std::string &path) {
+        return path == "synthetic" || path.find("synthetic:") == 0;
+    }
+
     CameraSource::CameraConfig SourceFactory::createDefaultCameraConfig(
         const std::string &path) {
         CameraSource::CameraConfig config;
@@ -97,4 +145,33 @@ namespace turbovision {
 
         return config;
     }
+
+    FileSource::FileConfig SourceFactory::createDefaultFileConfig(
+        const std::string &path) {
+        FileSource::FileConfig config;
+        config.path = path;
+        config.realtime = true;    // Comporta-se como uma câmera ao vivo
+        config.useIndex = true;
+        config.persistIndex = true;
+        return config;
+    }
+
+    BufferSource::BufferConfig SourceFactory::createDefaultBufferConfig(
+        const std::string &format) {
+        BufferSource::BufferConfig config;
+        config.format = format;     // "" = detectar pelo conteúdo
+        config.lowLatency = true;
+        return config;
+    }
+
+    SyntheticSource::SyntheticConfig SourceFactory::createDefaultSyntheticConfig(
+        const std::string &path) {
+        SyntheticSource::SyntheticConfig config;
+        const size_t separator = path.find(':');
+        if (separator != std::string::npos &&
+            !SyntheticSource::parsePattern(path.substr(separator + 1), config.pattern)) {
+            throw Exception("Padrão sintético desconhecido: " + path.substr(separator + 1));
+        }
+        return config;
+    }
 } // namespace turbovision
@@ -0,0 +1,422 @@
+#include "turbovision/sources/synthetic_source.hpp"
+#include "turbovision/server/codec_backend.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace turbovision {
+    namespace {
+        const int DEFAULT_FPS = 30;                 // Timestamps do modo "o mais rápido possível"
+        const int64_t MAX_LATENESS_US = 1000000;    // Atraso acima disso reancora o relógio
+
+        struct Color {
+            uint8_t y;
+            uint8_t u;
+            uint8_t v;
+        };
+
+        // Barras 75% (BT.601): branco, amarelo, ciano, verde, magenta, vermelho, azul, preto
+        const Color BARS[] = {
+            {180, 128, 128}, {162, 44, 142}, {131, 156, 44}, {112, 72, 58},
+            {84, 184, 198}, {65, 100, 212}, {35, 212, 114}, {16, 128, 128}
+        };
+        const Color GRAY = {128, 128, 128};
+        const Color BACKGROUND = {60, 128, 128};
+        const Color BOX = {170, 166, 16};
+
+        bool isNative(AVPixelFormat format) {
+            return format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_NV12 || format == AV_PIX_FMT_GRAY8;
+        }
+
+        int timestampFps(int fps, const VideoConfig &config) {
+            return fps > 0 ? fps : config.fps > 0 ? config.fps : DEFAULT_FPS;
+        }
+
+        // Retângulo em coordenadas pares (o croma é 2x2)
+        void fillRect(AVFrame *frame, int x, int y, int width, int height, Color color, bool luma = true) {
+            x = std::max(0, x) & ~1;
+            y = std::max(0, y) & ~1;
+            width = std::min(width, frame->width - x);
+            height = std::min(height, frame->height - y);
+            if (width <= 0 || height <= 0) {
+                return;
+            }
+            for (int row = y; luma && row < y + height; row++) {
+                std::memset(frame->data[0] + row * frame->linesize[0] + x, color.y, width);
+            }
+            if (!frame->data[1]) {
+                return;  // GRAY8
+            }
+
+            const int chromaWidth = (width + 1) / 2;
+            for (int row = y / 2; row < (y + height + 1) / 2; row++) {
+                if (frame->format == AV_PIX_FMT_NV12) {
+                    uint8_t *uv = frame->data[1] + row * frame->linesize[1] + x;
+                    for (int i = 0; i < chromaWidth; i++) {
+                        uv[2 * i] = color.u;
+                        uv[2 * i + 1] = color.v;
+                    }
+                } else {
+                    std::memset(frame->data[1] + row * frame->linesize[1] + x / 2, color.u, chromaWidth);
+                    std::memset(frame->data[2] + row * frame->linesize[2] + x / 2, color.v, chromaWidth);
+                }
+            }
+        }
+
+        void renderGradient(AVFrame *frame, int64_t index) {
+            // Uma linha calculada e replicada; desloca 4 níveis por frame
+            uint8_t *first = frame->data[0];
+            for (int x = 0; x < frame->width; x++) {
+                first[x] = static_cast<uint8_t>(x * 256 / frame->width + index * 4);
+            }
+            for (int row = 1; row < frame->height; row++) {
+                std::memcpy(frame->data[0] + row * frame->linesize[0], first, frame->width);
+            }
+            fillRect(frame, 0, 0, frame->width, frame->height, GRAY, false);
+        }
+
+        void renderNoise(AVFrame *frame, int64_t index, uint32_t seed) {
+            // xorshift64* por frame: mesmo índice e semente, mesmo conteúdo
+            uint64_t state = (static_cast<uint64_t>(seed) + 1) * 0x9E3779B97F4A7C15ULL ^
+                             (static_cast<uint64_t>(index) + 1) * 0xBF58476D1CE4E5B9ULL;
+            const int planes = !frame->data[1] ? 1 : frame->format == AV_PIX_FMT_NV12 ? 2 : 3;
+            for (int plane = 0; plane < planes; plane++) {
+                const int rows = plane == 0 ? frame->height : (frame->height + 1) / 2;
+                const int bytes = plane == 0 || frame->format == AV_PIX_FMT_NV12
+                                      ? frame->width
+                                      : (frame->width + 1) / 2;
+                for (int row = 0; row < rows; row++) {
+                    uint8_t *line = frame->data[plane] + row * frame->linesize[plane];
+                    for (int x = 0; x < bytes; x += 8) {
+                        state ^= state >> 12;
+                        state ^= state << 25;
+                        state ^= state >> 27;
+                        const uint64_t value = state * 0x2545F4914F6CDD1DULL;
+                        std::memcpy(line + x, &value, static_cast<size_t>(std::min(8, bytes - x)));
+                    }
+                }
+            }
+        }
+
+        void renderBox(AVFrame *frame, int64_t index) {
+            // Vai e volta nos dois eixos, em velocidades diferentes
+            const int size = std::max(16, frame->height / 4) & ~1;
+            const int64_t spanX = std::max(1, frame->width - size);
+            const int64_t spanY = std::max(1, frame->height - size);
+            const int64_t stepX = (index * 8) % (2 * spanX);
+            const int64_t stepY = (index * 4) % (2 * spanY);
+            const int x = static_cast<int>(stepX < spanX ? stepX : 2 * spanX - stepX);
+            const int y = static_cast<int>(stepY < spanY ? stepY : 2 * spanY - stepY);
+
+            fillRect(frame, 0, 0, frame->width, frame->height, BACKGROUND);
+            fillRect(frame, x, y, size, size, BOX);
+        }
+    }
+
+    SyntheticSource::SyntheticSource(const VideoConfig &config, const SyntheticConfig &syntheticConfig)
+        : VideoSource(config)
+          , syntheticConfig_(syntheticConfig)
+          , canvas_(nullptr)
+          , converted_(nullptr)
+          , scaler_(nullptr)
+          , encoderContext_(nullptr)
+          , staticPattern_(false)
+          , frames_(0)
+          , packets_(0)
+          , bytes_(0)
+          , late_(0) {
+    }
+
+    SyntheticSource::~SyntheticSource() {
+        stop();
+    }
+
+    SyntheticSource::Stats SyntheticSource::getStats() const {
+        return Stats{frames_, packets_, bytes_, late_};
+    }
+
+    bool SyntheticSource::parsePattern(const std::string &name, Pattern &pattern) {
+        if (name == "solid") {
+            pattern = Pattern::SOLID;
+        } else if (name == "bars") {
+            pattern = Pattern::COLOR_BARS;
+        } else if (name == "gradient") {
+            pattern = Pattern::GRADIENT;
+        } else if (name == "box") {
+            pattern = Pattern::MOVING_BOX;
+        } else if (name == "noise") {
+            pattern = Pattern::NOISE;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool SyntheticSource::initializeSource() {
+        if (config_.width <= 0 || config_.height <= 0) {
+            std::cerr << "SyntheticSource::initializeSource() - Resolução inválida" << std::endl;
+            return false;
+        }
+
+        // Com encode o encoder recebe o frame gerado (YUV420P ou NV12); a
+        // saída fica no formato do decoder
+        const AVPixelFormat requested = syntheticConfig_.format;
+        AVPixelFormat native = isNative(requested) ? requested : AV_PIX_FMT_YUV420P;
+        if (syntheticConfig_.encode && native == AV_PIX_FMT_GRAY8) {
+            native = AV_PIX_FMT_YUV420P;
+        }
+
+        canvas_ = av_frame_alloc();
+        if (!canvas_) {
+            return false;
+        }
+        canvas_->width = config_.width & ~1;
+        canvas_->height = config_.height & ~1;
+        canvas_->format = native;
+        if (av_frame_get_buffer(canvas_, 32) < 0) {
+            std::cerr << "SyntheticSource::initializeSource() - Falha ao alocar frame" << std::endl;
+            cleanupSource();
+            return false;
+        }
+        staticPattern_ = syntheticConfig_.pattern == Pattern::SOLID ||
+                         syntheticConfig_.pattern == Pattern::COLOR_BARS;
+
+        if (!syntheticConfig_.encode && requested != native) {
+            converted_ = av_frame_alloc();
+            if (!converted_) {
+                cleanupSource();
+                return false;
+            }
+            converted_->width = canvas_->width;
+            converted_->height = canvas_->height;
+            converted_->format = requested;
+            scaler_ = sws_getContext(canvas_->width, canvas_->height, native,
+                                     canvas_->width, canvas_->height, requested,
+                                     SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!scaler_ || av_frame_get_buffer(converted_, 32) < 0) {
+                std::cerr << "SyntheticSource::initializeSource() - Formato não suportado: "
+                        << av_get_pix_fmt_name(requested) << std::endl;
+                cleanupSource();
+                return false;
+            }
+        }
+
+        if (syntheticConfig_.encode && !initializeCodecs()) {
+            cleanupSource();
+            return false;
+        }
+        return true;
+    }
+
+    void SyntheticSource::cleanupSource() {
+        if (encoderContext_) {
+            avcodec_free_context(&encoderContext_);
+        }
+        if (codecContext_) {
+            avcodec_free_context(&codecContext_);
+        }
+        if (scaler_) {
+            sws_freeContext(scaler_);
+            scaler_ = nullptr;
+        }
+        av_frame_free(&converted_);
+        av_frame_free(&canvas_);
+    }
+
+    bool SyntheticSource::initializeCodecs() {
+        ServerConfig::EncoderConfig encoderConfig;
+        encoderConfig.encoder = syntheticConfig_.encoder;
+        encoderConfig.bitrate = config_.bitrate;
+        encoderConfig.gopSize = syntheticConfig_.gopSize;
+        encoderConfig.lowLatency = true;
+
+        std::unique_ptr<CodecBackend> backend = CodecBackend::create(encoderConfig.encoder,
+                                                                     hwManager_->isHardwareAvailable());
+        if (!backend) {
+            std::cerr << "SyntheticSource::initializeCodecs() - Encoder indisponível: "
+                    << encoderConfig.encoder << std::endl;
+            return false;
+        }
+
+        encoderContext_ = avcodec_alloc_context3(backend->codec());
+        if (!encoderContext_) {
+            return false;
+        }
+        const int fps = timestampFps(syntheticConfig_.fps, config_);
+        encoderContext_->width = canvas_->width;
+        encoderContext_->height = canvas_->height;
+        encoderContext_->pix_fmt = static_cast<AVPixelFormat>(canvas_->format);
+        encoderContext_->time_base = AV_TIME_BASE_Q;
+        encoderContext_->framerate = AVRational{fps, 1};
+        encoderContext_->bit_rate = encoderConfig.bitrate;
+        encoderContext_->gop_size = encoderConfig.gopSize;
+        if (backend->capabilities().hardware) {
+            encoderContext_->hw_device_ctx = av_buffer_ref(hwManager_->getContext());
+        }
+
+        AVDictionary *options = nullptr;
+        backend->configure(encoderContext_, &options, encoderConfig, backend->selectPreset(encoderConfig), 0);
+        int ret = avcodec_open2(encoderContext_, backend->codec(), &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            std::cerr << "SyntheticSource::initializeCodecs() - Falha ao abrir encoder "
+                    << backend->capabilities().encoder << std::endl;
+            return false;
+        }
+
+        // Decoder do mesmo codec: o caminho é o mesmo das fontes reais
+        const AVCodec *decoder = avcodec_find_decoder(encoderContext_->codec_id);
+        codecContext_ = decoder ? avcodec_alloc_context3(decoder) : nullptr;
+        if (!codecContext_) {
+            std::cerr << "SyntheticSource::initializeCodecs() - Decoder não encontrado" << std::endl;
+            return false;
+        }
+        codecContext_->width = encoderContext_->width;
+        codecContext_->height = encoderContext_->height;
+        codecContext_->pkt_timebase = encoderContext_->time_base;
+        codecContext_->thread_count = config_.advanced.threadCount;
+        if (hwManager_->isHardwareAvailable()) {
+            codecContext_->hw_device_ctx = av_buffer_ref(hwManager_->getContext());
+        }
+        if (avcodec_open2(codecContext_, decoder, nullptr) < 0) {
+            std::cerr << "SyntheticSource::initializeCodecs() - Falha ao abrir decoder" << std::endl;
+            return false;
+        }
+
+        std::cout << "SyntheticSource::initializeCodecs() - " << backend->capabilities().encoder
+                << " -> " << decoder->name << std::endl;
+        return true;
+    }
+
+    void SyntheticSource::render(int64_t index) {
+        switch (syntheticConfig_.pattern) {
+            case Pattern::SOLID:
+                fillRect(canvas_, 0, 0, canvas_->width, canvas_->height, GRAY);
+                break;
+            case Pattern::COLOR_BARS: {
+                const int bars = static_cast<int>(sizeof(BARS) / sizeof(BARS[0]));
+                for (int i = 0; i < bars; i++) {
+                    const int x = canvas_->width * i / bars;
+                    fillRect(canvas_, x, 0, canvas_->width * (i + 1) / bars - (x & ~1), canvas_->height, BARS[i]);
+                }
+                break;
+            }
+            case Pattern::GRADIENT:
+                renderGradient(canvas_, index);
+                break;
+            case Pattern::MOVING_BOX:
+                renderBox(canvas_, index);
+                break;
+            case Pattern::NOISE:
+                renderNoise(canvas_, index, syntheticConfig_.seed);
+                break;
+        }
+    }
+
+    AVFrame *SyntheticSource::nextFrame(int64_t index) {
+        // O encoder pode ainda referenciar o buffer do frame anterior
+        if (av_frame_make_writable(canvas_) < 0) {
+            return nullptr;
+        }
+        if (!staticPattern_ || index == 0) {
+            render(index);
+        }
+
+        const int64_t timestamp = index * AV_TIME_BASE / timestampFps(syntheticConfig_.fps, config_);
+        canvas_->pts = timestamp;
+        canvas_->best_effort_timestamp = timestamp;
+        if (!converted_) {
+            return canvas_;
+        }
+
+        if (av_frame_make_writable(converted_) < 0) {
+            return nullptr;
+        }
+        sws_scale(scaler_, canvas_->data, canvas_->linesize, 0, canvas_->height,
+                  converted_->data, converted_->linesize);
+        converted_->pts = timestamp;
+        converted_->best_effort_timestamp = timestamp;
+        return converted_;
+    }
+
+    bool SyntheticSource::encodeFrame(AVFrame *frame, AVPacket *packet) {
+        if (avcodec_send_frame(encoderContext_, frame) < 0) {
+            return false;
+        }
+        while (avcodec_receive_packet(encoderContext_, packet) >= 0) {
+            packets_++;
+            bytes_ += packet->size;
+            if (!processPacket(packet)) {
+                std::cerr << "SyntheticSource::encodeFrame() - Falha ao processar packet" << std::endl;
+            }
+            av_packet_unref(packet);
+        }
+        return true;
+    }
+
+    void SyntheticSource::captureLoop() {
+        AVPacket *packet = av_packet_alloc();
+        const int fps = syntheticConfig_.fps >= 0 ? syntheticConfig_.fps : config_.fps;
+
+        // Relógio: frame index sai em anchor + index / fps
+        int64_t anchorIndex = 0;
+        auto anchorTime = std::chrono::steady_clock::now();
+        int64_t index = 0;
+        bool finished = false;
+
+        while (isRunning_) {
+            if (isPaused_) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                anchorIndex = index;
+                anchorTime = std::chrono::steady_clock::now();
+                continue;
+            }
+            if (finished) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+
+            if (fps > 0) {
+                const auto due = anchorTime + std::chrono::microseconds((index - anchorIndex) * AV_TIME_BASE / fps);
+                const auto now = std::chrono::steady_clock::now();
+                const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(due - now).count();
+                if (delta > 0) {
+                    std::this_thread::sleep_until(due);
+                } else if (delta < -MAX_LATENESS_US) {
+                    anchorIndex = index;
+                    anchorTime = now;
+                    late_++;
+                } else if (delta < 0) {
+                    late_++;
+                }
+            }
+
+            AVFrame *frame = nextFrame(index);
+            if (!frame) {
+                std::cerr << "SyntheticSource::captureLoop() - Falha ao gerar frame" << std::endl;
+                break;
+            }
+            frames_++;
+            if (encoderContext_) {
+                encodeFrame(frame, packet);
+            } else {
+                processFrame(frame);
+            }
+            index++;
+
+            // Fim: drena o encoder e o decoder
+            if (syntheticConfig_.frameCount > 0 && index >= syntheticConfig_.frameCount) {
+                if (encoderContext_) {
+                    encodeFrame(nullptr, packet);
+                    processPacket(nullptr);
+                }
+                finished = true;
+            }
+        }
+
+        av_packet_free(&packet);
+    }
+
+} // namespace turbovision
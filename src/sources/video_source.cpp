@@ -1,20 +1,39 @@
 #include "turbovision/sources/video_source.hpp"
 
+#include <chrono>
 #include <iostream>
 
 namespace turbovision {
+    namespace {
+        // Pacotes lembrados para achar a chegada de um frame (atraso do decoder)
+        const size_t MAX_PACKET_TIMES = 64;
+
+        int64_t steadyMicros() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
     VideoSource::VideoSource(const VideoConfig &config)
         : config_(config)
           , formatContext_(nullptr)
           , codecContext_(nullptr)
           , videoStreamIndex_(-1)
           , isRunning_(false)
-          , isPaused_(false) {
+          , isPaused_(false)
+          , stageHistograms_(std::make_unique<StageHistograms>())
+          , tracing_(false)
+          , decodedAt_(0) {
         hwManager_ = std::make_shared<HardwareManager>(config.deviceType);
     }
 
     VideoSource::~VideoSource() {
-        stop();
+        // cleanupSource() é virtual e a derivada já foi destruída aqui: as
+        // derivadas chamam stop() nos próprios destrutores
+        isRunning_ = false;
+        if (captureThread_.joinable()) {
+            captureThread_.join();
+        }
 
         if (codecContext_) {
             avcodec_free_context(&codecContext_);
@@ -91,6 +110,27 @@ namespace turbovision {
         frameCallback_ = std::move(callback);
     }
 
+    void VideoSource::setFrameBus(std::shared_ptr<FrameBus> frameBus) {
+        std::lock_guard<std::mutex> lock(frameMutex_);
+        frameBus_ = std::move(frameBus);
+    }
+
+    VideoSource::StageLatency VideoSource::getStageLatency(bool reset) const {
+        StageLatency latency;
+        latency.packetRead = stageHistograms_->packetRead.snapshot(reset).summary();
+        latency.decode = stageHistograms_->decode.snapshot(reset).summary();
+        latency.gpuTransfer = stageHistograms_->gpuTransfer.snapshot(reset).summary();
+        latency.planeCopy = stageHistograms_->planeCopy.snapshot(reset).summary();
+        latency.callback = stageHistograms_->callback.snapshot(reset).summary();
+        return latency;
+    }
+
+    void VideoSource::setFrameTraceCallback(FrameTraceCallback callback) {
+        std::lock_guard<std::mutex> lock(frameMutex_);
+        traceCallback_ = std::move(callback);
+        tracing_ = static_cast<bool>(traceCallback_);
+    }
+
     VideoSource::StreamInfo VideoSource::getStreamInfo() const {
         StreamInfo info{};
 
@@ -119,12 +159,23 @@ namespace turbovision {
             return false;
         }
 
+        if (tracing_ && packet) {
+            packetTimes_.emplace_back(packet->pts, steadyMicros());
+            if (packetTimes_.size() > MAX_PACKET_TIMES) {
+                packetTimes_.pop_front();
+            }
+        }
+
+        // Decode: do envio do pacote até cada frame sair do decoder
+        int64_t stageStart = LatencyHistogram::now();
+
         // std::cout << "VideoSource::processPacket - Enviando packet para decodificador..." << std::endl;
         int ret = avcodec_send_packet(codecContext_, packet);
         if (ret < 0) {
             char errbuf[AV_ERROR_MAX_STRING_SIZE];
             av_strerror(ret, errbuf, sizeof(errbuf));
             std::cerr << "VideoSource::processPacket - Erro ao enviar packet: " << errbuf << std::endl;
+            decodeCounters_.decodeErrors.fetch_add(1, std::memory_order_relaxed);
             return false;
         }
 
@@ -156,23 +207,38 @@ namespace turbovision {
                     char errbuf[AV_ERROR_MAX_STRING_SIZE];
                     av_strerror(ret, errbuf, sizeof(errbuf));
                     std::cerr << "VideoSource::processPacket - Erro ao receber frame: " << errbuf << std::endl;
+                    decodeCounters_.decodeErrors.fetch_add(1, std::memory_order_relaxed);
                     break;
                 }
 
                 // Se chegamos aqui, temos um frame válido
                 // std::cout << "VideoSource::processPacket - Frame recebido com sucesso" << std::endl;
+                stageStart = stageHistograms_->decode.recordSince(stageStart);
+                decodedAt_ = tracing_ ? steadyMicros() : 0;
+                decodeCounters_.decoded.fetch_add(1, std::memory_order_relaxed);
+                if ((frame->flags & AV_FRAME_FLAG_CORRUPT) || frame->decode_error_flags) {
+                    decodeCounters_.corrupt.fetch_add(1, std::memory_order_relaxed);
+                }
 
                 if (frame->hw_frames_ctx) {
                     // std::cout << "VideoSource::processPacket - Frame está na GPU, transferindo..." << std::endl;
                     if (!transferFrameFromGPU(frame, swFrame)) {
                         std::cerr << "VideoSource::processPacket - Falha na transferência GPU->CPU" << std::endl;
+                        decodeCounters_.transferErrors.fetch_add(1, std::memory_order_relaxed);
+                        stageStart = LatencyHistogram::now();
                         continue;
                     }
+                    stageHistograms_->gpuTransfer.recordSince(stageStart);
                     success = processFrame(swFrame);
                 } else {
                     // std::cout << "VideoSource::processPacket - Processando frame da CPU..." << std::endl;
                     success = processFrame(frame);
                 }
+                if (!success) {
+                    decodeCounters_.frameErrors.fetch_add(1, std::memory_order_relaxed);
+                }
+                decodedAt_ = 0;
+                stageStart = LatencyHistogram::now();
             }
         } catch (const std::exception &e) {
             std::cerr << "VideoSource::processPacket - Exceção: " << e.what() << std::endl;
@@ -199,42 +265,65 @@ namespace turbovision {
         //           << "\n  LineSize[0]: " << frame->linesize[0]
         //           << std::endl;
 
-        try {
-            auto frameData = std::make_shared<FrameData>(
-                frame->width,
-                frame->height,
-                static_cast<AVPixelFormat>(frame->format)
-            );
-
-            // std::cout << "VideoSource::processFrame - FrameData criado, copiando planos..." << std::endl;
-
-            // Verificar número de planos e copiar cada um
-            for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->data[i]; i++) {
-                if (!frame->data[i]) break;
-
-                int planeSize;
-                if (i == 0) {
-                    // Plano Y (luminância)
-                    planeSize = frame->linesize[0] * frame->height;
-                } else {
-                    // Planos UV (crominância) - tipicamente metade da altura e largura
-                    planeSize = frame->linesize[i] * (frame->height / 2);
+        // Timestamp em µs, mesma unidade aceita por seek(). Fontes sem
+        // demuxer usam a base do decoder ou já entregam em µs
+        AVRational timeBase = AV_TIME_BASE_Q;
+        if (formatContext_ && videoStreamIndex_ >= 0) {
+            timeBase = formatContext_->streams[videoStreamIndex_]->time_base;
+        } else if (codecContext_ && codecContext_->pkt_timebase.num > 0) {
+            timeBase = codecContext_->pkt_timebase;
+        }
+        int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+                          ? frame->best_effort_timestamp
+                          : frame->pts;
+        const int64_t timestamp = pts == AV_NOPTS_VALUE
+                                      ? AV_NOPTS_VALUE
+                                      : av_rescale_q(pts, timeBase, AV_TIME_BASE_Q);
+
+        FrameTrace trace{0, decodedAt_, 0};
+        if (tracing_) {
+            if (trace.decoded == 0) {
+                trace.decoded = steadyMicros();
+            }
+            for (auto it = packetTimes_.rbegin(); it != packetTimes_.rend(); ++it) {
+                if (it->first == frame->pts) {
+                    trace.received = it->second;
+                    break;
                 }
+            }
+        }
 
-                // std::cout << "VideoSource::processFrame - Copiando plano " << i
-                //           << ", tamanho: " << planeSize << std::endl;
+        std::shared_ptr<FrameBus> frameBus;
+        bool hasCallback;
+        {
+            std::lock_guard<std::mutex> lock(frameMutex_);
+            frameBus = frameBus_;
+            hasCallback = static_cast<bool>(frameCallback_);
+        }
 
-                memcpy(frameData->data() + frameData->getPlanOffset(i),
-                       frame->data[i],
-                       planeSize);
-            }
+        // Barramento: cópia única do AVFrame para o slot compartilhado
+        if (frameBus) {
+            frameBus->publish(frame, timestamp);
+        }
+        if (!hasCallback) {
+            return true;
+        }
 
-            frameData->setTimestamp(frame->pts);
+        try {
+            const int64_t copyStart = LatencyHistogram::now();
+            FramePtr frameData = createFrameData(frame, timestamp);
+            stageHistograms_->planeCopy.recordSince(copyStart);
 
             // std::cout << "VideoSource::processFrame - Chamando callback..." << std::endl;
             std::lock_guard<std::mutex> lock(frameMutex_);
+            if (traceCallback_) {
+                trace.delivered = steadyMicros();
+                traceCallback_(frameData, trace);
+            }
             if (frameCallback_) {
+                const int64_t callbackStart = LatencyHistogram::now();
                 frameCallback_(frameData);
+                stageHistograms_->callback.recordSince(callbackStart);
             }
 
             // std::cout << "VideoSource::processFrame - Frame processado com sucesso" << std::endl;
@@ -246,6 +335,40 @@ namespace turbovision {
         }
     }
 
+    FramePtr VideoSource::createFrameData(const AVFrame *frame, int64_t timestamp) {
+        auto frameData = std::make_shared<FrameData>(
+            frame->width,
+            frame->height,
+            static_cast<AVPixelFormat>(frame->format)
+        );
+
+        // std::cout << "VideoSource::createFrameData - FrameData criado, copiando planos..." << std::endl;
+
+        // Verificar número de planos e copiar cada um
+        for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->data[i]; i++) {
+            if (!frame->data[i]) break;
+
+            int planeSize;
+            if (i == 0) {
+                // Plano Y (luminância)
+                planeSize = frame->linesize[0] * frame->height;
+            } else {
+                // Planos UV (crominância) - tipicamente metade da altura e largura
+                planeSize = frame->linesize[i] * (frame->height / 2);
+            }
+
+            // std::cout << "VideoSource::createFrameData - Copiando plano " << i
+            //           << ", tamanho: " << planeSize << std::endl;
+
+            memcpy(frameData->data() + frameData->getPlanOffset(i),
+                   frame->data[i],
+                   planeSize);
+        }
+
+        frameData->setTimestamp(timestamp);
+        return frameData;
+    }
+
     bool VideoSource::transferFrameFromGPU(AVFrame *hwFrame, AVFrame *swFrame) {
         if (av_hwframe_transfer_data(swFrame, hwFrame, 0) < 0) {
             return false;
@@ -11,6 +11,9 @@ namespace turbovision {
         void logCallback(void *ptr, int level, const char *fmt, va_list vargs) {
             if (!fmt) return;
 
+            // Perdas/atrasos RTP de cada RTSPSource (antes de consumir vargs)
+            RTSPSource::handleDemuxerLog(ptr, level, fmt, vargs);
+
             char buffer[1024];
             vsnprintf(buffer, sizeof(buffer), fmt, vargs);
 